@@ -0,0 +1,85 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// This benchmark measures searching and comparing large strings that were
+// built by repeated concatenation, as when output is accumulated piece by
+// piece.  Each run builds new 10 MB strings, so the time includes any
+// copying needed to read them.  It is not part of the benchmark suite, run
+// it directly with the shell:
+//
+//   shell benchmarks/cons-string.js
+
+
+// Configuration.
+var kConsStringLength = 10 * 1024 * 1024;
+var kConsStringMinimumTime = 2000;  // In milliseconds.
+
+
+function BuildConsString(chunk, last) {
+  var result = '';
+  while (result.length < kConsStringLength) {
+    result += chunk;
+  }
+  return result + last;
+}
+
+
+function ConsStringRun(chunk) {
+  var a = BuildConsString(chunk, 'the end');
+  var b = BuildConsString(chunk, 'the end');
+  var c = BuildConsString(chunk, 'the final end');
+  var end = a.length - 'the end'.length;
+  if (a.indexOf('the end') != end ||
+      a.indexOf('no such text') != -1 ||
+      a != b ||
+      !(a < c) ||
+      /final/.exec(c).index != end + 4) {
+    throw new Error('incorrect result');
+  }
+}
+
+
+function ConsStringMain() {
+  var chunks = [ 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. ',
+                 '<li class="item">An item of a list</li>\n' ];
+  var chunk = chunks.join('');
+  ConsStringRun(chunk);  // Warm up.
+  var runs = 0;
+  var start = new Date();
+  var elapsed;
+  do {
+    ConsStringRun(chunk);
+    runs++;
+    elapsed = new Date() - start;
+  } while (elapsed < kConsStringMinimumTime);
+  print('Cons strings: ' + (elapsed / runs).toFixed(1) + ' ms per run (' +
+        runs + ' runs in ' + elapsed + ' ms)');
+}
+
+
+ConsStringMain();
@@ -0,0 +1,90 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This benchmark measures the throughput of JSON.parse in megabytes of
+// JSON text per second.  The input resembles the responses of a web
+// service: an array of records that all have the same properties, with
+// nested objects, arrays, strings and numbers.  It is not part of the
+// benchmark suite, run it directly with the shell:
+//
+//   shell benchmarks/json-parse.js
+
+
+// Configuration.
+var kJsonParseRecords = 2000;
+var kJsonParseMinimumTime = 2000;  // In milliseconds.
+
+
+function GenerateJsonParseInput(records) {
+  var result = [];
+  for (var i = 0; i < records; i++) {
+    result.push({
+      id: i,
+      name: 'Record number ' + i,
+      active: (i % 3) != 0,
+      score: i * 1.5 / 7,
+      tags: [ 'alpha', 'beta', 'gamma' + (i % 10) ],
+      owner: {
+        id: 1000 + (i % 97),
+        email: 'user' + (i % 97) + '@example.com',
+        roles: [ 'read', 'write' ]
+      },
+      parent: (i == 0) ? null : i - 1,
+      description: 'A longer string with escapes: \"quoted\",\ttab and é'
+    });
+  }
+  return JSON.stringify(result);
+}
+
+
+function JsonParseRun(text) {
+  var result = JSON.parse(text);
+  if (result.length != kJsonParseRecords ||
+      result[kJsonParseRecords - 1].owner.roles[1] != 'write') {
+    throw new Error('JSON.parse returned an incorrect result');
+  }
+}
+
+
+function JsonParseMain() {
+  var text = GenerateJsonParseInput(kJsonParseRecords);
+  JsonParseRun(text);  // Warm up.
+  var runs = 0;
+  var start = new Date();
+  var elapsed;
+  do {
+    JsonParseRun(text);
+    runs++;
+    elapsed = new Date() - start;
+  } while (elapsed < kJsonParseMinimumTime);
+  var megabytes = text.length * runs / (1024 * 1024);
+  print('JSON.parse: ' + (megabytes * 1000 / elapsed).toFixed(2) + ' MB/s (' +
+        text.length + ' characters, ' + runs + ' runs in ' + elapsed + ' ms)');
+}
+
+
+JsonParseMain();
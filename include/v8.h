@@ -2144,6 +2144,18 @@ typedef void (*FailedAccessCheckCallback)(Local<Object> target,
  */
 typedef void (*GCCallback)();
 
+/**
+ * Applications can register a callback function which is called when a
+ * major garbage collection leaves the old generation larger than the soft
+ * limit set with V8::SetOldGenerationLimits.  It is called once each time
+ * the old generation grows past the soft limit, with the size of the old
+ * generation and the soft limit in bytes.  The application can react by
+ * releasing objects or terminating execution before the hard limit is
+ * reached.  Allocations are not allowed in the callback function.
+ */
+typedef void (*OldGenerationSoftLimitCallback)(int old_generation_size,
+                                               int soft_limit);
+
 
 // --- C o n t e x t  G e n e r a t o r ---
 
@@ -2194,6 +2206,43 @@ class V8EXPORT HeapStatistics {
 };
 
 
+/**
+ * A node in the call tree of allocation samples, see
+ * V8::StartAllocationSampling.  The path from the root to a node is a
+ * JavaScript stack, outermost function first.
+ */
+class V8EXPORT AllocationProfileNode {
+ public:
+  /**
+   * The name of the function.  Empty for anonymous functions and top-level
+   * code, "(root)" for the root.  Characters outside ASCII are replaced
+   * by '?'.
+   */
+  const char* GetFunctionName() const;
+
+  /** The name of the function's script, empty if it has none. */
+  const char* GetScriptResourceName() const;
+
+  /** The line where the function starts, 1-based, or 0 if unknown. */
+  int GetLineNumber() const;
+
+  /**
+   * The estimated number of bytes allocated while this function was the
+   * innermost JavaScript function on the stack.
+   */
+  size_t GetSelfSize() const;
+
+  /**
+   * The estimated number of bytes allocated by this function and the
+   * functions it called.
+   */
+  size_t GetTotalSize() const;
+
+  int GetChildrenCount() const;
+  const AllocationProfileNode* GetChild(int index) const;
+};
+
+
 /**
  * Container class for static utility functions.
  */
@@ -2457,22 +2506,86 @@ class V8EXPORT V8 {
    */
   static void GetHeapStatistics(HeapStatistics* heap_statistics);
 
+  /**
+   * Writes a snapshot of the heap to an open file descriptor: every live
+   * object with its size, and the properties, elements, context variables
+   * and internal fields referring to other objects.  Performs a full
+   * garbage collection first and allocates nothing on the JavaScript heap
+   * while writing.  tools/heap-snapshot.py computes dominators, retained
+   * sizes and retaining paths from the snapshot.  Returns false if writing
+   * failed or V8 was built without profiling support.
+   */
+  static bool WriteHeapSnapshot(int fd);
+
+  /**
+   * Starts sampling allocations: about every sample_interval bytes
+   * allocated on the heap, the JavaScript stack of the allocating code is
+   * recorded, and the bytes allocated since the previous sample are
+   * attributed to it.  Discards the samples of the previous run.  The
+   * --sample_allocations command line switch starts sampling at startup
+   * and also logs the samples for tools/tickprocessor.js.
+   */
+  static void StartAllocationSampling(int sample_interval);
+
+  /** Stops sampling allocations.  The samples are kept. */
+  static void StopAllocationSampling();
+
+  /**
+   * Returns the root of the call tree of the allocation samples, or NULL if
+   * sampling was never started or V8 was built without profiling support.
+   * The tree is owned by V8.  It stays valid until sampling is started
+   * again, and it grows while sampling runs.
+   */
+  static const AllocationProfileNode* GetAllocationProfile();
+
   /**
    * Optional notification that the embedder is idle.
    * V8 uses the notification to reduce memory footprint.
    * This call can be used repeatedly if the embedder remains idle.
    * Returns true if the embedder should stop calling IdleNotification
    * until real work has been done.  This indicates that V8 has done
-   * as much cleanup as it will be able to do.
+   * as much cleanup as it will be able to do.  Each call is treated as an
+   * idle period of 100 milliseconds.
    */
   static bool IdleNotification();
 
+  /**
+   * Optional notification that the embedder will be idle for the given
+   * number of milliseconds.  V8 only does the garbage collection work that
+   * is expected to fit in that time: lazy sweeping, a scavenge, slices of
+   * incremental marking or a full collection.  Returns an estimate, in
+   * milliseconds, of the idle work that remains.  Zero means that the
+   * embedder need not call IdleNotification again until real work has
+   * been done.
+   */
+  static int IdleNotification(int idle_time_in_ms);
+
   /**
    * Optional notification that the system is running low on memory.
    * V8 uses these notifications to attempt to free memory.
    */
   static void LowMemoryNotification();
 
+  /**
+   * Sets limits on the size of the old generation in bytes.  Unlike the
+   * ResourceConstraints they can be changed at any time.  When the old
+   * generation grows past the soft limit garbage is collected more eagerly
+   * and the callback set with SetOldGenerationSoftLimitCallback is called.
+   * The old generation never grows past the hard limit; allocations that
+   * would need more memory fail as when the heap is exhausted.  A limit of
+   * zero means no limit.  Returns false and leaves the limits unchanged if
+   * the hard limit exceeds max_old_space_size or is below the soft limit.
+   */
+  static bool SetOldGenerationLimits(int soft_limit, int hard_limit);
+
+  /**
+   * Enables the host application to receive a notification when the old
+   * generation is still larger than the soft limit after a major garbage
+   * collection.
+   */
+  static void SetOldGenerationSoftLimitCallback(
+      OldGenerationSoftLimitCallback callback);
+
   /**
    * Optional notification that one or more context have been
    * disposed. V8 may choose to collect garbage to get rid of any
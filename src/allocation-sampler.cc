@@ -0,0 +1,245 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "v8.h"
+
+#include "allocation-sampler.h"
+#include "frames-inl.h"
+
+namespace v8 {
+namespace internal {
+
+// Samples are taken in the middle of allocation, so nothing here may
+// allocate on the JavaScript heap or use the shared string buffers.  Names
+// are copied character by character, with the characters outside ASCII
+// replaced by '?'.
+static char CharacterAt(String* string, int index) {
+  uc16 c = string->Get(index);
+  return (c > 0 && c < 128) ? static_cast<char>(c) : '?';
+}
+
+
+static char* CopyString(String* string) {
+  int length = string->length();
+  char* result = NewArray<char>(length + 1);
+  for (int i = 0; i < length; i++) result[i] = CharacterAt(string, i);
+  result[length] = '\0';
+  return result;
+}
+
+
+static bool IsCopyOf(const char* chars, String* string) {
+  int length = string->length();
+  for (int i = 0; i < length; i++) {
+    if (chars[i] != CharacterAt(string, i)) return false;
+  }
+  return chars[length] == '\0';
+}
+
+
+static String* FunctionName(SharedFunctionInfo* shared) {
+  Object* name = shared->name();
+  if (name->IsString() && String::cast(name)->length() > 0) {
+    return String::cast(name);
+  }
+  return shared->inferred_name();
+}
+
+
+static String* ScriptName(SharedFunctionInfo* shared) {
+  if (shared->script()->IsScript()) {
+    Object* name = Script::cast(shared->script())->name();
+    if (name->IsString()) return String::cast(name);
+  }
+  return Heap::empty_string();
+}
+
+
+// The positions of the line ends of the scripts seen while sampling, by
+// script id.  Script::line_ends is not used because computing it allocates.
+struct ScriptLineEnds {
+  int script_id;
+  List<int>* line_ends;
+};
+
+static List<ScriptLineEnds> script_line_ends;
+
+
+static List<int>* LineEnds(Script* script) {
+  int id = Smi::cast(script->id())->value();
+  for (int i = 0; i < script_line_ends.length(); i++) {
+    if (script_line_ends[i].script_id == id) {
+      return script_line_ends[i].line_ends;
+    }
+  }
+  List<int>* line_ends = new List<int>();
+  if (script->source()->IsString()) {
+    String* source = String::cast(script->source());
+    int length = source->length();
+    for (int i = 0; i < length; i++) {
+      if (source->Get(i) == '\n') line_ends->Add(i);
+    }
+  }
+  ScriptLineEnds entry = { id, line_ends };
+  script_line_ends.Add(entry);
+  return line_ends;
+}
+
+
+static int LineNumber(SharedFunctionInfo* shared) {
+  if (!shared->script()->IsScript()) return 0;
+  Script* script = Script::cast(shared->script());
+  List<int>* line_ends = LineEnds(script);
+  // Binary search for the first line end at or after the position.
+  int position = shared->start_position();
+  int low = 0;
+  int high = line_ends->length();
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (line_ends->at(mid) < position) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low + script->line_offset()->value() + 1;
+}
+
+
+AllocationTreeNode::AllocationTreeNode()
+    : function_name_(StrDup("(root)")),
+      script_name_(StrDup("")),
+      start_position_(0),
+      line_number_(0),
+      self_size_(0),
+      total_size_(0) {
+}
+
+
+AllocationTreeNode::AllocationTreeNode(SharedFunctionInfo* shared)
+    : function_name_(CopyString(FunctionName(shared))),
+      script_name_(CopyString(ScriptName(shared))),
+      start_position_(shared->start_position()),
+      line_number_(LineNumber(shared)),
+      self_size_(0),
+      total_size_(0) {
+}
+
+
+AllocationTreeNode::~AllocationTreeNode() {
+  for (int i = 0; i < children_.length(); i++) delete children_[i];
+  DeleteArray(function_name_);
+  DeleteArray(script_name_);
+}
+
+
+bool AllocationTreeNode::Matches(SharedFunctionInfo* shared) {
+  return start_position_ == shared->start_position() &&
+      IsCopyOf(function_name_, FunctionName(shared)) &&
+      IsCopyOf(script_name_, ScriptName(shared));
+}
+
+
+AllocationTreeNode* AllocationTreeNode::FindOrAddChild(JSFunction* function) {
+  SharedFunctionInfo* shared = function->shared();
+  for (int i = 0; i < children_.length(); i++) {
+    if (children_[i]->Matches(shared)) return children_[i];
+  }
+  AllocationTreeNode* child = new AllocationTreeNode(shared);
+  children_.Add(child);
+  return child;
+}
+
+
+#ifdef ENABLE_LOGGING_AND_PROFILING
+
+int AllocationSampler::sample_interval_ = 0;
+int AllocationSampler::old_generation_allocated_ = 0;
+AllocationTreeNode* AllocationSampler::root_ = NULL;
+
+
+void AllocationSampler::Start(int sample_interval) {
+  ASSERT(sample_interval > 0);
+  delete root_;
+  root_ = new AllocationTreeNode();
+  sample_interval_ = sample_interval;
+  old_generation_allocated_ = 0;
+  Heap::FreeAllocationBuffers();
+  Heap::new_space()->LowerInlineAllocationLimit(sample_interval);
+}
+
+
+void AllocationSampler::Stop() {
+  if (!IsSampling()) return;
+  sample_interval_ = 0;
+  Heap::new_space()->LowerInlineAllocationLimit(0);
+}
+
+
+void AllocationSampler::SampleAllocation(int allocated_bytes) {
+  if (!IsSampling()) return;
+  AssertNoAllocation no_allocation;
+
+  // JavaScriptFrameIterator is a StackFrameIterator that skips the frames
+  // of C++ code and stubs.
+  JSFunction* functions[kMaxStackDepth];
+  Address pcs[kMaxStackDepth];
+  int depth = 0;
+  for (JavaScriptFrameIterator it;
+       !it.done() && depth < kMaxStackDepth;
+       it.Advance()) {
+    functions[depth] = JSFunction::cast(it.frame()->function());
+    pcs[depth] = it.frame()->pc();
+    depth++;
+  }
+
+  AllocationTreeNode* node = root_;
+  node->AddTotalSize(allocated_bytes);
+  for (int i = depth - 1; i >= 0; i--) {
+    node = node->FindOrAddChild(functions[i]);
+    node->AddTotalSize(allocated_bytes);
+  }
+  node->AddSelfSize(allocated_bytes);
+
+  LOG(AllocationSampleEvent(pcs, depth));
+}
+
+
+void AllocationSampler::TearDown() {
+  Stop();
+  delete root_;
+  root_ = NULL;
+  for (int i = 0; i < script_line_ends.length(); i++) {
+    delete script_line_ends[i].line_ends;
+  }
+  script_line_ends.Clear();
+}
+
+#endif  // ENABLE_LOGGING_AND_PROFILING
+
+} }  // namespace v8::internal
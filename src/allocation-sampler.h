@@ -0,0 +1,148 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef V8_ALLOCATION_SAMPLER_H_
+#define V8_ALLOCATION_SAMPLER_H_
+
+namespace v8 {
+namespace internal {
+
+// A node in the call tree of allocation samples.  The path from the root to
+// a node is a JavaScript stack, outermost function first.  A node counts
+// the bytes of the samples taken with exactly its stack (self size) and
+// with its stack or a deeper one (total size).
+class AllocationTreeNode : public Malloced {
+ public:
+  // Creates the root of a tree.
+  AllocationTreeNode();
+  ~AllocationTreeNode();
+
+  // Returns the child for the given function, adding it if there is none.
+  // Does not allocate on the JavaScript heap.
+  AllocationTreeNode* FindOrAddChild(JSFunction* function);
+
+  void AddSelfSize(int bytes) { self_size_ += bytes; }
+  void AddTotalSize(int bytes) { total_size_ += bytes; }
+
+  // The function name is empty for anonymous functions and top-level code.
+  // The script name is empty for unnamed scripts.  Lines start at 1.
+  const char* function_name() const { return function_name_; }
+  const char* script_name() const { return script_name_; }
+  int line_number() const { return line_number_; }
+  size_t self_size() const { return self_size_; }
+  size_t total_size() const { return total_size_; }
+  int children_count() const { return children_.length(); }
+  AllocationTreeNode* child(int index) const { return children_[index]; }
+
+ private:
+  explicit AllocationTreeNode(SharedFunctionInfo* shared);
+
+  bool Matches(SharedFunctionInfo* shared);
+
+  char* function_name_;
+  char* script_name_;
+  int start_position_;
+  int line_number_;
+  size_t self_size_;
+  size_t total_size_;
+  List<AllocationTreeNode*> children_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationTreeNode);
+};
+
+
+#ifdef ENABLE_LOGGING_AND_PROFILING
+
+// -------------------------------------------------------------------------
+// Allocation sampling
+//
+// The allocation sampler finds the JavaScript functions that allocate the
+// most, cheaply enough to leave on in production.  It does not trace every
+// allocation.  Roughly every sample_interval allocated bytes it records the
+// JavaScript stack of the allocating code in a call tree.  The bytes
+// allocated since the previous sample are attributed to that stack.
+//
+// New space allocation is sampled by lowering the new space allocation
+// limit to the next sample point (see NewSpace::LowerInlineAllocationLimit),
+// so that generated code, which allocates inline, falls into the runtime
+// there.  Allocation in the other spaces is counted in Heap::AllocateRaw.
+// The old space allocation buffers are not refilled while sampling, so that
+// pretenured allocation in generated code goes through the runtime as well.
+//
+// With --sample_allocations every sample is also logged as a tick event,
+// which tools/tickprocessor.js renders like a CPU profile.  All methods are
+// static.
+class AllocationSampler : public AllStatic {
+ public:
+  // Starts sampling and discards the previous call tree.
+  static void Start(int sample_interval);
+
+  // Stops sampling.  The call tree is kept until sampling starts again.
+  static void Stop();
+
+  static bool IsSampling() { return sample_interval_ > 0; }
+
+  // Takes a sample of the current JavaScript stack and attributes the given
+  // number of allocated bytes to it.
+  static void SampleAllocation(int allocated_bytes);
+
+  // Counts allocation outside new space and takes a sample each time the
+  // count passes the sample interval.
+  static inline void RecordOldGenerationAllocation(int size_in_bytes) {
+    if (!IsSampling()) return;
+    old_generation_allocated_ += size_in_bytes;
+    if (old_generation_allocated_ >= sample_interval_) {
+      int allocated_bytes = old_generation_allocated_;
+      old_generation_allocated_ = 0;
+      SampleAllocation(allocated_bytes);
+    }
+  }
+
+  // The root of the call tree, or NULL if sampling was never started.
+  static AllocationTreeNode* root() { return root_; }
+
+  static void TearDown();
+
+  // Only the innermost frames of deeper stacks are recorded.
+  static const int kMaxStackDepth = 64;
+
+ private:
+  // Zero when not sampling.
+  static int sample_interval_;
+
+  // Bytes allocated outside new space since the last sample there.
+  static int old_generation_allocated_;
+
+  static AllocationTreeNode* root_;
+};
+
+#endif  // ENABLE_LOGGING_AND_PROFILING
+
+} }  // namespace v8::internal
+
+#endif  // V8_ALLOCATION_SAMPLER_H_
@@ -27,6 +27,7 @@
 
 #include "v8.h"
 
+#include "allocation-sampler.h"
 #include "api.h"
 #include "arguments.h"
 #include "bootstrapper.h"
@@ -34,6 +35,7 @@
 #include "debug.h"
 #include "execution.h"
 #include "global-handles.h"
+#include "heap-profiler.h"
 #include "platform.h"
 #include "serialize.h"
 #include "snapshot.h"
@@ -2807,17 +2809,127 @@ void v8::V8::GetHeapStatistics(HeapStatistics* heap_statistics) {
 }
 
 
+bool v8::V8::WriteHeapSnapshot(int fd) {
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (IsDeadCheck("v8::V8::WriteHeapSnapshot()")) return false;
+  i::HeapSnapshotWriter writer(fd);
+  return writer.Write();
+#else
+  return false;
+#endif
+}
+
+
+void v8::V8::StartAllocationSampling(int sample_interval) {
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (IsDeadCheck("v8::V8::StartAllocationSampling()")) return;
+  ApiCheck(sample_interval > 0,
+           "v8::V8::StartAllocationSampling()",
+           "Sample interval must be positive");
+  i::AllocationSampler::Start(sample_interval);
+#endif
+}
+
+
+void v8::V8::StopAllocationSampling() {
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (IsDeadCheck("v8::V8::StopAllocationSampling()")) return;
+  i::AllocationSampler::Stop();
+#endif
+}
+
+
+const AllocationProfileNode* v8::V8::GetAllocationProfile() {
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (IsDeadCheck("v8::V8::GetAllocationProfile()")) return NULL;
+  return reinterpret_cast<const AllocationProfileNode*>(
+      i::AllocationSampler::root());
+#else
+  return NULL;
+#endif
+}
+
+
+static const i::AllocationTreeNode* ToInternal(
+    const AllocationProfileNode* node) {
+  return reinterpret_cast<const i::AllocationTreeNode*>(node);
+}
+
+
+const char* AllocationProfileNode::GetFunctionName() const {
+  return ToInternal(this)->function_name();
+}
+
+
+const char* AllocationProfileNode::GetScriptResourceName() const {
+  return ToInternal(this)->script_name();
+}
+
+
+int AllocationProfileNode::GetLineNumber() const {
+  return ToInternal(this)->line_number();
+}
+
+
+size_t AllocationProfileNode::GetSelfSize() const {
+  return ToInternal(this)->self_size();
+}
+
+
+size_t AllocationProfileNode::GetTotalSize() const {
+  return ToInternal(this)->total_size();
+}
+
+
+int AllocationProfileNode::GetChildrenCount() const {
+  return ToInternal(this)->children_count();
+}
+
+
+const AllocationProfileNode* AllocationProfileNode::GetChild(int index) const {
+  ApiCheck(index >= 0 && index < GetChildrenCount(),
+           "v8::AllocationProfileNode::GetChild()",
+           "Child index out of range");
+  return reinterpret_cast<const AllocationProfileNode*>(
+      ToInternal(this)->child(index));
+}
+
+
 bool v8::V8::IdleNotification() {
+  // Without a deadline the notification stands for a generous idle period.
+  static const int kIdleTimeInMs = 100;
   // Returning true tells the caller that it need not
   // continue to call IdleNotification.
   if (!i::V8::IsRunning()) return true;
-  return i::V8::IdleNotification();
+  return i::V8::IdleNotification(kIdleTimeInMs) == 0;
+}
+
+
+int v8::V8::IdleNotification(int idle_time_in_ms) {
+  // Returning zero tells the caller that it need not
+  // continue to call IdleNotification.
+  if (!i::V8::IsRunning()) return 0;
+  return i::V8::IdleNotification(idle_time_in_ms);
 }
 
 
 void v8::V8::LowMemoryNotification() {
   if (!i::V8::IsRunning()) return;
   i::Heap::CollectAllGarbage(true);
+  i::MemoryAllocator::FlushLargeObjectCache();
+}
+
+
+bool v8::V8::SetOldGenerationLimits(int soft_limit, int hard_limit) {
+  if (IsDeadCheck("v8::V8::SetOldGenerationLimits()")) return false;
+  return i::Heap::SetOldGenerationLimits(soft_limit, hard_limit);
+}
+
+
+void v8::V8::SetOldGenerationSoftLimitCallback(
+    OldGenerationSoftLimitCallback callback) {
+  if (IsDeadCheck("v8::V8::SetOldGenerationSoftLimitCallback()")) return;
+  i::Heap::SetOldGenerationSoftLimitCallback(callback);
 }
 
 
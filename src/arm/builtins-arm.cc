@@ -556,6 +556,14 @@ static void Generate_JSConstructStubHelper(MacroAssembler* masm,
     __ CompareInstanceType(r2, r3, JS_FUNCTION_TYPE);
     __ b(eq, &rt_call);
 
+    // Objects of pretenured maps are allocated in old space by the runtime.
+    // r1: constructor function
+    // r2: initial map
+    // r7: undefined
+    __ ldrb(r3, FieldMemOperand(r2, Map::kBitField2Offset));
+    __ tst(r3, Operand(1 << Map::kIsPretenured));
+    __ b(ne, &rt_call);
+
     // Now allocate the JSObject on the heap.
     // r1: constructor function
     // r2: initial map
@@ -4631,6 +4631,13 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   __ cmp(r3, ip);
   __ b(eq, &slow_case);
 
+  // Copies of pretenured boilerplates are allocated in old space by the
+  // runtime.
+  __ ldr(r0, FieldMemOperand(r3, HeapObject::kMapOffset));
+  __ ldrb(r0, FieldMemOperand(r0, Map::kBitField2Offset));
+  __ tst(r0, Operand(1 << Map::kIsPretenured));
+  __ b(ne, &slow_case);
+
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
   __ AllocateInNewSpace(size / kPointerSize,
@@ -209,71 +209,36 @@ void MacroAssembler::RecordWrite(Register object, Register offset,
   // registers are cp.
   ASSERT(!object.is(cp) && !offset.is(cp) && !scratch.is(cp));
 
-  // This is how much we shift the remembered set bit offset to get the
-  // offset of the word in the remembered set.  We divide by kBitsPerInt (32,
-  // shift right 5) and then multiply by kIntSize (4, shift left 2).
-  const int kRSetWordShift = 3;
-
-  Label fast, done;
+  Label done;
 
-  // First, test that the object is not in the new space.  We cannot set
-  // remembered set bits in the new space.
+  // First, test that the object is not in the new space.  Stores into new
+  // space are not recorded in the store buffer.
   // object: heap object pointer (with tag)
   // offset: offset to store location from the object
   and_(scratch, object, Operand(Heap::NewSpaceMask()));
   cmp(scratch, Operand(ExternalReference::new_space_start()));
   b(eq, &done);
 
-  // Compute the bit offset in the remembered set.
-  // object: heap object pointer (with tag)
-  // offset: offset to store location from the object
-  mov(ip, Operand(Page::kPageAlignmentMask));  // load mask only once
-  and_(scratch, object, Operand(ip));  // offset into page of the object
-  add(offset, scratch, Operand(offset));  // add offset into the object
-  mov(offset, Operand(offset, LSR, kObjectAlignmentBits));
+  // Append the address of the store location to the store buffer.
+  // Some callers pass offsets from the tagged pointer and some from the
+  // object start; clearing the tag bits yields the slot address for both.
+  add(offset, object, Operand(offset));
+  bic(offset, offset, Operand(kHeapObjectTagMask));
+  mov(ip, Operand(ExternalReference::store_buffer_top()));
+  ldr(scratch, MemOperand(ip));
+  str(offset, MemOperand(scratch, kPointerSize, PostIndex));
+  str(scratch, MemOperand(ip));
+  mov(ip, Operand(ExternalReference::store_buffer_limit()));
+  ldr(ip, MemOperand(ip));
+  cmp(scratch, ip);
+  b(ne, &done);
 
-  // Compute the page address from the heap object pointer.
-  // object: heap object pointer (with tag)
-  // offset: bit offset of store position in the remembered set
-  bic(object, object, Operand(ip));
-
-  // If the bit offset lies beyond the normal remembered set range, it is in
-  // the extra remembered set area of a large object.
-  // object: page start
-  // offset: bit offset of store position in the remembered set
-  cmp(offset, Operand(Page::kPageSize / kPointerSize));
-  b(lt, &fast);
-
-  // Adjust the bit offset to be relative to the start of the extra
-  // remembered set and the start address to be the address of the extra
-  // remembered set.
-  sub(offset, offset, Operand(Page::kPageSize / kPointerSize));
-  // Load the array length into 'scratch' and multiply by four to get the
-  // size in bytes of the elements.
-  ldr(scratch, MemOperand(object, Page::kObjectStartOffset
-                                  + FixedArray::kLengthOffset));
-  mov(scratch, Operand(scratch, LSL, kObjectAlignmentBits));
-  // Add the page header (including remembered set), array header, and array
-  // body size to the page address.
-  add(object, object, Operand(Page::kObjectStartOffset
-                              + FixedArray::kHeaderSize));
-  add(object, object, Operand(scratch));
-
-  bind(&fast);
-  // Get address of the rset word.
-  // object: start of the remembered set (page start for the fast case)
-  // offset: bit offset of store position in the remembered set
-  bic(scratch, offset, Operand(kBitsPerInt - 1));  // clear the bit offset
-  add(object, object, Operand(scratch, LSR, kRSetWordShift));
-  // Get bit offset in the rset word.
-  // object: address of remembered set word
-  // offset: bit offset of store position
-  and_(offset, offset, Operand(kBitsPerInt - 1));
-
-  ldr(scratch, MemOperand(object));
-  mov(ip, Operand(1));
-  orr(scratch, scratch, Operand(ip, LSL, offset));
-  str(scratch, MemOperand(object));
+  // The store buffer is full.  Call its overflow function, preserving the
+  // registers it may clobber.
+  stm(db_w, sp, r0.bit() | r1.bit() | r2.bit() | r3.bit() | lr.bit());
+  mov(ip, Operand(ExternalReference::store_buffer_overflow_function()));
+  Call(ip);
+  ldm(ia_w, sp, r0.bit() | r1.bit() | r2.bit() | r3.bit() | lr.bit());
 
   bind(&done);
 
@@ -79,11 +79,10 @@ class MacroAssembler: public Assembler {
                 Heap::RootListIndex index,
                 Condition cond = al);
 
-  // Sets the remembered set bit for [address+offset], where address is the
-  // address of the heap object 'object'.  The address must be in the first 8K
-  // of an allocated page. The 'scratch' register is used in the
-  // implementation and all 3 registers are clobbered by the operation, as
-  // well as the ip register.
+  // Records the slot [address+offset] in the store buffer, where address is
+  // the address of the heap object 'object'.  The 'scratch' register is used
+  // in the implementation and all 3 registers are clobbered by the
+  // operation, as well as the ip register.
   void RecordWrite(Register object, Register offset, Register scratch);
 
   // ---------------------------------------------------------------------------
@@ -1694,6 +1694,12 @@ Object* ConstructStubCompiler::CompileConstructStub(
   __ CompareObjectType(r2, r3, r4, MAP_TYPE);
   __ b(ne, &generic_stub_call);
 
+  // Objects of pretenured maps are allocated in old space by the runtime,
+  // which the generic stub calls.
+  __ ldrb(r3, FieldMemOperand(r2, Map::kBitField2Offset));
+  __ tst(r3, Operand(1 << Map::kIsPretenured));
+  __ b(ne, &generic_stub_call);
+
 #ifdef DEBUG
   // Cannot construct functions this way.
   // r0: argc
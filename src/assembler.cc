@@ -639,6 +639,33 @@ ExternalReference ExternalReference::new_space_allocation_limit_address() {
 }
 
 
+ExternalReference
+    ExternalReference::old_pointer_space_allocation_top_address() {
+  return ExternalReference(Heap::OldPointerSpaceAllocationTopAddress());
+}
+
+
+ExternalReference
+    ExternalReference::old_pointer_space_allocation_limit_address() {
+  return ExternalReference(Heap::OldPointerSpaceAllocationLimitAddress());
+}
+
+
+ExternalReference ExternalReference::store_buffer_top() {
+  return ExternalReference(StoreBuffer::top_address());
+}
+
+
+ExternalReference ExternalReference::store_buffer_limit() {
+  return ExternalReference(StoreBuffer::limit_address());
+}
+
+
+ExternalReference ExternalReference::store_buffer_overflow_function() {
+  return ExternalReference(Redirect(FUNCTION_ADDR(StoreBuffer::Compact)));
+}
+
+
 ExternalReference ExternalReference::handle_scope_extensions_address() {
   return ExternalReference(HandleScope::current_extensions_address());
 }
@@ -433,6 +433,13 @@ class ExternalReference BASE_EMBEDDED {
   // Used for fast allocation in generated code.
   static ExternalReference new_space_allocation_top_address();
   static ExternalReference new_space_allocation_limit_address();
+  static ExternalReference old_pointer_space_allocation_top_address();
+  static ExternalReference old_pointer_space_allocation_limit_address();
+
+  // Used by the write barrier in generated code.
+  static ExternalReference store_buffer_top();
+  static ExternalReference store_buffer_limit();
+  static ExternalReference store_buffer_overflow_function();
 
   static ExternalReference double_fp_operation(Token::Value operation);
   static ExternalReference compare_doubles();
@@ -179,6 +179,27 @@ DEFINE_bool(trace_gc_verbose, false,
             "print more details following each garbage collection")
 DEFINE_bool(collect_maps, true,
             "garbage collect maps from which no objects can be reached")
+DEFINE_int(gc_parallel_scavenge_threads, 1,
+           "number of threads copying live objects in scavenges")
+DEFINE_bool(adaptive_new_space, true,
+            "size the new space by the survival rate and scavenge time")
+DEFINE_int(scavenge_pause_budget, 4,
+           "scavenge time in ms the new space is sized to stay within")
+DEFINE_bool(pretenuring, true,
+            "allocate objects of literals and constructors in old space "
+            "when most of them survive scavenges")
+DEFINE_bool(trace_pretenuring, false,
+            "print the maps whose objects are allocated in old space")
+
+// incremental-marking.cc
+DEFINE_bool(incremental_marking, false,
+            "mark the old generation incrementally ahead of full GCs")
+DEFINE_int(incremental_marking_step_size, 64,
+           "kilobytes allocated between incremental marking steps")
+DEFINE_int(incremental_marking_speed, 8,
+           "bytes marked per byte allocated in an incremental marking step")
+DEFINE_bool(trace_incremental_marking, false,
+            "print the time taken by each incremental marking step")
 
 // v8.cc
 DEFINE_bool(use_idle_notification, true,
@@ -194,6 +215,15 @@ DEFINE_bool(native_code_counters, false,
 DEFINE_bool(always_compact, false, "Perform compaction on every full GC")
 DEFINE_bool(never_compact, false,
             "Never perform compaction on full GC - testing only")
+DEFINE_bool(lazy_sweeping, true,
+            "sweep the old data space on demand after non-compacting full GCs")
+DEFINE_int(gc_parallel_marking_threads, 1,
+           "number of threads marking live objects in full GCs")
+DEFINE_int(max_evacuation_candidates, 8,
+           "number of the most fragmented old pointer space pages whose "
+           "objects are moved out by non-compacting full GCs")
+DEFINE_bool(trace_evacuation, false,
+            "print the pages and bytes evacuated by non-compacting full GCs")
 DEFINE_bool(cleanup_ics_at_gc, true,
             "Flush inline caches prior to mark compact collection.")
 DEFINE_bool(cleanup_caches_in_maps_at_gc, true,
@@ -224,6 +254,13 @@ DEFINE_bool(optimize_ast, true, "optimize the ast")
 DEFINE_bool(trace_sim, false, "trace simulator execution")
 DEFINE_int(stop_sim_at, 0, "Simulator stop after x number of instructions")
 
+// spaces.cc
+DEFINE_int(large_object_cache_size, 16,
+           "max size of the cache of freed large object chunks (in Mbytes)")
+DEFINE_bool(transparent_huge_pages, false,
+            "grow the heap in aligned chunks that the OS can back with "
+            "transparent huge pages")
+
 // top.cc
 DEFINE_bool(trace_exception, false,
             "print stack trace when throwing exceptions")
@@ -316,7 +353,7 @@ DEFINE_bool(code_stats, false, "report code statistics after GC")
 DEFINE_bool(verify_heap, false, "verify heap pointers before and after GC")
 DEFINE_bool(print_handles, false, "report handles after GC")
 DEFINE_bool(print_global_handles, false, "report global handles after GC")
-DEFINE_bool(print_rset, false, "print remembered sets before GC")
+DEFINE_bool(print_rset, false, "print the store buffer before GC")
 
 // ic.cc
 DEFINE_bool(trace_ic, false, "trace inline cache state transitions")
@@ -373,6 +410,9 @@ DEFINE_bool(log_snapshot_positions, false,
 DEFINE_bool(log_state_changes, false, "Log state changes.")
 DEFINE_bool(log_suspect, false, "Log suspect operations.")
 DEFINE_bool(log_producers, false, "Log stack traces of JS objects allocations.")
+DEFINE_int(sample_allocations, 0,
+           "Sample the JavaScript stack about every n allocated bytes and "
+           "log the samples as ticks (implies --log-code).")
 DEFINE_bool(compress_log, false,
             "Compress log to save space (makes log less human-readable).")
 DEFINE_bool(prof, false,
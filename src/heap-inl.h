@@ -28,6 +28,8 @@
 #ifndef V8_HEAP_INL_H_
 #define V8_HEAP_INL_H_
 
+#include "allocation-sampler.h"
+#include "incremental-marking.h"
 #include "log.h"
 #include "v8-counters.h"
 
@@ -65,6 +67,7 @@ Object* Heap::AllocateRaw(int size_in_bytes,
   Counters::objs_since_last_full.Increment();
   Counters::objs_since_last_young.Increment();
 #endif
+  if (IncrementalMarking::IsMarking()) IncrementalMarking::Step(size_in_bytes);
   Object* result;
   if (NEW_SPACE == space) {
     result = new_space_.AllocateRaw(size_in_bytes);
@@ -75,10 +78,13 @@ Object* Heap::AllocateRaw(int size_in_bytes,
     }
   }
 
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  AllocationSampler::RecordOldGenerationAllocation(size_in_bytes);
+#endif
   if (OLD_POINTER_SPACE == space) {
-    result = old_pointer_space_->AllocateRaw(size_in_bytes);
+    result = old_pointer_space_->AllocateRawInBuffer(size_in_bytes);
   } else if (OLD_DATA_SPACE == space) {
-    result = old_data_space_->AllocateRaw(size_in_bytes);
+    result = old_data_space_->AllocateRawInBuffer(size_in_bytes);
   } else if (CODE_SPACE == space) {
     result = code_space_->AllocateRaw(size_in_bytes);
   } else if (LO_SPACE == space) {
@@ -183,7 +189,7 @@ void Heap::RecordWrite(Address address, int offset) {
   if (new_space_.Contains(address)) return;
   ASSERT(!new_space_.FromSpaceContains(address));
   SLOW_ASSERT(Contains(address + offset));
-  Page::SetRSet(address, offset);
+  StoreBuffer::Mark(address + offset);
 }
 
 
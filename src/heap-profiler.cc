@@ -30,6 +30,7 @@
 #include "heap-profiler.h"
 #include "frames-inl.h"
 #include "global-handles.h"
+#include "scopeinfo.h"
 #include "string-stream.h"
 
 namespace v8 {
@@ -660,6 +661,314 @@ void HeapProfiler::WriteSample() {
 }
 
 
+namespace {
+
+// Adds internal edges for the pointers of an object, leaving out the slots
+// in [skip_start, skip_end) that have been added as named edges.
+class InternalReferencesExtractor : public ObjectVisitor {
+ public:
+  InternalReferencesExtractor(HeapSnapshotWriter* writer,
+                              Object** skip_start,
+                              Object** skip_end)
+      : writer_(writer),
+        skip_start_(skip_start),
+        skip_end_(skip_end),
+        index_(0) {
+  }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      if (skip_start_ <= p && p < skip_end_) continue;
+      writer_->AddIndexedEdge(HeapSnapshotWriter::kInternal, index_++, *p);
+    }
+  }
+
+ private:
+  HeapSnapshotWriter* writer_;
+  Object** skip_start_;
+  Object** skip_end_;
+  uint32_t index_;
+};
+
+}  // namespace
+
+
+HeapSnapshotWriter::HeapSnapshotWriter(int fd)
+    : fd_(fd),
+      failed_(false),
+      buffer_(NewArray<char>(kBufferSize)),
+      position_(0),
+      strings_(&MatchKeys),
+      string_count_(0),
+      edges_(16) {
+#define DEF_TYPE_NAME(name) type_names_[name] = #name;
+  INSTANCE_TYPE_LIST(DEF_TYPE_NAME)
+#undef DEF_TYPE_NAME
+}
+
+
+HeapSnapshotWriter::~HeapSnapshotWriter() {
+  DeleteArray(buffer_);
+}
+
+
+bool HeapSnapshotWriter::Write() {
+  // Only the live objects are iterable and worth writing.
+  Heap::CollectAllGarbage(false);
+  AssertNoAllocation no_allocation;
+
+  const char* magic = "V8HS";
+  for (int i = 0; magic[i] != '\0'; i++) WriteByte(magic[i]);
+  WriteVarint(kVersion);
+  WriteRoots();
+  HeapIterator iterator;
+  for (HeapObject* obj = iterator.next(); obj != NULL; obj = iterator.next()) {
+    if (!FreeListNode::IsFreeListNode(obj)) WriteObject(obj);
+  }
+  WriteByte('e');
+  Flush();
+  return !failed_;
+}
+
+
+void HeapSnapshotWriter::AddNamedEdge(EdgeType type,
+                                      String* name,
+                                      Object* to) {
+  if (!to->IsHeapObject()) return;
+  Edge edge = { type,
+                static_cast<uint32_t>(GetStringId(name)),
+                GetObjectId(HeapObject::cast(to)) };
+  edges_.Add(edge);
+}
+
+
+void HeapSnapshotWriter::AddIndexedEdge(EdgeType type,
+                                        uint32_t index,
+                                        Object* to) {
+  if (!to->IsHeapObject()) return;
+  Edge edge = { type, index, GetObjectId(HeapObject::cast(to)) };
+  edges_.Add(edge);
+}
+
+
+void HeapSnapshotWriter::WriteRoots() {
+  edges_.Clear();
+  InternalReferencesExtractor extractor(this, NULL, NULL);
+  Heap::IterateRoots(&extractor, VISIT_ONLY_STRONG);
+  WriteNode(0, kHidden, GetStringId("(roots)"), 0);
+}
+
+
+void HeapSnapshotWriter::WriteObject(HeapObject* object) {
+  edges_.Clear();
+  Object** named_start = NULL;
+  Object** named_end = NULL;
+  if (object->IsJSObject()) {
+    JSObject* js_object = JSObject::cast(object);
+    ExtractPropertyReferences(js_object);
+    ExtractElementReferences(js_object);
+    // The in-object properties are at the end of the object.
+    named_end = HeapObject::RawField(js_object,
+                                     js_object->map()->instance_size());
+    named_start = named_end - js_object->map()->inobject_properties();
+  } else if (object->IsContext()) {
+    Context* context = Context::cast(object);
+    int end = ExtractContextReferences(context);
+    named_start = HeapObject::RawField(
+        context,
+        FixedArray::kHeaderSize + Context::MIN_CONTEXT_SLOTS * kPointerSize);
+    named_end = HeapObject::RawField(
+        context,
+        FixedArray::kHeaderSize + end * kPointerSize);
+  }
+  InternalReferencesExtractor extractor(this, named_start, named_end);
+  object->Iterate(&extractor);
+  WriteNode(GetObjectId(object),
+            GetNodeType(object),
+            GetNodeName(object),
+            object->Size());
+}
+
+
+void HeapSnapshotWriter::WriteNode(uintptr_t id,
+                                   NodeType type,
+                                   int name,
+                                   int size) {
+  WriteByte('n');
+  WriteVarint(id);
+  WriteByte(type);
+  WriteVarint(name);
+  WriteVarint(size);
+  WriteVarint(edges_.length());
+  for (int i = 0; i < edges_.length(); i++) {
+    WriteByte(edges_[i].type);
+    WriteVarint(edges_[i].name_or_index);
+    WriteVarint(edges_[i].to);
+  }
+}
+
+
+void HeapSnapshotWriter::ExtractPropertyReferences(JSObject* object) {
+  if (object->HasFastProperties()) {
+    DescriptorArray* descs = object->map()->instance_descriptors();
+    for (int i = 0; i < descs->number_of_descriptors(); i++) {
+      switch (descs->GetType(i)) {
+        case FIELD:
+          AddNamedEdge(kProperty,
+                       descs->GetKey(i),
+                       object->FastPropertyAt(descs->GetFieldIndex(i)));
+          break;
+        case CONSTANT_FUNCTION:
+          AddNamedEdge(kProperty,
+                       descs->GetKey(i),
+                       descs->GetConstantFunction(i));
+          break;
+        default:
+          break;
+      }
+    }
+  } else {
+    StringDictionary* dictionary = object->property_dictionary();
+    for (int i = 0; i < dictionary->Capacity(); i++) {
+      Object* key = dictionary->KeyAt(i);
+      if (!dictionary->IsKey(key)) continue;
+      Object* value = dictionary->ValueAt(i);
+      if (object->IsGlobalObject()) {
+        value = JSGlobalPropertyCell::cast(value)->value();
+      }
+      AddNamedEdge(kProperty, String::cast(key), value);
+    }
+  }
+}
+
+
+void HeapSnapshotWriter::ExtractElementReferences(JSObject* object) {
+  if (object->HasFastElements()) {
+    FixedArray* elements = FixedArray::cast(object->elements());
+    for (int i = 0; i < elements->length(); i++) {
+      AddIndexedEdge(kElement, i, elements->get(i));
+    }
+  } else if (object->HasDictionaryElements()) {
+    NumberDictionary* dictionary = object->element_dictionary();
+    for (int i = 0; i < dictionary->Capacity(); i++) {
+      Object* key = dictionary->KeyAt(i);
+      if (!dictionary->IsKey(key)) continue;
+      AddIndexedEdge(kElement,
+                     static_cast<uint32_t>(key->Number()),
+                     dictionary->ValueAt(i));
+    }
+  }
+}
+
+
+int HeapSnapshotWriter::ExtractContextReferences(Context* context) {
+  if (context->IsGlobalContext() || !context->is_function_context()) {
+    return Context::MIN_CONTEXT_SLOTS;
+  }
+  HandleScope scope;
+  ScopeInfo<> info(context->closure()->shared()->code());
+  int end = Min(info.number_of_context_slots(), context->length());
+  for (int i = Context::MIN_CONTEXT_SLOTS; i < end; i++) {
+    AddNamedEdge(kContextVariable, *info.context_slot_name(i), context->get(i));
+  }
+  return Max(end, static_cast<int>(Context::MIN_CONTEXT_SLOTS));
+}
+
+
+HeapSnapshotWriter::NodeType HeapSnapshotWriter::GetNodeType(
+    HeapObject* object) {
+  if (object->IsJSFunction()) return kClosure;
+  if (object->IsJSRegExp()) return kRegExp;
+  if (object->IsJSObject()) return kObject;
+  if (object->IsString()) return kString;
+  if (object->IsCode()) return kCode;
+  if (object->IsHeapNumber()) return kHeapNumber;
+  if (object->IsFixedArray() && !object->IsContext()) return kArray;
+  return kHidden;
+}
+
+
+int HeapSnapshotWriter::GetNodeName(HeapObject* object) {
+  if (object->IsJSFunction()) {
+    SharedFunctionInfo* shared = JSFunction::cast(object)->shared();
+    String* name = String::cast(shared->name());
+    return GetStringId(name->length() > 0 ? name : shared->inferred_name());
+  }
+  if (object->IsJSRegExp()) {
+    JSRegExp* regexp = JSRegExp::cast(object);
+    if (regexp->data()->IsFixedArray()) return GetStringId(regexp->Pattern());
+  }
+  if (object->IsJSObject()) {
+    return GetStringId(JSObject::cast(object)->constructor_name());
+  }
+  if (object->IsString()) return GetStringId(String::cast(object));
+  if (object->IsCode()) return GetStringId("(code)");
+  if (object->IsHeapNumber()) return GetStringId("(number)");
+  if (object->IsContext()) return GetStringId("(context)");
+  if (object->IsFixedArray()) return GetStringId("(array)");
+  return GetStringId(type_names_[object->map()->instance_type()]);
+}
+
+
+int HeapSnapshotWriter::GetStringId(String* string) {
+  HashMap::Entry* entry = strings_.Lookup(string, Hash(string), false);
+  if (entry != NULL) return static_cast<int>(reinterpret_cast<intptr_t>(entry->value));
+  int length = Min(string->length(), kMaxStringLength);
+  int id = AddString(string, length);
+  for (int i = 0; i < length; i++) {
+    uint16_t c = string->Get(i);
+    WriteByte(c < 0x80 ? static_cast<byte>(c) : '?');
+  }
+  return id;
+}
+
+
+int HeapSnapshotWriter::GetStringId(const char* string) {
+  HashMap::Entry* entry =
+      strings_.Lookup(const_cast<char*>(string), Hash(string), false);
+  if (entry != NULL) return static_cast<int>(reinterpret_cast<intptr_t>(entry->value));
+  int length = StrLength(string);
+  int id = AddString(const_cast<char*>(string), length);
+  for (int i = 0; i < length; i++) WriteByte(string[i]);
+  return id;
+}
+
+
+// Numbers a new string and writes the start of its record.
+int HeapSnapshotWriter::AddString(void* key, int length) {
+  int id = string_count_++;
+  HashMap::Entry* entry = strings_.Lookup(key, Hash(key), true);
+  entry->value = reinterpret_cast<void*>(static_cast<intptr_t>(id));
+  WriteByte('s');
+  WriteVarint(id);
+  WriteVarint(length);
+  return id;
+}
+
+
+void HeapSnapshotWriter::WriteByte(byte value) {
+  if (position_ == kBufferSize) Flush();
+  buffer_[position_++] = value;
+}
+
+
+void HeapSnapshotWriter::WriteVarint(uintptr_t value) {
+  while (value >= 0x80) {
+    WriteByte(static_cast<byte>(value | 0x80));
+    value >>= 7;
+  }
+  WriteByte(static_cast<byte>(value));
+}
+
+
+void HeapSnapshotWriter::Flush() {
+  if (!failed_ && !OS::WriteToFileDescriptor(fd_, buffer_, position_)) {
+    failed_ = true;
+  }
+  position_ = 0;
+}
+
+
 bool ProducerHeapProfile::can_log_ = false;
 
 void ProducerHeapProfile::Setup() {
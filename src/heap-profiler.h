@@ -28,6 +28,8 @@
 #ifndef V8_HEAP_PROFILER_H_
 #define V8_HEAP_PROFILER_H_
 
+#include "hashmap.h"
+
 namespace v8 {
 namespace internal {
 
@@ -258,6 +260,115 @@ class RetainerHeapProfile BASE_EMBEDDED {
 };
 
 
+// HeapSnapshotWriter writes the object graph of the heap to a file
+// descriptor, for finding leaks with tools/heap-snapshot.py.  After a full
+// collection it walks the heap with a HeapIterator and writes every object
+// as a node, with its size and its references as edges.  It allocates
+// nothing on the JS heap, so the heap does not change while it is written.
+//
+// The snapshot is a stream of records:
+//
+//   snapshot: "V8HS" version record* 'e'
+//   record:   's' string-id length char{length}
+//             'n' object-id node-type name-id size edge-count edge*
+//   edge:     edge-type name-or-index object-id
+//
+// Types are single bytes and all other numbers are unsigned LEB128
+// varints.  Object ids are object addresses divided by the object
+// alignment; id 0 is the roots node, whose edges are the strong roots.
+// Strings are numbered from 0 in the order they are written, always before
+// the first record that refers to them, and are cut to kMaxStringLength
+// characters with non-ASCII characters written as '?'.  Property and
+// context variable edges are named by a string; element and internal edges
+// carry an index.
+class HeapSnapshotWriter BASE_EMBEDDED {
+ public:
+  enum NodeType {
+    kHidden = 0,  // Internal objects, named by their instance type.
+    kArray = 1,
+    kString = 2,
+    kObject = 3,
+    kCode = 4,
+    kClosure = 5,
+    kRegExp = 6,
+    kHeapNumber = 7
+  };
+
+  enum EdgeType {
+    kContextVariable = 0,
+    kElement = 1,
+    kProperty = 2,
+    kInternal = 3
+  };
+
+  static const int kVersion = 1;
+  static const int kMaxStringLength = 1024;
+
+  explicit HeapSnapshotWriter(int fd);
+  ~HeapSnapshotWriter();
+
+  // Writes the snapshot.  Returns false if writing to the file descriptor
+  // failed.
+  bool Write();
+
+  // Adds an edge from the node being written.
+  void AddNamedEdge(EdgeType type, String* name, Object* to);
+  void AddIndexedEdge(EdgeType type, uint32_t index, Object* to);
+
+ private:
+  struct Edge {
+    EdgeType type;
+    uint32_t name_or_index;
+    uintptr_t to;
+  };
+
+  void WriteRoots();
+  void WriteObject(HeapObject* object);
+  void WriteNode(uintptr_t id, NodeType type, int name, int size);
+
+  void ExtractPropertyReferences(JSObject* object);
+  void ExtractElementReferences(JSObject* object);
+  // Returns the index after the last context slot added as a named edge.
+  int ExtractContextReferences(Context* context);
+  void ExtractInternalReferences(HeapObject* object);
+
+  NodeType GetNodeType(HeapObject* object);
+  int GetNodeName(HeapObject* object);
+
+  // Returns the number of a string, writing it first if it is new.
+  int GetStringId(String* string);
+  int GetStringId(const char* string);
+  int AddString(void* key, int length);
+
+  static uintptr_t GetObjectId(HeapObject* object) {
+    return OffsetFrom(object->address()) >> kObjectAlignmentBits;
+  }
+
+  void WriteByte(byte value);
+  void WriteVarint(uintptr_t value);
+  void Flush();
+
+  static bool MatchKeys(void* key1, void* key2) { return key1 == key2; }
+  static uint32_t Hash(const void* key) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(key));
+  }
+
+  static const int kBufferSize = 64 * KB;
+
+  int fd_;
+  bool failed_;
+  char* buffer_;
+  int position_;
+  // The numbers of the strings written, keyed by String* or const char*.
+  HashMap strings_;
+  int string_count_;
+  List<Edge> edges_;
+  const char* type_names_[LAST_TYPE + 1];
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotWriter);
+};
+
+
 class ProducerHeapProfile : public AllStatic {
  public:
   static void Setup();
@@ -40,6 +40,7 @@
 #include "scanner.h"
 #include "scopeinfo.h"
 #include "snapshot.h"
+#include "string-kernels.h"
 #include "v8threads.h"
 #if V8_TARGET_ARCH_ARM && V8_NATIVE_REGEXP
 #include "regexp-macro-assembler.h"
@@ -66,10 +67,23 @@ static const int kMinimumPromotionLimit = 2*MB;
 static const int kMinimumAllocationLimit = 8*MB;
 
 int Heap::old_gen_promotion_limit_ = kMinimumPromotionLimit;
+int Heap::old_gen_incremental_marking_limit_ = kMinimumPromotionLimit / 2;
 int Heap::old_gen_allocation_limit_ = kMinimumAllocationLimit;
 
+int Heap::old_gen_soft_limit_ = 0;
+int Heap::old_gen_hard_limit_ = 0;
+bool Heap::old_gen_soft_limit_exceeded_ = false;
+OldGenerationSoftLimitCallback Heap::old_gen_soft_limit_callback_ = NULL;
+
 int Heap::old_gen_exhausted_ = false;
 
+double Heap::last_scavenge_time_ = 0.0;
+double Heap::last_mark_compact_time_ = 0.0;
+double Heap::idle_sweep_time_per_page_ = 0.0;
+int Heap::old_gen_size_at_last_mark_compact_ = 0;
+int Heap::new_space_size_at_last_scavenge_ = 0;
+int Heap::idle_notifications_without_gc_ = 0;
+
 int Heap::amount_of_external_allocated_memory_ = 0;
 int Heap::amount_of_external_allocated_memory_at_last_global_gc_ = 0;
 
@@ -185,6 +199,12 @@ GarbageCollector Heap::SelectGarbageCollector(AllocationSpace space) {
     return MARK_COMPACTOR;
   }
 
+  // Has incremental marking traced the old generation?
+  if (IncrementalMarking::IsComplete()) {
+    Counters::gc_compactor_caused_by_incremental_marking.Increment();
+    return MARK_COMPACTOR;
+  }
+
   // Have allocation in OLD and LO failed?
   if (old_gen_exhausted_) {
     Counters::gc_compactor_caused_by_oldspace_exhaustion.Increment();
@@ -311,12 +331,7 @@ void Heap::GarbageCollectionPrologue() {
 
   if (FLAG_gc_verbose) Print();
 
-  if (FLAG_print_rset) {
-    // Not all spaces have remembered set bits that we care about.
-    old_pointer_space_->PrintRSet();
-    map_space_->PrintRSet();
-    lo_space_->PrintRSet();
-  }
+  if (FLAG_print_rset) StoreBuffer::Print();
 #endif
 
 #if defined(DEBUG) || defined(ENABLE_LOGGING_AND_PROFILING)
@@ -495,6 +510,7 @@ void Heap::ReserveSpace(
     int map_space_size,
     int cell_space_size,
     int large_object_size) {
+  FreeAllocationBuffers();
   NewSpace* new_space = Heap::new_space();
   PagedSpace* old_pointer_space = Heap::old_pointer_space();
   PagedSpace* old_data_space = Heap::old_data_space();
@@ -546,6 +562,12 @@ void Heap::ReserveSpace(
 }
 
 
+void Heap::FreeAllocationBuffers() {
+  old_pointer_space_->FreeAllocationBuffer();
+  old_data_space_->FreeAllocationBuffer();
+}
+
+
 void Heap::EnsureFromSpaceIsCommitted() {
   if (new_space_.CommitFromSpaceIfNeeded()) return;
 
@@ -564,6 +586,9 @@ void Heap::PerformGarbageCollection(AllocationSpace space,
                                     GarbageCollector collector,
                                     GCTracer* tracer) {
   VerifySymbolTable();
+  FreeAllocationBuffers();
+  // Only the mutator's allocation counts towards the allocation steps.
+  new_space_.SuspendAllocationSteps();
   if (collector == MARK_COMPACTOR && global_gc_prologue_callback_) {
     ASSERT(!allocation_allowed_);
     GCTracer::ExternalScope scope(tracer);
@@ -578,20 +603,23 @@ void Heap::PerformGarbageCollection(AllocationSpace space,
 
   // Always perform a scavenge to make room in new space.
   Scavenge();
+  new_space_.ResumeAllocationSteps();
 
   // Update the old space promotion limits after the scavenge due to
   // promotions during scavenge.
   if (collector == MARK_COMPACTOR) {
-    int old_gen_size = PromotedSpaceSize();
-    old_gen_promotion_limit_ =
-        old_gen_size + Max(kMinimumPromotionLimit, old_gen_size / 3);
-    old_gen_allocation_limit_ =
-        old_gen_size + Max(kMinimumAllocationLimit, old_gen_size / 2);
+    UpdateOldGenerationLimits();
     old_gen_exhausted_ = false;
   }
 
   Counters::objs_since_last_young.Set(0);
 
+  if (collector == SCAVENGER &&
+      IncrementalMarking::IsStopped() &&
+      IncrementalMarking::WorthActivating()) {
+    IncrementalMarking::Start();
+  }
+
   if (collector == MARK_COMPACTOR) {
     DisableAssertNoAllocation allow_allocation;
     GlobalHandles::PostGarbageCollectionProcessing();
@@ -611,11 +639,80 @@ void Heap::PerformGarbageCollection(AllocationSpace space,
     GCTracer::ExternalScope scope(tracer);
     global_gc_epilogue_callback_();
   }
+  if (collector == MARK_COMPACTOR) CheckOldGenerationSoftLimit(tracer);
   VerifySymbolTable();
 }
 
 
+void Heap::UpdateOldGenerationLimits() {
+  int old_gen_size = PromotedSpaceSize();
+  old_gen_size_at_last_mark_compact_ = old_gen_size;
+  if (old_gen_soft_limit_ > 0 && old_gen_size > old_gen_soft_limit_) {
+    // Over the embedder's budget.  Collect again after little growth.
+    old_gen_promotion_limit_ = old_gen_size + kMinimumPromotionLimit;
+  } else {
+    old_gen_promotion_limit_ =
+        old_gen_size + Max(kMinimumPromotionLimit, old_gen_size / 3);
+  }
+  old_gen_incremental_marking_limit_ =
+      old_gen_size + (old_gen_promotion_limit_ - old_gen_size) / 2;
+  old_gen_allocation_limit_ =
+      old_gen_size + Max(kMinimumAllocationLimit, old_gen_size / 2);
+  if (old_gen_hard_limit_ > 0) {
+    // Collect before the space has to be expanded past the hard limit.
+    old_gen_allocation_limit_ =
+        Min(old_gen_allocation_limit_, old_gen_hard_limit_);
+  }
+}
+
+
+void Heap::CheckOldGenerationSoftLimit(GCTracer* tracer) {
+  if (old_gen_soft_limit_ == 0) return;
+  int old_gen_size = PromotedSpaceSize();
+  if (old_gen_size <= old_gen_soft_limit_) {
+    old_gen_soft_limit_exceeded_ = false;
+    return;
+  }
+  if (old_gen_soft_limit_exceeded_) return;
+  old_gen_soft_limit_exceeded_ = true;
+  LOG(ResourceEvent("old-generation-soft-limit", "exceeded"));
+  if (old_gen_soft_limit_callback_ != NULL) {
+    ASSERT(!allocation_allowed_);
+    GCTracer::ExternalScope scope(tracer);
+    old_gen_soft_limit_callback_(old_gen_size, old_gen_soft_limit_);
+  }
+}
+
+
+bool Heap::SetOldGenerationLimits(int soft_limit, int hard_limit) {
+  if (soft_limit < 0 || hard_limit < 0) return false;
+  if (hard_limit > max_old_generation_size_) return false;
+  if (hard_limit > 0 && soft_limit > hard_limit) return false;
+  old_gen_soft_limit_ = soft_limit;
+  old_gen_hard_limit_ = hard_limit;
+  old_gen_soft_limit_exceeded_ = false;
+  if (old_gen_hard_limit_ > 0) {
+    old_gen_allocation_limit_ =
+        Min(old_gen_allocation_limit_, old_gen_hard_limit_);
+  }
+  return true;
+}
+
+
+int Heap::OldGenerationHardLimitAvailable() {
+  if (old_gen_hard_limit_ == 0 || !HasBeenSetup()) return kMaxInt;
+  int capacity = old_pointer_space_->Capacity()
+      + old_data_space_->Capacity()
+      + code_space_->Capacity()
+      + map_space_->Capacity()
+      + cell_space_->Capacity()
+      + lo_space_->Size();
+  return Max(0, old_gen_hard_limit_ - capacity);
+}
+
+
 void Heap::MarkCompact(GCTracer* tracer) {
+  double start_time = OS::TimeCurrentMillis();
   gc_state_ = MARK_COMPACT;
   mc_count_++;
   tracer->set_full_gc_count(mc_count_);
@@ -639,6 +736,7 @@ void Heap::MarkCompact(GCTracer* tracer) {
 
   Counters::objs_since_last_full.Set(0);
   context_disposed_pending_ = false;
+  last_mark_compact_time_ = OS::TimeCurrentMillis() - start_time;
 }
 
 
@@ -762,6 +860,489 @@ static void VerifyNonPointerSpacePointers() {
 #endif
 
 
+static inline bool IsShortcutCandidate(HeapObject* object, Map* map) {
+  STATIC_ASSERT(kNotStringTag != 0 && kSymbolTag != 0);
+  InstanceType type = map->instance_type();
+  if ((type & kShortcutTypeMask) != kShortcutTypeTag) return false;
+  // The map is not read from the object, because a parallel scavenger may
+  // have replaced the map word with a forwarding address in the meantime.
+  return reinterpret_cast<ConsString*>(object)->unchecked_second() ==
+      Heap::empty_string();
+}
+
+
+// Copies the values of the cells, which are not covered by the remembered
+// set of the cell space.
+static void ScavengeCellValues(ObjectVisitor* visitor) {
+  HeapObjectIterator cell_iterator(Heap::cell_space());
+  for (HeapObject* cell = cell_iterator.next();
+       cell != NULL; cell = cell_iterator.next()) {
+    if (cell->IsJSGlobalPropertyCell()) {
+      Address value_address =
+          reinterpret_cast<Address>(cell) +
+          (JSGlobalPropertyCell::kValueOffset - kHeapObjectTag);
+      visitor->VisitPointer(reinterpret_cast<Object**>(value_address));
+    }
+  }
+}
+
+
+// -------------------------------------------------------------------------
+// Parallel scavenge.
+//
+// With --gc_parallel_scavenge_threads=N for N > 1 a scavenge is done by N
+// scavengers: the main thread and N - 1 helper threads.  The main thread
+// copies the objects reachable from the roots and the cells, while the
+// helper threads start on the store buffer.  The slots in the store buffer
+// are handed out in chunks to whichever scavenger asks for one next.
+//
+// A scavenger copies objects to its own buffers in the to space and in the
+// old spaces, which it takes from the spaces under a lock.  It installs the
+// forwarding address with an atomic compare and swap after allocating the
+// copy, so that every object is copied by exactly one scavenger; the loser
+// of a race gives its allocation back.  A scavenger only visits the objects
+// it copied itself, so it is done when no slots are left and it has visited
+// all of its copies, without waiting for the others.
+//
+// The store buffer is not thread safe.  The slots that still point into new
+// space and the slots of promoted objects are recorded in it after all
+// scavengers have finished.
+//
+// Parallel scavenges are not used while incremental marking is in progress,
+// because incremental marking records the slots dropped from the store
+// buffer, or when copied objects are recorded for --heap_stats or
+// --log_gc.
+
+class ParallelScavenger;
+
+
+// Coordinates the scavengers of a parallel scavenge.
+class ParallelScavenge : public AllStatic {
+ public:
+  static bool IsEnabled() {
+    if (FLAG_gc_parallel_scavenge_threads <= 1) return false;
+    if (IncrementalMarking::IsMarking()) return false;
+#ifdef DEBUG
+    if (FLAG_heap_stats) return false;
+#endif
+#ifdef ENABLE_LOGGING_AND_PROFILING
+    if (FLAG_log_gc) return false;
+#endif
+    return true;
+  }
+
+  // Copies all objects reachable from the roots, the store buffer and the
+  // cells, like the serial part of Heap::Scavenge.
+  static void Scavenge();
+
+  // Takes the next chunk of store buffer slots to visit, as the indices
+  // [*start, *end) into slots().  Returns false if there are none left.
+  static bool NextSlots(int* start, int* end);
+
+  static Address slot(int index) { return slots_->at(index); }
+
+  // Serializes allocation in the heap and taking store buffer slots.
+  static Mutex* mutex() { return mutex_; }
+
+ private:
+  // The number of slots taken at a time.
+  static const int kSlotChunkSize = 1024;
+
+  static List<Address>* slots_;
+  static int next_slot_;
+  static Mutex* mutex_;
+};
+
+
+List<Address>* ParallelScavenge::slots_ = NULL;
+int ParallelScavenge::next_slot_ = 0;
+Mutex* ParallelScavenge::mutex_ = NULL;
+
+
+// Visitor for the objects copied by a parallel scavenger.
+class ParallelScavengeVisitor : public ObjectVisitor {
+ public:
+  explicit ParallelScavengeVisitor(ParallelScavenger* scavenger)
+      : scavenger_(scavenger) { }
+
+  void VisitPointer(Object** p) { ScavengePointer(p); }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) ScavengePointer(p);
+  }
+
+ private:
+  inline void ScavengePointer(Object** p);
+
+  ParallelScavenger* scavenger_;
+};
+
+
+// A scavenger owns the buffers it copies objects to, and the queues of the
+// copied objects it has not visited yet.
+class ParallelScavenger {
+ public:
+  ParallelScavenger() : visitor_(this), scan_(NULL), promoted_index_(0) {
+    to_space_buffer_.top = to_space_buffer_.limit = NULL;
+    old_pointer_buffer_.top = old_pointer_buffer_.limit = NULL;
+    old_data_buffer_.top = old_data_buffer_.limit = NULL;
+  }
+
+  // Copies the objects reachable from the roots and the cells.
+  void ScavengeRoots() {
+    Heap::IterateRoots(&visitor_, VISIT_ALL_IN_SCAVENGE);
+    ScavengeCellValues(&visitor_);
+    ProcessCopiedObjects();
+  }
+
+  // Copies the objects reachable from the store buffer slots, until there
+  // are none left.
+  void Run() {
+    int start, end;
+    while (ParallelScavenge::NextSlots(&start, &end)) {
+      for (int i = start; i < end; i++) {
+        Object** p = reinterpret_cast<Object**>(ParallelScavenge::slot(i));
+        visitor_.VisitPointer(p);
+        if (Heap::InNewSpace(*p)) recorded_.Add(reinterpret_cast<Address>(p));
+      }
+      ProcessCopiedObjects();
+    }
+  }
+
+  // Gives back the unused parts of the buffers and records the slots still
+  // pointing into new space in the store buffer.  Called after all
+  // scavengers are done.
+  void Finish() {
+    ASSERT(scan_ == to_space_buffer_.top && unscanned_.is_empty());
+    Heap::CreateFillerObjectAt(
+        to_space_buffer_.top,
+        static_cast<int>(to_space_buffer_.limit - to_space_buffer_.top));
+    ReturnBuffer(Heap::old_pointer_space(), &old_pointer_buffer_);
+    ReturnBuffer(Heap::old_data_space(), &old_data_buffer_);
+    for (int i = 0; i < recorded_.length(); i++) {
+      StoreBuffer::Mark(recorded_[i]);
+    }
+    for (int i = 0; i < promoted_.length(); i++) {
+      Heap::UpdateRSet(promoted_[i]);
+    }
+  }
+
+  void ScavengeObject(HeapObject** p, HeapObject* object);
+
+ private:
+  // The size of the buffers taken from the spaces.  Larger objects are
+  // allocated on their own, to bound the space left unused at the end of
+  // a buffer.
+  static const int kBufferSize = 4 * KB;
+  static const int kMaxBufferedObjectSize = kBufferSize / 8;
+
+  HeapObject* AllocateInToSpace(int size);
+  HeapObject* AllocateInOldSpace(AllocationSpace space, int size);
+
+  // Takes back the allocation of a copy that lost the race to install its
+  // forwarding address.
+  void UndoAllocation(AllocationSpace space, HeapObject* target, int size);
+
+  static OldSpace* OldSpaceFor(AllocationSpace space) {
+    ASSERT(space == OLD_POINTER_SPACE || space == OLD_DATA_SPACE);
+    return (space == OLD_POINTER_SPACE)
+        ? Heap::old_pointer_space()
+        : Heap::old_data_space();
+  }
+
+  static Object* AllocateRaw(AllocationSpace space, int size) {
+    ScopedLock lock(ParallelScavenge::mutex());
+    if (space == NEW_SPACE) return Heap::new_space()->AllocateRaw(size);
+    if (space == LO_SPACE) return Heap::lo_space()->AllocateRawFixedArray(size);
+    return OldSpaceFor(space)->AllocateRaw(size);
+  }
+
+  static void ReturnBuffer(OldSpace* space, AllocationInfo* buffer) {
+    int size = static_cast<int>(buffer->limit - buffer->top);
+    if (size > 0) {
+      ScopedLock lock(ParallelScavenge::mutex());
+      space->Free(buffer->top, size);
+    }
+    buffer->top = buffer->limit = NULL;
+  }
+
+  // Visits the copied objects until there are none left.
+  void ProcessCopiedObjects();
+
+  ParallelScavengeVisitor visitor_;
+
+  AllocationInfo to_space_buffer_;
+  AllocationInfo old_pointer_buffer_;
+  AllocationInfo old_data_buffer_;
+
+  // The objects in the to space buffer between scan_ and its top have not
+  // been visited yet.
+  Address scan_;
+
+  // Pairs of start and end addresses of other unvisited ranges in the to
+  // space.
+  List<Address> unscanned_;
+
+  // The objects promoted to the old pointer and large object spaces.  The
+  // objects from promoted_index_ on have not been visited yet.
+  List<HeapObject*> promoted_;
+  int promoted_index_;
+
+  // The store buffer slots visited by this scavenger that still point into
+  // new space.
+  List<Address> recorded_;
+};
+
+
+void ParallelScavengeVisitor::ScavengePointer(Object** p) {
+  Object* object = *p;
+  if (!Heap::InNewSpace(object)) return;
+  scavenger_->ScavengeObject(reinterpret_cast<HeapObject**>(p),
+                             reinterpret_cast<HeapObject*>(object));
+}
+
+
+void ParallelScavenger::ScavengeObject(HeapObject** p, HeapObject* object) {
+  ASSERT(Heap::InFromSpace(object));
+  MapWord first_word = object->map_word();
+  if (first_word.IsForwardingAddress()) {
+    *p = first_word.ToForwardingAddress();
+    return;
+  }
+
+  // Bypass flattened ConsString objects, like Heap::ScavengeObjectSlow.
+  if (IsShortcutCandidate(object, first_word.ToMap())) {
+    object = HeapObject::cast(
+        reinterpret_cast<ConsString*>(object)->unchecked_first());
+    *p = object;
+    if (!Heap::InNewSpace(object)) return;
+    first_word = object->map_word();
+    if (first_word.IsForwardingAddress()) {
+      *p = first_word.ToForwardingAddress();
+      return;
+    }
+  }
+
+  Map* map = first_word.ToMap();
+  int object_size = object->SizeFromMap(map);
+
+  AllocationSpace space = NEW_SPACE;
+  HeapObject* target = NULL;
+  if (Heap::ShouldBePromoted(object->address(), object_size)) {
+    space = (object_size > Heap::MaxObjectSizeInPagedSpace())
+        ? LO_SPACE
+        : Heap::TargetSpaceId(map->instance_type());
+    target = AllocateInOldSpace(space, object_size);
+  }
+  if (target == NULL) {
+    // The object should remain in new space or the old space allocation
+    // failed.
+    space = NEW_SPACE;
+    target = AllocateInToSpace(object_size);
+    if (target == NULL) {
+      V8::FatalProcessOutOfMemory("ParallelScavenger::ScavengeObject");
+    }
+  }
+
+  if (!object->SetForwardingAddressAtomically(first_word, target)) {
+    // Another scavenger has copied the object.
+    UndoAllocation(space, target, object_size);
+    *p = object->map_word().ToForwardingAddress();
+    return;
+  }
+
+  // The from-space object is not changed by other scavengers except for its
+  // map word, so it can be copied after installing the forwarding address.
+  Heap::CopyBlock(reinterpret_cast<Object**>(target->address()),
+                  reinterpret_cast<Object**>(object->address()),
+                  object_size);
+  target->set_map(map);
+  if (space == OLD_POINTER_SPACE || space == LO_SPACE) {
+    promoted_.Add(target);
+  }
+#ifdef DEBUG
+  if (space == OLD_DATA_SPACE) {
+    VerifyNonPointerSpacePointersVisitor v;
+    target->Iterate(&v);
+  }
+#endif
+  *p = target;
+}
+
+
+HeapObject* ParallelScavenger::AllocateInToSpace(int size) {
+  AllocationInfo* buffer = &to_space_buffer_;
+  if (buffer->limit - buffer->top < size) {
+    Object* result;
+    if (size > kMaxBufferedObjectSize) {
+      result = AllocateRaw(NEW_SPACE, size);
+      if (result->IsFailure()) return NULL;
+      Address start = HeapObject::cast(result)->address();
+      unscanned_.Add(start);
+      unscanned_.Add(start + size);
+      return HeapObject::cast(result);
+    }
+    // Retire the current buffer.  Its unvisited objects are visited later
+    // and its unused end is filled.
+    if (scan_ < buffer->top) {
+      unscanned_.Add(scan_);
+      unscanned_.Add(buffer->top);
+    }
+    Heap::CreateFillerObjectAt(buffer->top,
+                               static_cast<int>(buffer->limit - buffer->top));
+    result = AllocateRaw(NEW_SPACE, kBufferSize);
+    int buffer_size = kBufferSize;
+    if (result->IsFailure()) {
+      result = AllocateRaw(NEW_SPACE, size);
+      if (result->IsFailure()) {
+        buffer->top = buffer->limit = scan_ = NULL;
+        return NULL;
+      }
+      buffer_size = size;
+    }
+    scan_ = buffer->top = HeapObject::cast(result)->address();
+    buffer->limit = buffer->top + buffer_size;
+  }
+  HeapObject* target = HeapObject::FromAddress(buffer->top);
+  buffer->top += size;
+  return target;
+}
+
+
+HeapObject* ParallelScavenger::AllocateInOldSpace(AllocationSpace space,
+                                                  int size) {
+  Object* result;
+  if (space == LO_SPACE || size > kMaxBufferedObjectSize) {
+    result = AllocateRaw(space, size);
+    return result->IsFailure() ? NULL : HeapObject::cast(result);
+  }
+  AllocationInfo* buffer = (space == OLD_POINTER_SPACE)
+      ? &old_pointer_buffer_
+      : &old_data_buffer_;
+  if (buffer->limit - buffer->top < size) {
+    ReturnBuffer(OldSpaceFor(space), buffer);
+    result = AllocateRaw(space, kBufferSize);
+    if (result->IsFailure()) {
+      // There may still be room for the object itself.
+      result = AllocateRaw(space, size);
+      return result->IsFailure() ? NULL : HeapObject::cast(result);
+    }
+    buffer->top = HeapObject::cast(result)->address();
+    buffer->limit = buffer->top + kBufferSize;
+  }
+  HeapObject* target = HeapObject::FromAddress(buffer->top);
+  buffer->top += size;
+  return target;
+}
+
+
+void ParallelScavenger::UndoAllocation(AllocationSpace space,
+                                       HeapObject* target,
+                                       int size) {
+  Address end = target->address() + size;
+  AllocationInfo* buffer = NULL;
+  if (space == NEW_SPACE) {
+    buffer = &to_space_buffer_;
+  } else if (space == OLD_POINTER_SPACE) {
+    buffer = &old_pointer_buffer_;
+  } else if (space == OLD_DATA_SPACE) {
+    buffer = &old_data_buffer_;
+  }
+  if (size <= kMaxBufferedObjectSize && buffer != NULL && buffer->top == end) {
+    // The copy is the last allocation in its buffer.
+    buffer->top = target->address();
+  } else if (space == OLD_POINTER_SPACE || space == OLD_DATA_SPACE) {
+    ScopedLock lock(ParallelScavenge::mutex());
+    OldSpaceFor(space)->Free(target->address(), size);
+  } else {
+    // Objects allocated on their own in the new or large object space are
+    // left behind as garbage.
+    Heap::CreateFillerObjectAt(target->address(), size);
+  }
+}
+
+
+void ParallelScavenger::ProcessCopiedObjects() {
+  while (true) {
+    if (scan_ < to_space_buffer_.top) {
+      HeapObject* object = HeapObject::FromAddress(scan_);
+      scan_ += object->Size();
+      object->Iterate(&visitor_);
+    } else if (!unscanned_.is_empty()) {
+      Address end = unscanned_.RemoveLast();
+      Address start = unscanned_.RemoveLast();
+      while (start < end) {
+        HeapObject* object = HeapObject::FromAddress(start);
+        start += object->Size();
+        object->Iterate(&visitor_);
+      }
+    } else if (promoted_index_ < promoted_.length()) {
+      promoted_[promoted_index_++]->Iterate(&visitor_);
+    } else {
+      return;
+    }
+  }
+}
+
+
+class ParallelScavengeThread : public Thread {
+ public:
+  explicit ParallelScavengeThread(ParallelScavenger* scavenger)
+      : scavenger_(scavenger) { }
+
+  void Run() { scavenger_->Run(); }
+
+ private:
+  ParallelScavenger* scavenger_;
+};
+
+
+void ParallelScavenge::Scavenge() {
+  int scavenger_count = FLAG_gc_parallel_scavenge_threads;
+  ParallelScavenger* scavengers = new ParallelScavenger[scavenger_count];
+  mutex_ = OS::CreateMutex();
+
+  // The slots are taken out of the store buffer up front, because the
+  // slots of promoted objects are added to it afterwards.
+  slots_ = new List<Address>(StoreBuffer::Size());
+  next_slot_ = 0;
+  StoreBuffer::TakeSlots(slots_);
+
+  List<ParallelScavengeThread*> threads(scavenger_count - 1);
+  for (int i = 1; i < scavenger_count; i++) {
+    ParallelScavengeThread* thread = new ParallelScavengeThread(&scavengers[i]);
+    thread->Start();
+    threads.Add(thread);
+  }
+  // The main thread is the first scavenger.  It copies the objects
+  // reachable from the roots before it helps with the store buffer.
+  scavengers[0].ScavengeRoots();
+  scavengers[0].Run();
+  for (int i = 0; i < threads.length(); i++) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  for (int i = 0; i < scavenger_count; i++) scavengers[i].Finish();
+
+  delete slots_;
+  slots_ = NULL;
+  delete mutex_;
+  mutex_ = NULL;
+  delete[] scavengers;
+}
+
+
+bool ParallelScavenge::NextSlots(int* start, int* end) {
+  ScopedLock lock(mutex_);
+  if (next_slot_ == slots_->length()) return false;
+  *start = next_slot_;
+  next_slot_ = Min(next_slot_ + kSlotChunkSize, slots_->length());
+  *end = next_slot_;
+  return true;
+}
+
+
 void Heap::Scavenge() {
 #ifdef DEBUG
   if (FLAG_enable_slow_asserts) VerifyNonPointerSpacePointers();
@@ -775,10 +1356,15 @@ void Heap::Scavenge() {
   // Clear descriptor cache.
   DescriptorLookupCache::Clear();
 
+  double start_time = OS::TimeCurrentMillis();
+  int allocated = new_space_.Size();
+  Address allocation_top = new_space_.top();
+
   // Used for updating survived_since_last_expansion_ at function end.
   int survived_watermark = PromotedSpaceSize();
 
-  if (new_space_.Capacity() < new_space_.MaximumCapacity() &&
+  if (!FLAG_adaptive_new_space &&
+      new_space_.Capacity() < new_space_.MaximumCapacity() &&
       survived_since_last_expansion_ > new_space_.Capacity()) {
     // Grow the size of new space if there is room to grow and enough
     // data has survived scavenge since the last expansion.
@@ -791,6 +1377,154 @@ void Heap::Scavenge() {
   new_space_.Flip();
   new_space_.ResetAllocationInfo();
 
+  if (ParallelScavenge::IsEnabled()) {
+    ParallelScavenge::Scavenge();
+  } else {
+    ScavengeSerially();
+  }
+
+  ScavengeExternalStringTable();
+
+  if (FLAG_pretenuring) {
+    // The objects allocated since the last scavenge start at the age mark.
+    UpdatePretenuringDecisions(new_space_.age_mark(), allocation_top);
+  }
+
+  // Set age mark.
+  new_space_.set_age_mark(new_space_.top());
+
+  // Update how much has survived scavenge.
+  int promoted = PromotedSpaceSize() - survived_watermark;
+  survived_since_last_expansion_ += promoted + new_space_.Size();
+
+  if (FLAG_adaptive_new_space) {
+    AdjustNewSpaceCapacity(allocated,
+                           new_space_.Size(),
+                           promoted,
+                           OS::TimeCurrentMillis() - start_time);
+  }
+
+  // Promotion grows the old generation without going through
+  // Heap::AllocateRaw, so account for it in incremental marking here.
+  IncrementalMarking::Step(promoted);
+
+  last_scavenge_time_ = OS::TimeCurrentMillis() - start_time;
+  new_space_size_at_last_scavenge_ = new_space_.Size();
+
+  LOG(ResourceEvent("scavenge", "end"));
+
+  gc_state_ = NOT_IN_GC;
+}
+
+
+void Heap::AdjustNewSpaceCapacity(int allocated,
+                                   int survived,
+                                   int promoted,
+                                   double time) {
+  if (allocated == 0) return;
+  int survival_rate = static_cast<int>(100.0 * survived / allocated);
+  int promotion_rate = static_cast<int>(100.0 * promoted / allocated);
+  int old_capacity = new_space_.Capacity();
+
+  // The time of a scavenge mostly follows the amount of surviving data,
+  // which at most doubles with the capacity of the new space.  Shrink the
+  // new space when a scavenge has gone over the budget, and grow it when
+  // a scavenge twice as long would still be within the budget and enough
+  // survives that a larger new space gives objects time to die.  The gap
+  // between the two conditions keeps the capacity from oscillating.
+  if (time > FLAG_scavenge_pause_budget) {
+    if (old_capacity > new_space_.InitialCapacity()) {
+      new_space_.ShrinkTo(old_capacity / 2);
+    }
+  } else if (old_capacity < new_space_.MaximumCapacity() &&
+             2 * time <= FLAG_scavenge_pause_budget &&
+             (survival_rate + promotion_rate >= kHighSurvivalRate ||
+              survived_since_last_expansion_ > old_capacity)) {
+    new_space_.Grow();
+  }
+
+  int new_capacity = new_space_.Capacity();
+  if (new_capacity != old_capacity) survived_since_last_expansion_ = 0;
+
+  if (FLAG_trace_gc &&
+      (FLAG_trace_gc_verbose || new_capacity != old_capacity)) {
+    PrintF("Scavenge: %d%% survived, %d%% promoted in %.1f ms, ",
+           survival_rate, promotion_rate, time);
+    if (new_capacity > old_capacity) {
+      PrintF("growing new space to %d KB.\n", new_capacity / KB);
+    } else if (new_capacity < old_capacity) {
+      PrintF("shrinking new space to %d KB.\n", new_capacity / KB);
+    } else {
+      PrintF("keeping new space at %d KB.\n", new_capacity / KB);
+    }
+  }
+}
+
+
+// The number of objects of a map among the objects sampled for
+// pretenuring, and how many of them survived the scavenge.
+struct PretenuringCount {
+  Map* map;
+  int allocated;
+  int survived;
+};
+
+
+static bool PretenuringMapsMatch(void* key1, void* key2) {
+  return key1 == key2;
+}
+
+
+void Heap::UpdatePretenuringDecisions(Address start, Address end) {
+  end = Min(end, start + kPretenuringSampleSize);
+  HashMap indices(PretenuringMapsMatch);
+  List<PretenuringCount> counts;
+
+  // The from space is iterable: dead objects are untouched and live ones
+  // only had their map word replaced by the forwarding address.
+  Address current = start;
+  while (current < end) {
+    HeapObject* object = HeapObject::FromAddress(current);
+    MapWord map_word = object->map_word();
+    bool survived = map_word.IsForwardingAddress();
+    Map* map = survived ? map_word.ToForwardingAddress()->map()
+                        : map_word.ToMap();
+    current += object->SizeFromMap(map);
+
+    InstanceType type = map->instance_type();
+    if (type != JS_OBJECT_TYPE && type != JS_ARRAY_TYPE) continue;
+    if (map->is_pretenured()) continue;
+    uint32_t hash = static_cast<uint32_t>(
+        reinterpret_cast<uintptr_t>(map) >> kObjectAlignmentBits);
+    HashMap::Entry* entry = indices.Lookup(map, hash, true);
+    if (entry->value == NULL) {
+      PretenuringCount count = { map, 0, 0 };
+      counts.Add(count);
+      entry->value = reinterpret_cast<void*>(counts.length());
+    }
+    PretenuringCount& count =
+        counts[static_cast<int>(reinterpret_cast<intptr_t>(entry->value)) - 1];
+    count.allocated++;
+    if (survived) count.survived++;
+  }
+
+  for (int i = 0; i < counts.length(); i++) {
+    PretenuringCount& count = counts[i];
+    if (count.allocated >= kPretenuringMinimumCount &&
+        count.survived * 100 >= count.allocated * kPretenuringSurvivalRate) {
+      count.map->set_is_pretenured(true);
+      if (FLAG_trace_pretenuring) {
+        PrintF("Pretenuring map %p: %d of %d objects survived.\n",
+               reinterpret_cast<void*>(count.map),
+               count.survived,
+               count.allocated);
+      }
+    }
+  }
+}
+
+
+void Heap::ScavengeSerially() {
   // We need to sweep newly copied objects which can be either in the
   // to space or promoted to the old generation.  For to-space
   // objects, we treat the bottom of the to space as a queue.  Newly
@@ -815,39 +1549,14 @@ void Heap::Scavenge() {
   // Copy roots.
   IterateRoots(&scavenge_visitor, VISIT_ALL_IN_SCAVENGE);
 
-  // Copy objects reachable from the old generation.  By definition,
-  // there are no intergenerational pointers in code or data spaces.
-  IterateRSet(old_pointer_space_, &ScavengePointer);
-  IterateRSet(map_space_, &ScavengePointer);
-  lo_space_->IterateRSet(&ScavengePointer);
+  // Copy objects reachable from the old generation.
+  StoreBuffer::Iterate(&ScavengePointer);
 
   // Copy objects reachable from cells by scavenging cell values directly.
-  HeapObjectIterator cell_iterator(cell_space_);
-  for (HeapObject* cell = cell_iterator.next();
-       cell != NULL; cell = cell_iterator.next()) {
-    if (cell->IsJSGlobalPropertyCell()) {
-      Address value_address =
-          reinterpret_cast<Address>(cell) +
-          (JSGlobalPropertyCell::kValueOffset - kHeapObjectTag);
-      scavenge_visitor.VisitPointer(reinterpret_cast<Object**>(value_address));
-    }
-  }
+  ScavengeCellValues(&scavenge_visitor);
 
   new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
-
-  ScavengeExternalStringTable();
   ASSERT(new_space_front == new_space_.top());
-
-  // Set age mark.
-  new_space_.set_age_mark(new_space_.top());
-
-  // Update how much has survived scavenge.
-  survived_since_last_expansion_ +=
-      (PromotedSpaceSize() - survived_watermark) + new_space_.Size();
-
-  LOG(ResourceEvent("scavenge", "end"));
-
-  gc_state_ = NOT_IN_GC;
 }
 
 
@@ -933,36 +1642,6 @@ Address Heap::DoScavenge(ObjectVisitor* scavenge_visitor,
 }
 
 
-void Heap::ClearRSetRange(Address start, int size_in_bytes) {
-  uint32_t start_bit;
-  Address start_word_address =
-      Page::ComputeRSetBitPosition(start, 0, &start_bit);
-  uint32_t end_bit;
-  Address end_word_address =
-      Page::ComputeRSetBitPosition(start + size_in_bytes - kIntSize,
-                                   0,
-                                   &end_bit);
-
-  // We want to clear the bits in the starting word starting with the
-  // first bit, and in the ending word up to and including the last
-  // bit.  Build a pair of bitmasks to do that.
-  uint32_t start_bitmask = start_bit - 1;
-  uint32_t end_bitmask = ~((end_bit << 1) - 1);
-
-  // If the start address and end address are the same, we mask that
-  // word once, otherwise mask the starting and ending word
-  // separately and all the ones in between.
-  if (start_word_address == end_word_address) {
-    Memory::uint32_at(start_word_address) &= (start_bitmask | end_bitmask);
-  } else {
-    Memory::uint32_at(start_word_address) &= start_bitmask;
-    Memory::uint32_at(end_word_address) &= end_bitmask;
-    start_word_address += kIntSize;
-    memset(start_word_address, 0, end_word_address - start_word_address);
-  }
-}
-
-
 class UpdateRSetVisitor: public ObjectVisitor {
  public:
 
@@ -971,20 +1650,16 @@ class UpdateRSetVisitor: public ObjectVisitor {
   }
 
   void VisitPointers(Object** start, Object** end) {
-    // Update a store into slots [start, end), used (a) to update remembered
-    // set when promoting a young object to old space or (b) to rebuild
-    // remembered sets after a mark-compact collection.
+    // Record the slots in [start, end) that point into new space, used (a)
+    // when promoting a young object to old space or (b) to rebuild the
+    // store buffer after a mark-compact collection.
     for (Object** p = start; p < end; p++) UpdateRSet(p);
   }
  private:
 
   void UpdateRSet(Object** p) {
-    // The remembered set should not be set.  It should be clear for objects
-    // newly copied to old space, and it is cleared before rebuilding in the
-    // mark-compact collector.
-    ASSERT(!Page::IsRSetSet(reinterpret_cast<Address>(p), 0));
     if (Heap::InNewSpace(*p)) {
-      Page::SetRSet(reinterpret_cast<Address>(p), 0);
+      StoreBuffer::Mark(reinterpret_cast<Address>(p));
     }
   }
 };
@@ -992,23 +1667,9 @@ class UpdateRSetVisitor: public ObjectVisitor {
 
 int Heap::UpdateRSet(HeapObject* obj) {
   ASSERT(!InNewSpace(obj));
-  // Special handling of fixed arrays to iterate the body based on the start
-  // address and offset.  Just iterating the pointers as in UpdateRSetVisitor
-  // will not work because Page::SetRSet needs to have the start of the
-  // object for large object pages.
-  if (obj->IsFixedArray()) {
-    FixedArray* array = FixedArray::cast(obj);
-    int length = array->length();
-    for (int i = 0; i < length; i++) {
-      int offset = FixedArray::kHeaderSize + i * kPointerSize;
-      ASSERT(!Page::IsRSetSet(obj->address(), offset));
-      if (Heap::InNewSpace(array->get(i))) {
-        Page::SetRSet(obj->address(), offset);
-      }
-    }
-  } else if (!obj->IsCode()) {
-    // Skip code object, we know it does not contain inter-generational
-    // pointers.
+  // Skip code object, we know it does not contain inter-generational
+  // pointers.
+  if (!obj->IsCode()) {
     UpdateRSetVisitor v;
     obj->Iterate(&v);
   }
@@ -1017,15 +1678,11 @@ int Heap::UpdateRSet(HeapObject* obj) {
 
 
 void Heap::RebuildRSets() {
-  // By definition, we do not care about remembered set bits in code,
-  // data, or cell spaces.
-  map_space_->ClearRSet();
+  // By definition, we do not care about pointers into new space from
+  // code, data, or cell spaces.
+  StoreBuffer::Clear();
   RebuildRSets(map_space_);
-
-  old_pointer_space_->ClearRSet();
   RebuildRSets(old_pointer_space_);
-
-  Heap::lo_space_->ClearRSet();
   RebuildRSets(lo_space_);
 }
 
@@ -1085,16 +1742,6 @@ HeapObject* Heap::MigrateObject(HeapObject* source,
 }
 
 
-static inline bool IsShortcutCandidate(HeapObject* object, Map* map) {
-  STATIC_ASSERT(kNotStringTag != 0 && kSymbolTag != 0);
-  ASSERT(object->map() == map);
-  InstanceType type = map->instance_type();
-  if ((type & kShortcutTypeMask) != kShortcutTypeTag) return false;
-  ASSERT(object->IsString() && !object->IsSymbol());
-  return ConsString::cast(object)->unchecked_second() == Heap::empty_string();
-}
-
-
 void Heap::ScavengeObjectSlow(HeapObject** p, HeapObject* object) {
   ASSERT(InFromSpace(object));
   MapWord first_word = object->map_word();
@@ -2564,7 +3211,7 @@ Object* Heap::AllocateGlobalObject(JSFunction* constructor) {
 }
 
 
-Object* Heap::CopyJSObject(JSObject* source) {
+Object* Heap::CopyJSObject(JSObject* source, PretenureFlag pretenure) {
   // Never used to copy functions.  If functions need to be copied we
   // have to be careful to clear the literals array.
   ASSERT(!source->IsJSFunction());
@@ -2574,10 +3221,13 @@ Object* Heap::CopyJSObject(JSObject* source) {
   int object_size = map->instance_size();
   Object* clone;
 
-  // If we're forced to always allocate, we use the general allocation
-  // functions which may leave us with an object in old space.
-  if (always_allocate()) {
-    clone = AllocateRaw(object_size, NEW_SPACE, OLD_POINTER_SPACE);
+  // If the clone is pretenured or we're forced to always allocate, we use
+  // the general allocation functions which may leave us with an object in
+  // old space.
+  if (always_allocate() || pretenure == TENURED) {
+    AllocationSpace space =
+        (pretenure == TENURED) ? OLD_POINTER_SPACE : NEW_SPACE;
+    clone = AllocateRaw(object_size, space, OLD_POINTER_SPACE);
     if (clone->IsFailure()) return clone;
     Address clone_address = HeapObject::cast(clone)->address();
     CopyBlock(reinterpret_cast<Object**>(clone_address),
@@ -2604,13 +3254,13 @@ Object* Heap::CopyJSObject(JSObject* source) {
   FixedArray* properties = FixedArray::cast(source->properties());
   // Update elements if necessary.
   if (elements->length()> 0) {
-    Object* elem = CopyFixedArray(elements);
+    Object* elem = CopyFixedArray(elements, pretenure);
     if (elem->IsFailure()) return elem;
     JSObject::cast(clone)->set_elements(FixedArray::cast(elem));
   }
   // Update properties if necessary.
   if (properties->length() > 0) {
-    Object* prop = CopyFixedArray(properties);
+    Object* prop = CopyFixedArray(properties, pretenure);
     if (prop->IsFailure()) return prop;
     JSObject::cast(clone)->set_properties(FixedArray::cast(prop));
   }
@@ -2668,6 +3318,11 @@ Object* Heap::AllocateStringFromAscii(Vector<const char> string,
 
 Object* Heap::AllocateStringFromUtf8(Vector<const char> string,
                                      PretenureFlag pretenure) {
+  // An ASCII string is its own UTF-8 encoding and needs no decoding.
+  if (StringKernels::IsAscii(string.start(), string.length())) {
+    return AllocateStringFromAscii(string, pretenure);
+  }
+
   // Count the number of characters in the UTF-8 string and check if
   // it is an ASCII string.
   Access<Scanner::Utf8Decoder> decoder(Scanner::utf8_decoder());
@@ -2700,23 +3355,21 @@ Object* Heap::AllocateStringFromUtf8(Vector<const char> string,
 
 Object* Heap::AllocateStringFromTwoByte(Vector<const uc16> string,
                                         PretenureFlag pretenure) {
-  // Check if the string is an ASCII string.
-  int i = 0;
-  while (i < string.length() && string[i] <= String::kMaxAsciiCharCode) i++;
-
+  // Copy the characters into the new object, which may be either ASCII or
+  // UTF-16.
   Object* result;
-  if (i == string.length()) {  // It's an ASCII string.
+  if (StringKernels::IsAscii(string.start(), string.length())) {
     result = AllocateRawAsciiString(string.length(), pretenure);
-  } else {  // It's not an ASCII string.
+    if (result->IsFailure()) return result;
+    CopyChars(SeqAsciiString::cast(result)->GetChars(),
+              string.start(),
+              string.length());
+  } else {
     result = AllocateRawTwoByteString(string.length(), pretenure);
-  }
-  if (result->IsFailure()) return result;
-
-  // Copy the characters into the new object, which may be either ASCII or
-  // UTF-16.
-  String* string_result = String::cast(result);
-  for (int i = 0; i < string.length(); i++) {
-    string_result->Set(i, string[i]);
+    if (result->IsFailure()) return result;
+    CopyChars(SeqTwoByteString::cast(result)->GetChars(),
+              string.start(),
+              string.length());
   }
   return result;
 }
@@ -2887,9 +3540,10 @@ Object* Heap::AllocateRawFixedArray(int length) {
 }
 
 
-Object* Heap::CopyFixedArray(FixedArray* src) {
+Object* Heap::CopyFixedArray(FixedArray* src, PretenureFlag pretenure) {
   int len = src->length();
-  Object* obj = AllocateRawFixedArray(len);
+  Object* obj = (pretenure == TENURED) ? AllocateFixedArray(len, TENURED)
+                                       : AllocateRawFixedArray(len);
   if (obj->IsFailure()) return obj;
   if (Heap::InNewSpace(obj)) {
     HeapObject* dst = HeapObject::cast(obj);
@@ -2953,8 +3607,8 @@ Object* Heap::AllocateFixedArray(int length, PretenureFlag pretenure) {
   // Specialize allocation for the space.
   Object* result = Failure::OutOfMemoryException();
   if (space == NEW_SPACE) {
-    // We cannot use Heap::AllocateRaw() because it will not properly
-    // allocate extra remembered set bits if always_allocate() is true and
+    // We cannot use Heap::AllocateRaw() because it will not allocate large
+    // arrays in the large object space if always_allocate() is true and
     // new space allocation fails.
     result = new_space_.AllocateRaw(size);
     if (result->IsFailure() && always_allocate()) {
@@ -3080,48 +3734,98 @@ STRUCT_LIST(MAKE_CASE)
 }
 
 
-bool Heap::IdleNotification() {
-  static const int kIdlesBeforeScavenge = 4;
-  static const int kIdlesBeforeMarkSweep = 7;
-  static const int kIdlesBeforeMarkCompact = 8;
-  static int number_idle_notifications = 0;
-  static int last_gc_count = gc_count_;
+int Heap::IdleNotification(int idle_time_in_ms) {
+  // A collection that never fits in the idle time is done anyway after a
+  // few notifications, otherwise the embedder would be told forever that
+  // work remains.
+  static const int kIdleNotificationsBeforeForcedGC = 4;
+  double deadline = OS::TimeCurrentMillis() + idle_time_in_ms;
+  bool overdue =
+      idle_notifications_without_gc_ >= kIdleNotificationsBeforeForcedGC;
+  int start_gc_count = gc_count_;
+
+  // Finish the sweeping left by the last mark-compact collection, so that
+  // allocation finds complete free lists when the embedder resumes.
+  IdleSweep(deadline);
+
+  // Scavenge if the last scavenge would have fit in the time left.
+  if (IdleScavengeWorthwhile() &&
+      (overdue || last_scavenge_time_ <= deadline - OS::TimeCurrentMillis())) {
+    CollectGarbage(0, NEW_SPACE);
+    new_space_.Shrink();
+  }
 
-  bool finished = false;
+  // Mark incrementally and collect the old generation when marking is done
+  // and the last mark-compact collection would have fit in the time left.
+  // The collection also ages the compilation cache.
+  if (IdleMarkCompactWorthwhile()) {
+    if (FLAG_incremental_marking) {
+      if (IncrementalMarking::IsStopped()) IncrementalMarking::Start();
+      IncrementalMarking::StepUntil(deadline);
+    }
+    bool marked = !FLAG_incremental_marking || IncrementalMarking::IsComplete();
+    if (overdue ||
+        (marked &&
+         last_mark_compact_time_ <= deadline - OS::TimeCurrentMillis())) {
+      CollectAllGarbage(false);
+      new_space_.Shrink();
+    }
+  }
 
-  if (last_gc_count == gc_count_) {
-    number_idle_notifications++;
+  if (gc_count_ == start_gc_count) {
+    idle_notifications_without_gc_++;
   } else {
-    number_idle_notifications = 0;
-    last_gc_count = gc_count_;
+    idle_notifications_without_gc_ = 0;
   }
 
-  if (number_idle_notifications == kIdlesBeforeScavenge) {
-    CollectGarbage(0, NEW_SPACE);
-    new_space_.Shrink();
-    last_gc_count = gc_count_;
+  // Uncommit unused memory in new space and in cached large object chunks.
+  Heap::UncommitFromSpace();
+  MemoryAllocator::ReleaseLargeObjectCache();
+  return EstimateIdleWork();
+}
 
-  } else if (number_idle_notifications == kIdlesBeforeMarkSweep) {
-    // Before doing the mark-sweep collections we clear the
-    // compilation cache to avoid hanging on to source code and
-    // generated code for cached functions.
-    CompilationCache::Clear();
 
-    CollectAllGarbage(false);
-    new_space_.Shrink();
-    last_gc_count = gc_count_;
+bool Heap::IdleScavengeWorthwhile() {
+  return new_space_.Size() > new_space_size_at_last_scavenge_;
+}
 
-  } else if (number_idle_notifications == kIdlesBeforeMarkCompact) {
-    CollectAllGarbage(true);
-    new_space_.Shrink();
-    last_gc_count = gc_count_;
-    number_idle_notifications = 0;
-    finished = true;
+
+bool Heap::IdleMarkCompactWorthwhile() {
+  return mc_count_ == 0 ||
+         context_disposed_pending_ ||
+         PromotedSpaceSize() > old_gen_size_at_last_mark_compact_;
+}
+
+
+void Heap::IdleSweep(double deadline_in_ms) {
+  OldSpace* spaces[] = { old_pointer_space_, old_data_space_, code_space_ };
+  double start = OS::TimeCurrentMillis();
+  int pages = 0;
+  for (int i = 0; i < 3; i++) {
+    while (OS::TimeCurrentMillis() < deadline_in_ms &&
+           spaces[i]->SweepNextPage()) {
+      pages++;
+    }
   }
+  if (pages > 0) {
+    idle_sweep_time_per_page_ = (OS::TimeCurrentMillis() - start) / pages;
+  }
+}
 
-  // Uncommit unused memory in new space.
-  Heap::UncommitFromSpace();
-  return finished;
+
+int Heap::EstimateIdleWork() {
+  int unswept_pages = old_pointer_space_->CountUnsweptPages() +
+                      old_data_space_->CountUnsweptPages() +
+                      code_space_->CountUnsweptPages();
+  bool scavenge = IdleScavengeWorthwhile();
+  bool mark_compact = IdleMarkCompactWorthwhile();
+  if (unswept_pages == 0 && !scavenge && !mark_compact) return 0;
+
+  double time = unswept_pages * idle_sweep_time_per_page_;
+  if (scavenge) time += last_scavenge_time_;
+  if (mark_compact) time += last_mark_compact_time_;
+  // Pending work is never reported as taking no time.
+  return Max(1, static_cast<int>(time + 0.5));
 }
 
 
@@ -3241,6 +3945,8 @@ void Heap::Verify() {
 
   new_space_.Verify();
 
+  FreeAllocationBuffers();
+  StoreBuffer::Compact();
   VerifyPointersAndRSetVisitor rset_visitor;
   old_pointer_space_->Verify(&rset_visitor);
   map_space_->Verify(&rset_visitor);
@@ -3301,69 +4007,6 @@ void Heap::ZapFromSpace() {
 #endif  // DEBUG
 
 
-int Heap::IterateRSetRange(Address object_start,
-                           Address object_end,
-                           Address rset_start,
-                           ObjectSlotCallback copy_object_func) {
-  Address object_address = object_start;
-  Address rset_address = rset_start;
-  int set_bits_count = 0;
-
-  // Loop over all the pointers in [object_start, object_end).
-  while (object_address < object_end) {
-    uint32_t rset_word = Memory::uint32_at(rset_address);
-    if (rset_word != 0) {
-      uint32_t result_rset = rset_word;
-      for (uint32_t bitmask = 1; bitmask != 0; bitmask = bitmask << 1) {
-        // Do not dereference pointers at or past object_end.
-        if ((rset_word & bitmask) != 0 && object_address < object_end) {
-          Object** object_p = reinterpret_cast<Object**>(object_address);
-          if (Heap::InNewSpace(*object_p)) {
-            copy_object_func(reinterpret_cast<HeapObject**>(object_p));
-          }
-          // If this pointer does not need to be remembered anymore, clear
-          // the remembered set bit.
-          if (!Heap::InNewSpace(*object_p)) result_rset &= ~bitmask;
-          set_bits_count++;
-        }
-        object_address += kPointerSize;
-      }
-      // Update the remembered set if it has changed.
-      if (result_rset != rset_word) {
-        Memory::uint32_at(rset_address) = result_rset;
-      }
-    } else {
-      // No bits in the word were set.  This is the common case.
-      object_address += kPointerSize * kBitsPerInt;
-    }
-    rset_address += kIntSize;
-  }
-  return set_bits_count;
-}
-
-
-void Heap::IterateRSet(PagedSpace* space, ObjectSlotCallback copy_object_func) {
-  ASSERT(Page::is_rset_in_use());
-  ASSERT(space == old_pointer_space_ || space == map_space_);
-
-  static void* paged_rset_histogram = StatsTable::CreateHistogram(
-      "V8.RSetPaged",
-      0,
-      Page::kObjectAreaSize / kPointerSize,
-      30);
-
-  PageIterator it(space, PageIterator::PAGES_IN_USE);
-  while (it.has_next()) {
-    Page* page = it.next();
-    int count = IterateRSetRange(page->ObjectAreaStart(), page->AllocationTop(),
-                                 page->RSetStart(), copy_object_func);
-    if (paged_rset_histogram != NULL) {
-      StatsTable::AddHistogramSample(paged_rset_histogram, count);
-    }
-  }
-}
-
-
 void Heap::IterateRoots(ObjectVisitor* v, VisitMode mode) {
   IterateStrongRoots(v, mode);
   IterateWeakRoots(v, mode);
@@ -3607,6 +4250,8 @@ bool Heap::Setup(bool create_heap_objects) {
   if (lo_space_ == NULL) return false;
   if (!lo_space_->Setup()) return false;
 
+  if (!StoreBuffer::Setup()) return false;
+
   if (create_heap_objects) {
     // Create initial maps.
     if (!CreateInitialMaps()) return false;
@@ -3644,6 +4289,9 @@ void Heap::SetStackLimits() {
 
 
 void Heap::TearDown() {
+  IncrementalMarking::TearDown();
+  StoreBuffer::TearDown();
+
   GlobalHandles::TearDown();
 
   ExternalStringTable::TearDown();
@@ -4086,7 +4734,10 @@ GCTracer::GCTracer()
       gc_count_(0),
       full_gc_count_(0),
       is_compacting_(false),
-      marked_count_(0) {
+      marked_count_(0),
+      incremental_marking_steps_(0),
+      incremental_marking_duration_(0.0),
+      longest_incremental_marking_step_(0.0) {
   // These two fields reflect the state of the previous full collection.
   // Set them before they are changed by the collector.
   previous_has_compacted_ = MarkCompactCollector::HasCompacted();
@@ -4105,7 +4756,15 @@ GCTracer::~GCTracer() {
   PrintF("%s %.1f -> %.1f MB, ",
          CollectorString(), start_size_, SizeOfHeapObjects());
   if (external_time > 0) PrintF("%d / ", external_time);
-  PrintF("%d ms.\n", time);
+  PrintF("%d ms", time);
+  if (incremental_marking_steps_ > 0) {
+    PrintF(" (+ %d ms in %d steps since start of marking, "
+           "biggest step %d ms)",
+           static_cast<int>(incremental_marking_duration_),
+           incremental_marking_steps_,
+           static_cast<int>(longest_incremental_marking_step_));
+  }
+  PrintF(".\n");
 
 #if defined(ENABLE_LOGGING_AND_PROFILING)
   Heap::PrintShortHeapStatistics();
@@ -30,6 +30,7 @@
 
 #include <math.h>
 
+#include "store-buffer.h"
 #include "zone-inl.h"
 
 
@@ -230,6 +231,18 @@ class Heap : public AllStatic {
   static int InitialSemiSpaceSize() { return initial_semispace_size_; }
   static int MaxOldGenerationSize() { return max_old_generation_size_; }
 
+  // Sets the embedder's soft and hard limits on the old generation size.
+  // Zero means no limit.  Returns false if the limits are invalid.
+  static bool SetOldGenerationLimits(int soft_limit, int hard_limit);
+  static void SetOldGenerationSoftLimitCallback(
+      OldGenerationSoftLimitCallback callback) {
+    old_gen_soft_limit_callback_ = callback;
+  }
+
+  // The number of bytes the capacity of the old generation can grow by
+  // before it reaches the hard limit.
+  static int OldGenerationHardLimitAvailable();
+
   // Returns the capacity of the heap in bytes w/o growing. Heap grows when
   // more spaces are needed until it reaches the limit.
   static int Capacity();
@@ -248,6 +261,10 @@ class Heap : public AllStatic {
   // Returns of size of all objects residing in the heap.
   static int SizeOfObjects();
 
+  // Returns the number of garbage collections so far.  Objects have not
+  // moved while it is unchanged.
+  static int gc_count() { return gc_count_; }
+
   // Return the starting address and a mask for the new space.  And-masking an
   // address with the mask will result in the start address of the new space
   // for all addresses in either semispace.
@@ -278,6 +295,13 @@ class Heap : public AllStatic {
     return new_space_.allocation_limit_address();
   }
 
+  static Address* OldPointerSpaceAllocationTopAddress() {
+    return old_pointer_space_->allocation_buffer_top_address();
+  }
+  static Address* OldPointerSpaceAllocationLimitAddress() {
+    return old_pointer_space_->allocation_buffer_limit_address();
+  }
+
   // Uncommit unused semi space.
   static bool UncommitFromSpace() { return new_space_.UncommitFromSpace(); }
 
@@ -304,7 +328,8 @@ class Heap : public AllStatic {
   // Returns a deep copy of the JavaScript object.
   // Properties and elements are copied too.
   // Returns failure if allocation failed.
-  static Object* CopyJSObject(JSObject* source);
+  static Object* CopyJSObject(JSObject* source,
+                              PretenureFlag pretenure = NOT_TENURED);
 
   // Allocates the function prototype.
   // Returns Failure::RetryAfterGC(requested_bytes, space) if the allocation
@@ -454,7 +479,8 @@ class Heap : public AllStatic {
 
   // Make a copy of src and return it. Returns
   // Failure::RetryAfterGC(requested_bytes, space) if the allocation failed.
-  static Object* CopyFixedArray(FixedArray* src);
+  static Object* CopyFixedArray(FixedArray* src,
+                                PretenureFlag pretenure = NOT_TENURED);
 
   // Allocates a fixed array initialized with the hole values.
   // Returns Failure::RetryAfterGC(requested_bytes, space) if the allocation
@@ -693,18 +719,6 @@ class Heap : public AllStatic {
   // Iterates over all the other roots in the heap.
   static void IterateWeakRoots(ObjectVisitor* v, VisitMode mode);
 
-  // Iterates remembered set of an old space.
-  static void IterateRSet(PagedSpace* space, ObjectSlotCallback callback);
-
-  // Iterates a range of remembered set addresses starting with rset_start
-  // corresponding to the range of allocated pointers
-  // [object_start, object_end).
-  // Returns the number of bits that were set.
-  static int IterateRSetRange(Address object_start,
-                              Address object_end,
-                              Address rset_start,
-                              ObjectSlotCallback copy_object_func);
-
   // Returns whether the object resides in new space.
   static inline bool InNewSpace(Object* object);
   static inline bool InFromSpace(Object* object);
@@ -798,20 +812,21 @@ class Heap : public AllStatic {
   static void ScavengePointer(HeapObject** p);
   static inline void ScavengeObject(HeapObject** p, HeapObject* object);
 
-  // Clear a range of remembered set addresses corresponding to the object
-  // area address 'start' with size 'size_in_bytes', eg, when adding blocks
-  // to the free list.
-  static void ClearRSetRange(Address start, int size_in_bytes);
-
-  // Rebuild remembered set in old and map spaces.
+  // Rebuild the store buffer from the objects in the old pointer, map and
+  // large object spaces.
   static void RebuildRSets();
 
-  // Update an old object's remembered set
+  // Records the slots of an old object that point into new space in the
+  // store buffer.
   static int UpdateRSet(HeapObject* obj);
 
   // Commits from space if it is uncommitted.
   static void EnsureFromSpaceIsCommitted();
 
+  // Gives the unused parts of the old space allocation buffers back to
+  // their spaces, so that the old spaces can be iterated.
+  static void FreeAllocationBuffers();
+
   // Support for partial snapshots.  After calling this we can allocate a
   // certain number of bytes using only linear allocation (with a
   // LinearAllocationScope and an AlwaysAllocateScope) without using freelists
@@ -848,12 +863,28 @@ class Heap : public AllStatic {
   static Object* AllocateRawFixedArray(int length);
 
   // True if we have reached the allocation limit in the old generation that
-  // should force the next GC (caused normally) to be a full one.
+  // should force the next GC (caused normally) to be a full one.  Growing
+  // past the soft limit forces one as well, so that the soft limit callback
+  // is only called for memory that a full GC cannot reclaim.
   static bool OldGenerationPromotionLimitReached() {
-    return (PromotedSpaceSize() + PromotedExternalMemorySize())
+    int old_gen_size = PromotedSpaceSize();
+    if (old_gen_soft_limit_ > 0 &&
+        !old_gen_soft_limit_exceeded_ &&
+        old_gen_size > old_gen_soft_limit_) {
+      return true;
+    }
+    return (old_gen_size + PromotedExternalMemorySize())
            > old_gen_promotion_limit_;
   }
 
+  // True if the old generation has used up half of the room it was given
+  // before the promotion limit at the last full GC.  This is when
+  // incremental marking is started.
+  static bool OldGenerationIncrementalMarkingLimitReached() {
+    return (PromotedSpaceSize() + PromotedExternalMemorySize())
+           > old_gen_incremental_marking_limit_;
+  }
+
   static intptr_t OldGenerationSpaceAvailable() {
     return old_gen_allocation_limit_ -
            (PromotedSpaceSize() + PromotedExternalMemorySize());
@@ -865,8 +896,11 @@ class Heap : public AllStatic {
     return OldGenerationSpaceAvailable() < 0;
   }
 
-  // Can be called when the embedding application is idle.
-  static bool IdleNotification();
+  // Can be called when the embedding application is idle for the given
+  // number of milliseconds.  Performs only the GC work that is expected to
+  // fit in that time and returns an estimate, in milliseconds, of the idle
+  // work that remains.  Zero means that there is nothing left to do.
+  static int IdleNotification(int idle_time_in_ms);
 
   // Declare all the root indices.
   enum RootListIndex {
@@ -907,6 +941,20 @@ class Heap : public AllStatic {
   // scavenge since last new space expansion.
   static int survived_since_last_expansion_;
 
+  // The new space is grown when at least this percentage of the objects
+  // allocated in it survive a scavenge, and the scavenge took at most half
+  // of --scavenge_pause_budget.
+  static const int kHighSurvivalRate = 20;
+
+  // The maps of objects allocated by literals and constructors are marked
+  // as pretenured when at least kPretenuringSurvivalRate percent of their
+  // objects survive a scavenge, counting at least kPretenuringMinimumCount
+  // objects among the first kPretenuringSampleSize bytes allocated since
+  // the previous scavenge.
+  static const int kPretenuringSampleSize = 64 * KB;
+  static const int kPretenuringMinimumCount = 32;
+  static const int kPretenuringSurvivalRate = 85;
+
   static int always_allocate_scope_depth_;
   static int linear_allocation_scope_depth_;
   static bool context_disposed_pending_;
@@ -960,11 +1008,24 @@ class Heap : public AllStatic {
   // which collector to invoke.
   static int old_gen_promotion_limit_;
 
+  // Limit that starts incremental marking, if enabled, so that it can make
+  // progress before the promotion limit is reached.
+  static int old_gen_incremental_marking_limit_;
+
   // Limit that triggers a global GC as soon as is reasonable.  This is
   // checked before expanding a paged space in the old generation and on
   // every allocation in large object space.
   static int old_gen_allocation_limit_;
 
+  // Limits on the old generation size set by the embedder, zero if unset.
+  // The soft limit makes full GCs more frequent and calls the callback
+  // once each time a full GC leaves the old generation above it.  The
+  // capacity of the old generation never grows past the hard limit.
+  static int old_gen_soft_limit_;
+  static int old_gen_hard_limit_;
+  static bool old_gen_soft_limit_exceeded_;
+  static OldGenerationSoftLimitCallback old_gen_soft_limit_callback_;
+
   // Limit on the amount of externally allocated memory allowed
   // between global GCs. If reached a global GC is forced.
   static int external_allocation_limit_;
@@ -1015,6 +1076,40 @@ class Heap : public AllStatic {
   // Checks whether a global GC is necessary
   static GarbageCollector SelectGarbageCollector(AllocationSpace space);
 
+  // Sets the old generation limits after a full GC.
+  static void UpdateOldGenerationLimits();
+
+  // Idle time GC support.  The durations of the last scavenge and the last
+  // mark-compact collection, and the average time it took to sweep a page
+  // lazily when idle, all in milliseconds, are used to estimate what fits
+  // in the idle time.
+  static double last_scavenge_time_;
+  static double last_mark_compact_time_;
+  static double idle_sweep_time_per_page_;
+
+  // The sizes of the old generation after the last mark-compact collection
+  // and of new space after the last scavenge.
+  static int old_gen_size_at_last_mark_compact_;
+  static int new_space_size_at_last_scavenge_;
+
+  // The number of idle notifications in a row that did no collection.
+  static int idle_notifications_without_gc_;
+
+  // True if objects have been allocated in new space or promoted to the old
+  // generation since the last scavenge or mark-compact collection.
+  static bool IdleScavengeWorthwhile();
+  static bool IdleMarkCompactWorthwhile();
+
+  // Sweeps unswept old space pages until the deadline has passed.
+  static void IdleSweep(double deadline_in_ms);
+
+  // Estimates the time in milliseconds of the idle work that remains.
+  static int EstimateIdleWork();
+
+  // Calls the soft limit callback if a full GC has left the old generation
+  // above the soft limit for the first time since it was crossed.
+  static void CheckOldGenerationSoftLimit(GCTracer* tracer);
+
   // Performs garbage collection
   static void PerformGarbageCollection(AllocationSpace space,
                                        GarbageCollector collector,
@@ -1061,6 +1156,21 @@ class Heap : public AllStatic {
 
   // Performs a minor collection in new generation.
   static void Scavenge();
+  static void ScavengeSerially();
+
+  // Grows or shrinks the new space after a scavenge, from the number of
+  // bytes that were allocated in it, that survived in it and that were
+  // promoted, and the time the scavenge took in milliseconds.
+  static void AdjustNewSpaceCapacity(int allocated,
+                                     int survived,
+                                     int promoted,
+                                     double time);
+
+  // Marks the maps of JavaScript objects in [start, end) of the from space
+  // that mostly survived the scavenge as pretenured.  Must be called at the
+  // end of a scavenge, while the from space still holds the dead objects
+  // and the forwarding addresses of the live ones.
+  static void UpdatePretenuringDecisions(Address start, Address end);
   static void ScavengeExternalStringTable();
   static Address DoScavenge(ObjectVisitor* scavenge_visitor,
                             Address new_space_front);
@@ -1093,10 +1203,11 @@ class Heap : public AllStatic {
   static void ReportStatisticsAfterGC();
 #endif
 
-  // Rebuild remembered set in an old space.
+  // Record the pointers into new space of an old space in the store buffer.
   static void RebuildRSets(PagedSpace* space);
 
-  // Rebuild remembered set in the large object space.
+  // Record the pointers into new space of the large object space in the
+  // store buffer.
   static void RebuildRSets(LargeObjectSpace* space);
 
   // Slow part of scavenge object.
@@ -1128,6 +1239,7 @@ class Heap : public AllStatic {
   friend class DisallowAllocationFailure;
   friend class AlwaysAllocateScope;
   friend class LinearAllocationScope;
+  friend class ParallelScavenger;
 };
 
 
@@ -1207,9 +1319,9 @@ class VerifyPointersVisitor: public ObjectVisitor {
 };
 
 
-// Visitor class to verify interior pointers that have remembered set bits.
-// As VerifyPointersVisitor but also checks that remembered set bits are
-// always set for pointers into new space.
+// Visitor class to verify interior pointers that are recorded in the store
+// buffer.  As VerifyPointersVisitor but also checks that all pointers into
+// new space are in the store buffer, which must have been compacted.
 class VerifyPointersAndRSetVisitor: public ObjectVisitor {
  public:
   void VisitPointers(Object** start, Object** end) {
@@ -1219,7 +1331,7 @@ class VerifyPointersAndRSetVisitor: public ObjectVisitor {
         ASSERT(Heap::Contains(object));
         ASSERT(object->map()->IsMap());
         if (Heap::InNewSpace(object)) {
-          ASSERT(Page::IsRSetSet(reinterpret_cast<Address>(current), 0));
+          ASSERT(StoreBuffer::Contains(reinterpret_cast<Address>(current)));
         }
       }
     }
@@ -1419,6 +1531,8 @@ class MarkingStack {
 
   bool overflowed() { return overflowed_; }
 
+  void set_overflowed() { overflowed_ = true; }
+
   void clear_overflowed() { overflowed_ = false; }
 
   // Push the (marked) object on the marking stack if there is room,
@@ -1555,9 +1669,19 @@ class GCTracer BASE_EMBEDDED {
   // Increment and decrement the count of marked objects.
   void increment_marked_count() { ++marked_count_; }
   void decrement_marked_count() { --marked_count_; }
+  void add_marked_count(int count) { marked_count_ += count; }
 
   int marked_count() { return marked_count_; }
 
+  // Records the incremental marking steps that preceded this full GC.
+  void set_incremental_marking_steps(int steps,
+                                     double duration,
+                                     double longest_step) {
+    incremental_marking_steps_ = steps;
+    incremental_marking_duration_ = duration;
+    longest_incremental_marking_step_ = longest_step;
+  }
+
  private:
   // Returns a string matching the collector.
   const char* CollectorString();
@@ -1597,6 +1721,13 @@ class GCTracer BASE_EMBEDDED {
   // The count from the end of the previous full GC.  Will be zero if there
   // was no previous full GC.
   int previous_marked_count_;
+
+  // Number, total and longest duration (in ms) of the incremental marking
+  // steps performed before this full GC.  Zero if marking was not
+  // incremental.
+  int incremental_marking_steps_;
+  double incremental_marking_duration_;
+  double longest_incremental_marking_step_;
 };
 
 
@@ -105,6 +105,133 @@ void Builtins::Generate_JSConstructCall(MacroAssembler* masm) {
 }
 
 
+// Allocates and initializes the receiver of a construct call in new space
+// or, if flags is PRETENURE_OLD_POINTER_SPACE, in the allocation buffer of
+// the old pointer space.  Jumps to allocated with the JSObject in ebx, or
+// to rt_call if the allocation fails.
+// eax: initial map
+static void AllocateReceiver(MacroAssembler* masm,
+                             AllocationFlags flags,
+                             Label* rt_call,
+                             Label* allocated) {
+  Label undo_allocation;
+
+  // Now allocate the JSObject on the heap.
+  // eax: initial map
+  __ movzx_b(edi, FieldOperand(eax, Map::kInstanceSizeOffset));
+  __ shl(edi, kPointerSizeLog2);
+  __ AllocateInNewSpace(edi, ebx, edi, no_reg, rt_call, flags);
+  // Allocated the JSObject, now initialize the fields.
+  // eax: initial map
+  // ebx: JSObject
+  // edi: start of next object
+  __ mov(Operand(ebx, JSObject::kMapOffset), eax);
+  __ mov(ecx, Factory::empty_fixed_array());
+  __ mov(Operand(ebx, JSObject::kPropertiesOffset), ecx);
+  __ mov(Operand(ebx, JSObject::kElementsOffset), ecx);
+  // Set extra fields in the newly allocated object.
+  // eax: initial map
+  // ebx: JSObject
+  // edi: start of next object
+  { Label loop, entry;
+    __ mov(edx, Factory::undefined_value());
+    __ lea(ecx, Operand(ebx, JSObject::kHeaderSize));
+    __ jmp(&entry);
+    __ bind(&loop);
+    __ mov(Operand(ecx, 0), edx);
+    __ add(Operand(ecx), Immediate(kPointerSize));
+    __ bind(&entry);
+    __ cmp(ecx, Operand(edi));
+    __ j(less, &loop);
+  }
+
+  // Add the object tag to make the JSObject real, so that we can continue and
+  // jump into the continuation code at any time from now on. Any failures
+  // need to undo the allocation, so that the heap is in a consistent state
+  // and verifiable.
+  // eax: initial map
+  // ebx: JSObject
+  // edi: start of next object
+  __ or_(Operand(ebx), Immediate(kHeapObjectTag));
+
+  // Check if a non-empty properties array is needed.
+  // Allocate and initialize a FixedArray if it is.
+  // eax: initial map
+  // ebx: JSObject
+  // edi: start of next object
+  // Calculate the total number of properties described by the map.
+  __ movzx_b(edx, FieldOperand(eax, Map::kUnusedPropertyFieldsOffset));
+  __ movzx_b(ecx, FieldOperand(eax, Map::kPreAllocatedPropertyFieldsOffset));
+  __ add(edx, Operand(ecx));
+  // Calculate unused properties past the end of the in-object properties.
+  __ movzx_b(ecx, FieldOperand(eax, Map::kInObjectPropertiesOffset));
+  __ sub(edx, Operand(ecx));
+  // Done if no extra properties are to be allocated.
+  __ j(zero, allocated);
+  __ Assert(positive, "Property allocation count failed.");
+
+  // Scale the number of elements by pointer size and add the header for
+  // FixedArrays to the start of the next object calculation from above.
+  // ebx: JSObject
+  // edi: start of next object (will be start of FixedArray)
+  // edx: number of elements in properties array
+  __ AllocateInNewSpace(FixedArray::kHeaderSize,
+                        times_pointer_size,
+                        edx,
+                        edi,
+                        ecx,
+                        no_reg,
+                        &undo_allocation,
+                        static_cast<AllocationFlags>(flags |
+                                                     RESULT_CONTAINS_TOP));
+
+  // Initialize the FixedArray.
+  // ebx: JSObject
+  // edi: FixedArray
+  // edx: number of elements
+  // ecx: start of next object
+  __ mov(eax, Factory::fixed_array_map());
+  __ mov(Operand(edi, JSObject::kMapOffset), eax);  // setup the map
+  __ mov(Operand(edi, Array::kLengthOffset), edx);  // and length
+
+  // Initialize the fields to undefined.
+  // ebx: JSObject
+  // edi: FixedArray
+  // ecx: start of next object
+  { Label loop, entry;
+    __ mov(edx, Factory::undefined_value());
+    __ lea(eax, Operand(edi, FixedArray::kHeaderSize));
+    __ jmp(&entry);
+    __ bind(&loop);
+    __ mov(Operand(eax, 0), edx);
+    __ add(Operand(eax), Immediate(kPointerSize));
+    __ bind(&entry);
+    __ cmp(eax, Operand(ecx));
+    __ j(below, &loop);
+  }
+
+  // Store the initialized FixedArray into the properties field of
+  // the JSObject
+  // ebx: JSObject
+  // edi: FixedArray
+  __ or_(Operand(edi), Immediate(kHeapObjectTag));  // add the heap tag
+  __ mov(FieldOperand(ebx, JSObject::kPropertiesOffset), edi);
+
+
+  // Continue with JSObject being successfully allocated
+  // ebx: JSObject
+  __ jmp(allocated);
+
+  // Undo the setting of the new top so that the heap is verifiable. For
+  // example, the map's unused properties potentially do not match the
+  // allocated objects unused properties.
+  // ebx: JSObject (previous new top)
+  __ bind(&undo_allocation);
+  __ UndoAllocationInNewSpace(ebx, flags);
+  __ jmp(rt_call);
+}
+
+
 static void Generate_JSConstructStubHelper(MacroAssembler* masm,
                                            bool is_api_function) {
   // Enter a construct frame.
@@ -121,7 +248,6 @@ static void Generate_JSConstructStubHelper(MacroAssembler* masm,
   // preconditions is not met, the code bails out to the runtime call.
   Label rt_call, allocated;
   if (FLAG_inline_new) {
-    Label undo_allocation;
 #ifdef ENABLE_DEBUGGER_SUPPORT
     ExternalReference debug_step_in_fp =
         ExternalReference::debug_step_in_fp_address();
@@ -149,118 +275,16 @@ static void Generate_JSConstructStubHelper(MacroAssembler* masm,
     __ CmpInstanceType(eax, JS_FUNCTION_TYPE);
     __ j(equal, &rt_call);
 
-    // Now allocate the JSObject on the heap.
+    // Objects of pretenured maps are allocated in old space.
     // edi: constructor
     // eax: initial map
-    __ movzx_b(edi, FieldOperand(eax, Map::kInstanceSizeOffset));
-    __ shl(edi, kPointerSizeLog2);
-    __ AllocateInNewSpace(edi, ebx, edi, no_reg, &rt_call, NO_ALLOCATION_FLAGS);
-    // Allocated the JSObject, now initialize the fields.
-    // eax: initial map
-    // ebx: JSObject
-    // edi: start of next object
-    __ mov(Operand(ebx, JSObject::kMapOffset), eax);
-    __ mov(ecx, Factory::empty_fixed_array());
-    __ mov(Operand(ebx, JSObject::kPropertiesOffset), ecx);
-    __ mov(Operand(ebx, JSObject::kElementsOffset), ecx);
-    // Set extra fields in the newly allocated object.
-    // eax: initial map
-    // ebx: JSObject
-    // edi: start of next object
-    { Label loop, entry;
-      __ mov(edx, Factory::undefined_value());
-      __ lea(ecx, Operand(ebx, JSObject::kHeaderSize));
-      __ jmp(&entry);
-      __ bind(&loop);
-      __ mov(Operand(ecx, 0), edx);
-      __ add(Operand(ecx), Immediate(kPointerSize));
-      __ bind(&entry);
-      __ cmp(ecx, Operand(edi));
-      __ j(less, &loop);
-    }
-
-    // Add the object tag to make the JSObject real, so that we can continue and
-    // jump into the continuation code at any time from now on. Any failures
-    // need to undo the allocation, so that the heap is in a consistent state
-    // and verifiable.
-    // eax: initial map
-    // ebx: JSObject
-    // edi: start of next object
-    __ or_(Operand(ebx), Immediate(kHeapObjectTag));
-
-    // Check if a non-empty properties array is needed.
-    // Allocate and initialize a FixedArray if it is.
-    // eax: initial map
-    // ebx: JSObject
-    // edi: start of next object
-    // Calculate the total number of properties described by the map.
-    __ movzx_b(edx, FieldOperand(eax, Map::kUnusedPropertyFieldsOffset));
-    __ movzx_b(ecx, FieldOperand(eax, Map::kPreAllocatedPropertyFieldsOffset));
-    __ add(edx, Operand(ecx));
-    // Calculate unused properties past the end of the in-object properties.
-    __ movzx_b(ecx, FieldOperand(eax, Map::kInObjectPropertiesOffset));
-    __ sub(edx, Operand(ecx));
-    // Done if no extra properties are to be allocated.
-    __ j(zero, &allocated);
-    __ Assert(positive, "Property allocation count failed.");
-
-    // Scale the number of elements by pointer size and add the header for
-    // FixedArrays to the start of the next object calculation from above.
-    // ebx: JSObject
-    // edi: start of next object (will be start of FixedArray)
-    // edx: number of elements in properties array
-    __ AllocateInNewSpace(FixedArray::kHeaderSize,
-                          times_pointer_size,
-                          edx,
-                          edi,
-                          ecx,
-                          no_reg,
-                          &undo_allocation,
-                          RESULT_CONTAINS_TOP);
-
-    // Initialize the FixedArray.
-    // ebx: JSObject
-    // edi: FixedArray
-    // edx: number of elements
-    // ecx: start of next object
-    __ mov(eax, Factory::fixed_array_map());
-    __ mov(Operand(edi, JSObject::kMapOffset), eax);  // setup the map
-    __ mov(Operand(edi, Array::kLengthOffset), edx);  // and length
-
-    // Initialize the fields to undefined.
-    // ebx: JSObject
-    // edi: FixedArray
-    // ecx: start of next object
-    { Label loop, entry;
-      __ mov(edx, Factory::undefined_value());
-      __ lea(eax, Operand(edi, FixedArray::kHeaderSize));
-      __ jmp(&entry);
-      __ bind(&loop);
-      __ mov(Operand(eax, 0), edx);
-      __ add(Operand(eax), Immediate(kPointerSize));
-      __ bind(&entry);
-      __ cmp(eax, Operand(ecx));
-      __ j(below, &loop);
-    }
-
-    // Store the initialized FixedArray into the properties field of
-    // the JSObject
-    // ebx: JSObject
-    // edi: FixedArray
-    __ or_(Operand(edi), Immediate(kHeapObjectTag));  // add the heap tag
-    __ mov(FieldOperand(ebx, JSObject::kPropertiesOffset), edi);
-
-
-    // Continue with JSObject being successfully allocated
-    // ebx: JSObject
-    __ jmp(&allocated);
-
-    // Undo the setting of the new top so that the heap is verifiable. For
-    // example, the map's unused properties potentially do not match the
-    // allocated objects unused properties.
-    // ebx: JSObject (previous new top)
-    __ bind(&undo_allocation);
-    __ UndoAllocationInNewSpace(ebx);
+    Label pretenured;
+    __ movzx_b(ebx, FieldOperand(eax, Map::kBitField2Offset));
+    __ test(ebx, Immediate(1 << Map::kIsPretenured));
+    __ j(not_zero, &pretenured);
+    AllocateReceiver(masm, NO_ALLOCATION_FLAGS, &rt_call, &allocated);
+    __ bind(&pretenured);
+    AllocateReceiver(masm, PRETENURE_OLD_POINTER_SPACE, &rt_call, &allocated);
   }
 
   // Allocate the new receiver object using the runtime call.
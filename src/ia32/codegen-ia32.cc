@@ -7208,8 +7208,9 @@ Result CodeGenerator::EmitKeyedStore(StaticType* key_type) {
                                            tmp.reg());
 
     // Check that the value is a smi if it is not a constant.  We can skip
-    // the write barrier for smis and constants.
-    if (!value_is_constant) {
+    // the write barrier for smis and constants, unless incremental marking
+    // needs to see the store.
+    if (!value_is_constant || FLAG_incremental_marking) {
       __ test(result.reg(), Immediate(kSmiTagMask));
       deferred->Branch(not_zero);
     }
@@ -7528,6 +7529,13 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   __ cmp(ecx, Factory::undefined_value());
   __ j(equal, &slow_case);
 
+  // Copies of pretenured boilerplates are allocated in old space by the
+  // runtime.
+  __ mov(eax, FieldOperand(ecx, HeapObject::kMapOffset));
+  __ movzx_b(eax, FieldOperand(eax, Map::kBitField2Offset));
+  __ test(eax, Immediate(1 << Map::kIsPretenured));
+  __ j(not_zero, &slow_case);
+
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
   __ AllocateInNewSpace(size, eax, ebx, edx, &slow_case, TAG_OBJECT);
@@ -47,99 +47,68 @@ MacroAssembler::MacroAssembler(void* buffer, int size)
 }
 
 
-static void RecordWriteHelper(MacroAssembler* masm,
-                              Register object,
-                              Register addr,
-                              Register scratch) {
-  Label fast;
-
-  // Compute the page start address from the heap object pointer, and reuse
-  // the 'object' register for it.
-  masm->and_(object, ~Page::kPageAlignmentMask);
-  Register page_start = object;
-
-  // Compute the bit addr in the remembered set/index of the pointer in the
-  // page. Reuse 'addr' as pointer_offset.
-  masm->sub(addr, Operand(page_start));
-  masm->shr(addr, kObjectAlignmentBits);
-  Register pointer_offset = addr;
-
-  // If the bit offset lies beyond the normal remembered set range, it is in
-  // the extra remembered set area of a large object.
-  masm->cmp(pointer_offset, Page::kPageSize / kPointerSize);
-  masm->j(less, &fast);
-
-  // Adjust 'page_start' so that addressing using 'pointer_offset' hits the
-  // extra remembered set after the large object.
-
-  // Find the length of the large object (FixedArray).
-  masm->mov(scratch, Operand(page_start, Page::kObjectStartOffset
-                                         + FixedArray::kLengthOffset));
-  Register array_length = scratch;
-
-  // Extra remembered set starts right after the large object (a FixedArray), at
-  //   page_start + kObjectStartOffset + objectSize
-  // where objectSize is FixedArray::kHeaderSize + kPointerSize * array_length.
-  // Add the delta between the end of the normal RSet and the start of the
-  // extra RSet to 'page_start', so that addressing the bit using
-  // 'pointer_offset' hits the extra RSet words.
-  masm->lea(page_start,
-            Operand(page_start, array_length, times_pointer_size,
-                    Page::kObjectStartOffset + FixedArray::kHeaderSize
-                        - Page::kRSetEndOffset));
-
-  // NOTE: For now, we use the bit-test-and-set (bts) x86 instruction
-  // to limit code size. We should probably evaluate this decision by
-  // measuring the performance of an equivalent implementation using
-  // "simpler" instructions
-  masm->bind(&fast);
-  masm->bts(Operand(page_start, Page::kRSetOffset), pointer_offset);
-}
-
-
-class RecordWriteStub : public CodeStub {
+// Calls the store buffer's overflow function, preserving all registers.
+static void CallStoreBufferOverflowFunction(MacroAssembler* masm) {
+  masm->pushad();
+  masm->PrepareCallCFunction(0, eax);
+  masm->CallCFunction(ExternalReference::store_buffer_overflow_function(), 0);
+  masm->popad();
+}
+
+
+class StoreBufferOverflowStub : public CodeStub {
  public:
-  RecordWriteStub(Register object, Register addr, Register scratch)
-      : object_(object), addr_(addr), scratch_(scratch) { }
+  StoreBufferOverflowStub() { }
 
   void Generate(MacroAssembler* masm);
 
  private:
-  Register object_;
-  Register addr_;
-  Register scratch_;
-
 #ifdef DEBUG
   void Print() {
-    PrintF("RecordWriteStub (object reg %d), (addr reg %d), (scratch reg %d)\n",
-           object_.code(), addr_.code(), scratch_.code());
+    PrintF("StoreBufferOverflowStub\n");
   }
 #endif
 
-  // Minor key encoding in 12 bits of three registers (object, address and
-  // scratch) OOOOAAAASSSS.
-  class ScratchBits: public BitField<uint32_t, 0, 4> {};
-  class AddressBits: public BitField<uint32_t, 4, 4> {};
-  class ObjectBits: public BitField<uint32_t, 8, 4> {};
-
   Major MajorKey() { return RecordWrite; }
-
-  int MinorKey() {
-    // Encode the registers.
-    return ObjectBits::encode(object_.code()) |
-           AddressBits::encode(addr_.code()) |
-           ScratchBits::encode(scratch_.code());
-  }
+  int MinorKey() { return 0; }
 };
 
 
-void RecordWriteStub::Generate(MacroAssembler* masm) {
-  RecordWriteHelper(masm, object_, addr_, scratch_);
+void StoreBufferOverflowStub::Generate(MacroAssembler* masm) {
+  CallStoreBufferOverflowFunction(masm);
   masm->ret(0);
 }
 
 
-// Set the remembered set bit for [object+offset].
+// Appends the slot address in 'addr' to the store buffer.  When the store
+// buffer is full its overflow function is called, through a shared stub
+// unless a stub is being generated already.  Clobbers 'scratch'.
+static void RecordWriteHelper(MacroAssembler* masm,
+                              Register addr,
+                              Register scratch) {
+  Label done;
+
+  ExternalReference store_buffer_top = ExternalReference::store_buffer_top();
+  masm->mov(scratch, Operand::StaticVariable(store_buffer_top));
+  masm->mov(Operand(scratch, 0), addr);
+  masm->add(Operand(scratch), Immediate(kPointerSize));
+  masm->mov(Operand::StaticVariable(store_buffer_top), scratch);
+  masm->cmp(scratch,
+            Operand::StaticVariable(ExternalReference::store_buffer_limit()));
+  masm->j(not_equal, &done);
+
+  if (masm->generating_stub()) {
+    CallStoreBufferOverflowFunction(masm);
+  } else {
+    StoreBufferOverflowStub stub;
+    masm->CallStub(&stub);
+  }
+
+  masm->bind(&done);
+}
+
+
+// Record the slot [object+offset] in the store buffer.
 // object is the object being stored into, value is the object being stored.
 // If offset is zero, then the scratch register contains the array index into
 // the elements array represented as a Smi.
@@ -151,9 +120,8 @@ void MacroAssembler::RecordWrite(Register object, int offset,
   // registers are esi.
   ASSERT(!object.is(esi) && !value.is(esi) && !scratch.is(esi));
 
-  // First, check if a remembered set write is even needed. The tests below
-  // catch stores of Smis and stores into young gen (which does not have space
-  // for the remembered set bits.
+  // First, check if a store buffer entry is even needed. The tests below
+  // catch stores of Smis and stores into young gen.
   Label done;
 
   // Skip barrier if writing a smi.
@@ -175,43 +143,19 @@ void MacroAssembler::RecordWrite(Register object, int offset,
     j(equal, &done);
   }
 
-  if ((offset > 0) && (offset < Page::kMaxHeapObjectSize)) {
-    // Compute the bit offset in the remembered set, leave it in 'value'.
-    lea(value, Operand(object, offset));
-    and_(value, Page::kPageAlignmentMask);
-    shr(value, kPointerSizeLog2);
-
-    // Compute the page address from the heap object pointer, leave it in
-    // 'object'.
-    and_(object, ~Page::kPageAlignmentMask);
-
-    // NOTE: For now, we use the bit-test-and-set (bts) x86 instruction
-    // to limit code size. We should probably evaluate this decision by
-    // measuring the performance of an equivalent implementation using
-    // "simpler" instructions
-    bts(Operand(object, Page::kRSetOffset), value);
+  Register dst = scratch;
+  if (offset != 0) {
+    lea(dst, Operand(object, offset - kHeapObjectTag));
   } else {
-    Register dst = scratch;
-    if (offset != 0) {
-      lea(dst, Operand(object, offset));
-    } else {
-      // array access: calculate the destination address in the same manner as
-      // KeyedStoreIC::GenerateGeneric.  Multiply a smi by 2 to get an offset
-      // into an array of words.
-      ASSERT_EQ(1, kSmiTagSize);
-      ASSERT_EQ(0, kSmiTag);
-      lea(dst, Operand(object, dst, times_half_pointer_size,
-                       FixedArray::kHeaderSize - kHeapObjectTag));
-    }
-    // If we are already generating a shared stub, not inlining the
-    // record write code isn't going to save us any memory.
-    if (generating_stub()) {
-      RecordWriteHelper(this, object, dst, value);
-    } else {
-      RecordWriteStub stub(object, dst, value);
-      CallStub(&stub);
-    }
+    // array access: calculate the destination address in the same manner as
+    // KeyedStoreIC::GenerateGeneric.  Multiply a smi by 2 to get an offset
+    // into an array of words.
+    ASSERT_EQ(1, kSmiTagSize);
+    ASSERT_EQ(0, kSmiTag);
+    lea(dst, Operand(object, dst, times_half_pointer_size,
+                     FixedArray::kHeaderSize - kHeapObjectTag));
   }
+  RecordWriteHelper(this, dst, value);
 
   bind(&done);
 
@@ -720,12 +664,27 @@ void MacroAssembler::CheckAccessGlobalProxy(Register holder_reg,
 }
 
 
+static ExternalReference AllocationTopAddress(AllocationFlags flags) {
+  if ((flags & PRETENURE_OLD_POINTER_SPACE) != 0) {
+    return ExternalReference::old_pointer_space_allocation_top_address();
+  }
+  return ExternalReference::new_space_allocation_top_address();
+}
+
+
+static ExternalReference AllocationLimitAddress(AllocationFlags flags) {
+  if ((flags & PRETENURE_OLD_POINTER_SPACE) != 0) {
+    return ExternalReference::old_pointer_space_allocation_limit_address();
+  }
+  return ExternalReference::new_space_allocation_limit_address();
+}
+
+
 void MacroAssembler::LoadAllocationTopHelper(Register result,
                                              Register result_end,
                                              Register scratch,
                                              AllocationFlags flags) {
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Just return if allocation top is already known.
   if ((flags & RESULT_CONTAINS_TOP) != 0) {
@@ -751,14 +710,14 @@ void MacroAssembler::LoadAllocationTopHelper(Register result,
 
 
 void MacroAssembler::UpdateAllocationTopHelper(Register result_end,
-                                               Register scratch) {
+                                               Register scratch,
+                                               AllocationFlags flags) {
   if (FLAG_debug_code) {
     test(result_end, Immediate(kObjectAlignmentMask));
     Check(zero, "Unaligned allocation in new space");
   }
 
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Update new top. Use scratch if available.
   if (scratch.is(no_reg)) {
@@ -782,7 +741,7 @@ void MacroAssembler::AllocateInNewSpace(int object_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   lea(result_end, Operand(result, object_size));
   cmp(result_end, Operand::StaticVariable(new_space_allocation_limit));
   j(above, gc_required, not_taken);
@@ -793,7 +752,7 @@ void MacroAssembler::AllocateInNewSpace(int object_size,
   }
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 }
 
 
@@ -812,7 +771,7 @@ void MacroAssembler::AllocateInNewSpace(int header_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   lea(result_end, Operand(result, element_count, element_size, header_size));
   cmp(result_end, Operand::StaticVariable(new_space_allocation_limit));
   j(above, gc_required);
@@ -823,7 +782,7 @@ void MacroAssembler::AllocateInNewSpace(int header_size,
   }
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 }
 
 
@@ -840,7 +799,7 @@ void MacroAssembler::AllocateInNewSpace(Register object_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   if (!object_size.is(result_end)) {
     mov(result_end, object_size);
   }
@@ -854,13 +813,13 @@ void MacroAssembler::AllocateInNewSpace(Register object_size,
   }
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 }
 
 
-void MacroAssembler::UndoAllocationInNewSpace(Register object) {
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+void MacroAssembler::UndoAllocationInNewSpace(Register object,
+                                              AllocationFlags flags) {
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Make sure the object has no tag before resetting top.
   and_(Operand(object), Immediate(~kHeapObjectTagMask));
@@ -2095,6 +2095,12 @@ Object* ConstructStubCompiler::CompileConstructStub(
   __ CmpObjectType(ebx, MAP_TYPE, ecx);
   __ j(not_equal, &generic_stub_call);
 
+  // Objects of pretenured maps are allocated in old space by the runtime,
+  // which the generic stub calls.
+  __ movzx_b(ecx, FieldOperand(ebx, Map::kBitField2Offset));
+  __ test(ecx, Immediate(1 << Map::kIsPretenured));
+  __ j(not_zero, &generic_stub_call);
+
 #ifdef DEBUG
   // Cannot construct functions this way.
   // edi: constructor
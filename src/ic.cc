@@ -687,6 +687,7 @@ Object* LoadIC::Load(State state, Handle<Object> object, Handle<String> name) {
       // Index is an offset from the end of the object.
       int offset = map->instance_size() + (index * kPointerSize);
       if (PatchInlinedLoad(address(), map, offset)) {
+        IncrementalMarking::RecordCodePatch(map);
         set_target(megamorphic_stub());
         return lookup.holder()->FastPropertyAt(lookup.GetFieldIndex());
       }
@@ -926,7 +927,9 @@ Object* KeyedLoadIC::Load(State state,
         !object->IsJSValue() &&
         !JSObject::cast(*object)->HasIndexedInterceptor()) {
       Map* map = JSObject::cast(*object)->map();
-      PatchInlinedLoad(address(), map);
+      if (PatchInlinedLoad(address(), map)) {
+        IncrementalMarking::RecordCodePatch(map);
+      }
     }
   }
 
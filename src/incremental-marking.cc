@@ -0,0 +1,322 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "v8.h"
+
+#include "hashmap.h"
+#include "incremental-marking.h"
+
+namespace v8 {
+namespace internal {
+
+IncrementalMarking::State IncrementalMarking::state_ = STOPPED;
+int IncrementalMarking::allocated_ = 0;
+int IncrementalMarking::steps_count_ = 0;
+double IncrementalMarking::steps_took_ = 0.0;
+double IncrementalMarking::longest_step_ = 0.0;
+
+
+// Grey objects whose bodies have not been visited yet.  An object is
+// black once it has been popped from the deque and visited.
+static List<HeapObject*> marking_deque;
+
+// Objects in new space referenced from the store buffer, collected by
+// Finalize() for the mark-compact collector.
+static List<HeapObject*> new_space_references;
+
+// Side mark bitmaps, one bit per pointer-aligned word, indexed by the
+// memory allocator's chunk id.  Allocated lazily when the first object in
+// the chunk is marked.
+static uint32_t* chunk_bitmaps[MemoryAllocator::kMaxNofChunks];
+
+// Large object pages are not part of any chunk; their marks are kept in a
+// hash set keyed by object address.
+static HashMap* large_object_marks = NULL;
+
+
+static bool AddressMatch(void* key1, void* key2) {
+  return key1 == key2;
+}
+
+
+static uint32_t AddressHash(Address address) {
+  return ComputeIntegerHash(
+      static_cast<uint32_t>(reinterpret_cast<uintptr_t>(address)));
+}
+
+
+// Visitor greying the old space objects referenced from a visited object.
+// Pointers into new space are skipped; they are found through the
+// store buffer or the roots when marking is finalized.
+class IncrementalMarkingVisitor : public ObjectVisitor {
+ public:
+  void VisitPointer(Object** p) {
+    IncrementalMarking::MarkGreyIfWhite(*p);
+  }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) {
+      IncrementalMarking::MarkGreyIfWhite(*p);
+    }
+  }
+};
+
+
+bool IncrementalMarking::IsMarked(HeapObject* obj) {
+  ASSERT(!Heap::InNewSpace(obj));
+  Address address = obj->address();
+  Page* page = Page::FromAddress(address);
+  if (page->IsLargeObjectPage()) {
+    if (large_object_marks == NULL) return false;
+    return large_object_marks->Lookup(address,
+                                      AddressHash(address),
+                                      false) != NULL;
+  }
+  int chunk_id = MemoryAllocator::GetChunkId(page);
+  uint32_t* bitmap = chunk_bitmaps[chunk_id];
+  if (bitmap == NULL) return false;
+  intptr_t index =
+      (address - MemoryAllocator::chunks_[chunk_id].address()) >>
+      kPointerSizeLog2;
+  return (bitmap[index / kBitsPerInt] & (1u << (index % kBitsPerInt))) != 0;
+}
+
+
+void IncrementalMarking::SetMark(HeapObject* obj) {
+  ASSERT(!Heap::InNewSpace(obj));
+  Address address = obj->address();
+  Page* page = Page::FromAddress(address);
+  if (page->IsLargeObjectPage()) {
+    if (large_object_marks == NULL) {
+      large_object_marks = new HashMap(AddressMatch);
+    }
+    large_object_marks->Lookup(address, AddressHash(address), true);
+    return;
+  }
+  int chunk_id = MemoryAllocator::GetChunkId(page);
+  Address chunk_start = MemoryAllocator::chunks_[chunk_id].address();
+  uint32_t* bitmap = chunk_bitmaps[chunk_id];
+  if (bitmap == NULL) {
+    int words = static_cast<int>(
+        (MemoryAllocator::chunks_[chunk_id].size() / kPointerSize +
+         kBitsPerInt - 1) / kBitsPerInt);
+    bitmap = NewArray<uint32_t>(words);
+    memset(bitmap, 0, words * sizeof(uint32_t));
+    chunk_bitmaps[chunk_id] = bitmap;
+  }
+  intptr_t index = (address - chunk_start) >> kPointerSizeLog2;
+  bitmap[index / kBitsPerInt] |= 1u << (index % kBitsPerInt);
+}
+
+
+void IncrementalMarking::MarkGreyIfWhite(Object* value) {
+  if (!value->IsHeapObject() || Heap::InNewSpace(value)) return;
+  HeapObject* obj = HeapObject::cast(value);
+  if (IsMarked(obj)) return;
+  SetMark(obj);
+  marking_deque.Add(obj);
+}
+
+
+bool IncrementalMarking::WorthActivating() {
+  return FLAG_incremental_marking &&
+         Heap::OldGenerationIncrementalMarkingLimitReached();
+}
+
+
+void IncrementalMarking::Start() {
+  ASSERT(IsStopped());
+  if (FLAG_trace_incremental_marking) {
+    PrintF("[IncrementalMarking] Start\n");
+  }
+  state_ = MARKING;
+  allocated_ = 0;
+  steps_count_ = 0;
+  steps_took_ = 0.0;
+  longest_step_ = 0.0;
+
+  // Grey the old space objects referenced from the strong roots.  The
+  // roots are visited again by the mark-compact collector, so anything
+  // added to them from now on is found then.
+  IncrementalMarkingVisitor visitor;
+  Heap::IterateStrongRoots(&visitor, VISIT_ONLY_STRONG);
+}
+
+
+int IncrementalMarking::ProcessMarkingDeque(int bytes_to_process) {
+  IncrementalMarkingVisitor visitor;
+  int bytes_processed = 0;
+  while (!marking_deque.is_empty() && bytes_processed < bytes_to_process) {
+    HeapObject* obj = marking_deque.RemoveLast();
+    Map* map = obj->map();
+    MarkGreyIfWhite(map);
+    int size = obj->SizeFromMap(map);
+    obj->IterateBody(map->instance_type(), size, &visitor);
+    bytes_processed += size;
+  }
+  return bytes_processed;
+}
+
+
+void IncrementalMarking::Step(int allocated_bytes) {
+  if (!IsMarking()) return;
+  allocated_ += allocated_bytes;
+  if (allocated_ < FLAG_incremental_marking_step_size * KB) return;
+
+  int bytes_to_process = allocated_ * FLAG_incremental_marking_speed;
+  allocated_ = 0;
+  MarkingStep(bytes_to_process);
+}
+
+
+void IncrementalMarking::StepUntil(double deadline_in_ms) {
+  int bytes_per_step =
+      FLAG_incremental_marking_step_size * KB * FLAG_incremental_marking_speed;
+  while (IsMarking() && !IsComplete() &&
+         OS::TimeCurrentMillis() < deadline_in_ms) {
+    MarkingStep(bytes_per_step);
+  }
+}
+
+
+void IncrementalMarking::MarkingStep(int bytes_to_process) {
+  HistogramTimerScope incremental_marking_scope(
+      &Counters::gc_incremental_marking);
+  double start = OS::TimeCurrentMillis();
+  int bytes_processed = ProcessMarkingDeque(bytes_to_process);
+  if (marking_deque.is_empty()) state_ = COMPLETE;
+  double duration = OS::TimeCurrentMillis() - start;
+
+  steps_count_++;
+  steps_took_ += duration;
+  if (duration > longest_step_) longest_step_ = duration;
+  if (FLAG_trace_incremental_marking) {
+    PrintF("[IncrementalMarking] Step %d: %d KB marked in %.1f ms%s\n",
+           steps_count_,
+           bytes_processed / KB,
+           duration,
+           IsComplete() ? ", complete" : "");
+  }
+}
+
+
+void IncrementalMarking::RecordNewSpaceReference(HeapObject** p) {
+  ASSERT(Heap::InNewSpace(*p));
+  new_space_references.Add(*p);
+}
+
+
+void IncrementalMarking::Finalize(GCTracer* tracer) {
+  ASSERT(IsMarking());
+  double start = OS::TimeCurrentMillis();
+  ProcessMarkingDeque(kMaxInt);
+
+  // The store buffer holds every slot written since it was last compacted
+  // together with all pointers into new space.  Walking it greys the
+  // values of the former and drops them, as a scavenge would; the latter
+  // are handed to the mark-compact collector, which marks new space
+  // objects itself.
+  StoreBuffer::Iterate(&RecordNewSpaceReference);
+  ProcessMarkingDeque(kMaxInt);
+  ASSERT(marking_deque.is_empty());
+  state_ = COMPLETE;
+
+  if (FLAG_trace_incremental_marking) {
+    PrintF("[IncrementalMarking] Finalized in %.1f ms after %d steps\n",
+           OS::TimeCurrentMillis() - start,
+           steps_count_);
+  }
+  tracer->set_incremental_marking_steps(steps_count_,
+                                        steps_took_,
+                                        longest_step_);
+}
+
+
+void IncrementalMarking::IterateMarkedObjects(
+    void (*callback)(HeapObject* obj)) {
+  ASSERT(IsComplete() && marking_deque.is_empty());
+  for (int chunk_id = 0;
+       chunk_id < MemoryAllocator::kMaxNofChunks;
+       chunk_id++) {
+    uint32_t* bitmap = chunk_bitmaps[chunk_id];
+    if (bitmap == NULL) continue;
+    Address chunk_start = MemoryAllocator::chunks_[chunk_id].address();
+    int words = static_cast<int>(
+        (MemoryAllocator::chunks_[chunk_id].size() / kPointerSize +
+         kBitsPerInt - 1) / kBitsPerInt);
+    for (int i = 0; i < words; i++) {
+      uint32_t word = bitmap[i];
+      if (word == 0) continue;
+      for (int bit = 0; bit < kBitsPerInt; bit++) {
+        if ((word & (1u << bit)) == 0) continue;
+        Address address =
+            chunk_start + ((i * kBitsPerInt + bit) << kPointerSizeLog2);
+        callback(HeapObject::FromAddress(address));
+      }
+    }
+  }
+
+  if (large_object_marks == NULL) return;
+  for (HashMap::Entry* entry = large_object_marks->Start();
+       entry != NULL;
+       entry = large_object_marks->Next(entry)) {
+    callback(HeapObject::FromAddress(reinterpret_cast<Address>(entry->key)));
+  }
+}
+
+
+void IncrementalMarking::IterateNewSpaceReferences(
+    void (*callback)(HeapObject* obj)) {
+  for (int i = 0; i < new_space_references.length(); i++) {
+    callback(new_space_references[i]);
+  }
+}
+
+
+void IncrementalMarking::Stop() {
+  for (int chunk_id = 0;
+       chunk_id < MemoryAllocator::kMaxNofChunks;
+       chunk_id++) {
+    if (chunk_bitmaps[chunk_id] != NULL) {
+      DeleteArray(chunk_bitmaps[chunk_id]);
+      chunk_bitmaps[chunk_id] = NULL;
+    }
+  }
+  delete large_object_marks;
+  large_object_marks = NULL;
+  marking_deque.Clear();
+  new_space_references.Clear();
+  state_ = STOPPED;
+  allocated_ = 0;
+}
+
+
+void IncrementalMarking::TearDown() {
+  Stop();
+}
+
+} }  // namespace v8::internal
@@ -0,0 +1,153 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef V8_INCREMENTAL_MARKING_H_
+#define V8_INCREMENTAL_MARKING_H_
+
+namespace v8 {
+namespace internal {
+
+class GCTracer;
+
+// -------------------------------------------------------------------------
+// Incremental marking
+//
+// Incremental marking traces the old generation in small steps while the
+// mutator runs, so that the mark phase of the following full collection
+// only has to finish the job.  All methods are static.
+//
+// The mark-compact collector keeps its mark bits in the map word, which
+// the mutator cannot tolerate.  Incremental marking therefore records its
+// marks in side bitmaps (one per memory allocator chunk, plus a hash set
+// for large objects) and only transfers them into the map words once the
+// full collection has started.  Objects in new space are never marked
+// incrementally; the pointers into new space from marked objects are
+// found through the store buffer when marking is finalized.
+//
+// The tri-color invariant is maintained by the existing store buffer write
+// barrier: every pointer store into an old space object records the slot,
+// and the values of the slots that no longer point into new space are
+// greyed when they are dropped from the store buffer, and when marking is
+// finalized.  Code patching of inline caches, which does not
+// go through the write barrier, greys the new targets explicitly.
+class IncrementalMarking : public AllStatic {
+ public:
+  enum State {
+    STOPPED,   // Not marking.
+    MARKING,   // Marking in progress, the write barrier is active.
+    COMPLETE   // All reachable old objects found so far are marked.
+  };
+
+  static State state() { return state_; }
+  static bool IsStopped() { return state_ == STOPPED; }
+  static bool IsMarking() { return state_ != STOPPED; }
+  static bool IsComplete() { return state_ == COMPLETE; }
+
+  // Returns whether it is time to start incremental marking, i.e. whether
+  // the old generation is approaching the limit where the next full
+  // collection is triggered.
+  static bool WorthActivating();
+
+  // Greys the strong roots and starts incremental marking.
+  static void Start();
+
+  // Performs a marking step proportional to the given number of allocated
+  // bytes.  Steps are only taken once enough bytes have been allocated
+  // since the last one (see --incremental_marking_step_size).
+  static void Step(int allocated_bytes);
+
+  // Performs marking steps until marking is complete or the deadline, in
+  // OS::TimeCurrentMillis() time, has passed.  Used when the embedder is
+  // idle.
+  static void StepUntil(double deadline_in_ms);
+
+  // Called by the mark-compact collector before it starts marking.  Empties
+  // the marking deque and greys the objects referenced from the store
+  // buffer.  Afterwards all objects reachable from marked old objects are
+  // either marked themselves or in new space.  Reports the step statistics
+  // to the tracer.
+  static void Finalize(GCTracer* tracer);
+
+  // Calls the callback for every object marked by incremental marking.
+  // Only valid after Finalize().
+  static void IterateMarkedObjects(void (*callback)(HeapObject* obj));
+
+  // Calls the callback for every new space object referenced from the
+  // store buffer when marking was finalized.
+  static void IterateNewSpaceReferences(void (*callback)(HeapObject* obj));
+
+  // Releases the side bitmaps and returns to the STOPPED state.
+  static void Stop();
+
+  // Write barrier for stores that are not covered by the store buffer,
+  // such as patched code targets and inlined maps.
+  static inline void RecordCodePatch(Object* value) {
+    if (IsMarking()) MarkGreyIfWhite(value);
+  }
+
+  // Called for a store buffer slot that is about to be dropped because it
+  // no longer points into new space.
+  static inline void RecordSlot(Object** slot) {
+    if (IsMarking()) MarkGreyIfWhite(*slot);
+  }
+
+  static void TearDown();
+
+ private:
+  friend class IncrementalMarkingVisitor;
+
+  static void MarkGreyIfWhite(Object* value);
+
+  // Processes the given number of bytes of the marking deque and records
+  // the step statistics.
+  static void MarkingStep(int bytes_to_process);
+
+  // Side mark bit operations.  The object must not be in new space.
+  static bool IsMarked(HeapObject* obj);
+  static void SetMark(HeapObject* obj);
+
+  // Pops objects from the marking deque and visits their bodies until
+  // the given number of bytes has been scanned or the deque is empty.
+  // Returns the number of bytes scanned.
+  static int ProcessMarkingDeque(int bytes_to_process);
+
+  static void RecordNewSpaceReference(HeapObject** p);
+
+  static State state_;
+
+  // Bytes allocated since the last marking step.
+  static int allocated_;
+
+  // Statistics reported to the GC tracer when marking is finalized.
+  static int steps_count_;
+  static double steps_took_;
+  static double longest_step_;
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_INCREMENTAL_MARKING_H_
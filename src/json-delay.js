@@ -27,12 +27,6 @@
 
 var $JSON = global.JSON;
 
-function ParseJSONUnfiltered(text) {
-  var s = $String(text);
-  var f = %CompileString(text, true);
-  return f();
-}
-
 function Revive(holder, name, reviver) {
   var val = holder[name];
   if (IS_OBJECT(val)) {
@@ -59,7 +53,7 @@ function Revive(holder, name, reviver) {
 }
 
 function JSONParse(text, reviver) {
-  var unfiltered = ParseJSONUnfiltered(text);
+  var unfiltered = %ParseJson(TO_STRING_INLINE(text));
   if (IS_FUNCTION(reviver)) {
     return Revive({'': unfiltered}, '', reviver);
   } else {
@@ -255,6 +249,12 @@ function JSONStringify(value, replacer, space) {
   } else {
     gap = "";
   }
+  if (!IS_FUNCTION(replacer) && !IS_ARRAY(replacer)) {
+    // Try the serializer in the runtime, it handles plain objects and
+    // arrays and returns undefined for everything else.
+    var result = %StringifyJson(value, gap);
+    if (!IS_UNDEFINED(result)) return result;
+  }
   return JSONSerialize('', {'': value}, replacer, stack, indent, gap);
 }
 
@@ -1083,6 +1083,27 @@ void Logger::HeapSampleJSProducerEvent(const char* constructor,
 }
 
 
+void Logger::AllocationSampleEvent(Address* stack, int frames_count) {
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (!Log::IsEnabled() || FLAG_sample_allocations == 0) return;
+  if (frames_count == 0) return;
+  // Logged as a tick in JavaScript, so that the tick processor attributes
+  // the sample to the functions on the stack.  The stack pointer and
+  // function are not recorded.
+  LogMessageBuilder msg;
+  msg.Append("%s,", log_events_[TICK_EVENT]);
+  msg.AppendAddress(stack[0]);
+  msg.Append(",0x0,0x0,%d", static_cast<int>(JS));
+  for (int i = 1; i < frames_count; i++) {
+    msg.Append(',');
+    msg.AppendAddress(stack[i]);
+  }
+  msg.Append('\n');
+  msg.WriteToLogFile();
+#endif
+}
+
+
 void Logger::DebugTag(const char* call_site_tag) {
 #ifdef ENABLE_LOGGING_AND_PROFILING
   if (!Log::IsEnabled() || !FLAG_log) return;
@@ -1409,6 +1430,9 @@ bool Logger::Setup() {
   // --prof implies --log-code.
   if (FLAG_prof) FLAG_log_code = true;
 
+  // --sample-allocations implies --log-code.
+  if (FLAG_sample_allocations > 0) FLAG_log_code = true;
+
   // --prof_lazy controls --log-code, implies --noprof_auto.
   if (FLAG_prof_lazy) {
     FLAG_log_code = false;
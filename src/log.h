@@ -244,6 +244,11 @@ class Logger {
   static void HeapSampleStats(const char* space, const char* kind,
                               int capacity, int used);
 
+  // ==== Events logged by --sample-allocations. ====
+  // An allocation sample, logged as a tick with the given stack of return
+  // addresses, innermost frame first.
+  static void AllocationSampleEvent(Address* stack, int frames_count);
+
   static void SharedLibraryEvent(const char* library_path,
                                  uintptr_t start,
                                  uintptr_t end);
@@ -58,7 +58,10 @@ enum AllocationFlags {
   TAG_OBJECT = 1 << 0,
   // The content of the result register already contains the allocation top in
   // new space.
-  RESULT_CONTAINS_TOP = 1 << 1
+  RESULT_CONTAINS_TOP = 1 << 1,
+  // Allocate in the allocation buffer of the old pointer space instead of in
+  // new space.
+  PRETENURE_OLD_POINTER_SPACE = 1 << 2
 };
 
 // Invalid depth in prototype chain.
@@ -30,6 +30,7 @@
 #include "execution.h"
 #include "global-handles.h"
 #include "ic-inl.h"
+#include "incremental-marking.h"
 #include "mark-compact.h"
 #include "stub-cache.h"
 
@@ -42,6 +43,9 @@ namespace internal {
 bool MarkCompactCollector::force_compaction_ = false;
 bool MarkCompactCollector::compacting_collection_ = false;
 bool MarkCompactCollector::compact_on_next_gc_ = false;
+bool MarkCompactCollector::sweep_lazily_ = false;
+bool MarkCompactCollector::evacuating_ = false;
+List<Object**>* MarkCompactCollector::evacuation_slots_ = NULL;
 
 int MarkCompactCollector::previous_marked_count_ = 0;
 GCTracer* MarkCompactCollector::tracer_ = NULL;
@@ -83,13 +87,12 @@ void MarkCompactCollector::CollectGarbage() {
     UpdatePointers();
 
     RelocateObjects();
-
-    RebuildRSets();
-
   } else {
     SweepSpaces();
   }
 
+  RebuildRSets();
+
   Finish();
 
   // Save the count of marked objects remaining after the collection and
@@ -105,6 +108,10 @@ void MarkCompactCollector::Prepare(GCTracer* tracer) {
   // variable.
   tracer_ = tracer;
 
+  // Incremental marking needs the store buffer to finish, so it has to be
+  // done before the collector starts moving objects.
+  if (IncrementalMarking::IsMarking()) IncrementalMarking::Finalize(tracer);
+
 #ifdef DEBUG
   ASSERT(state_ == IDLE);
   state_ = PREPARE_GC;
@@ -120,6 +127,24 @@ void MarkCompactCollector::Prepare(GCTracer* tracer) {
       compacting_collection_ = false;
   if (FLAG_collect_maps) CreateBackPointers();
 
+  // The garbage left in the old data space by the previous collection has
+  // to be swept before the remembered set area is used again.
+  Heap::old_data_space()->EnsureSweepingCompleted();
+  sweep_lazily_ = FLAG_lazy_sweeping && !compacting_collection_;
+  if (sweep_lazily_) Heap::old_data_space()->ClearRSet();
+
+  // The slots pointing into the evacuation candidates are recorded while
+  // the bodies of the live objects are visited, which parallel markers and
+  // incremental marking do not do on the collector's thread.  The
+  // candidates are selected from the free list, so before it is cleared.
+  evacuating_ = !compacting_collection_ &&
+                FLAG_max_evacuation_candidates > 0 &&
+                FLAG_gc_parallel_marking_threads <= 1 &&
+                !IncrementalMarking::IsMarking() &&
+                Heap::old_pointer_space()->SelectEvacuationCandidates(
+                    FLAG_max_evacuation_candidates) > 0;
+  if (evacuating_) evacuation_slots_ = new List<Object**>(1024);
+
 #ifdef DEBUG
   if (compacting_collection_) {
     // We will write bookkeeping information to the remembered set area
@@ -149,7 +174,7 @@ void MarkCompactCollector::Prepare(GCTracer* tracer) {
 
 void MarkCompactCollector::Finish() {
 #ifdef DEBUG
-  ASSERT(state_ == SWEEP_SPACES || state_ == REBUILD_RSETS);
+  ASSERT(state_ == REBUILD_RSETS);
   state_ = IDLE;
 #endif
   // The stub cache is not traversed during GC; clear the cache to
@@ -218,6 +243,9 @@ void MarkCompactCollector::Finish() {
 static MarkingStack marking_stack;
 
 
+static int CountMarkedCallback(HeapObject* obj);
+
+
 static inline HeapObject* ShortCircuitConsString(Object** p) {
   // Optimization: If the heap object pointed to by p is a non-symbol
   // cons string whose right substring is Heap::empty_string, update
@@ -234,6 +262,7 @@ static inline HeapObject* ShortCircuitConsString(Object** p) {
   HeapObject* object = HeapObject::cast(*p);
   MapWord map_word = object->map_word();
   map_word.ClearMark();
+  map_word.ClearOverflow();
   InstanceType type = map_word.ToMap()->instance_type();
   if ((type & kShortcutTypeMask) != kShortcutTypeTag) return object;
 
@@ -294,6 +323,7 @@ class MarkingVisitor : public ObjectVisitor {
   void MarkObjectByPointer(Object** p) {
     if (!(*p)->IsHeapObject()) return;
     HeapObject* object = ShortCircuitConsString(p);
+    MarkCompactCollector::RecordSlot(p, object);
     MarkCompactCollector::MarkObject(object);
   }
 
@@ -324,6 +354,7 @@ class MarkingVisitor : public ObjectVisitor {
     for (Object** p = start; p < end; p++) {
       if (!(*p)->IsHeapObject()) continue;
       HeapObject* obj = HeapObject::cast(*p);
+      MarkCompactCollector::RecordSlot(p, obj);
       if (obj->IsMarked()) continue;
       VisitUnmarkedObject(obj);
     }
@@ -332,6 +363,474 @@ class MarkingVisitor : public ObjectVisitor {
 };
 
 
+// -------------------------------------------------------------------------
+// Parallel marking.
+//
+// With --gc_parallel_marking_threads=N for N > 1 the marking stack is
+// emptied by N markers: the main thread and N - 1 helper threads.  The
+// marking stack then only uses the lower half of the from space and serves
+// as a pool of work shared by all markers.  The upper half is divided into
+// one marking deque per marker.  A marker takes objects in batches from its
+// own deque, from the pool, or from the deques of the other markers, and
+// keeps the objects it pushes in a private buffer, which it spills into its
+// deque when the buffer fills or when other markers are looking for work.
+// Objects that do not fit in a deque are marked as overflowed in the heap,
+// and RefillMarkingStack finds them after the markers have finished.
+//
+// Mark bits are set with an atomic operation, so that every object is
+// visited by exactly one marker.  Parallel marking is not used while
+// incremental marking is being finished, because the mark bits of
+// incremental marking are not thread safe.
+
+// A bounded stack of marked objects.  Its marker pushes and pops at the top,
+// other markers steal from the bottom.  All accesses are serialized.
+class MarkingDeque {
+ public:
+  MarkingDeque() : mutex_(OS::CreateMutex()) { }
+
+  ~MarkingDeque() { delete mutex_; }
+
+  void Initialize(HeapObject** low, HeapObject** high) {
+    low_ = bottom_ = top_ = low;
+    high_ = high;
+    overflowed_ = false;
+  }
+
+  bool overflowed() { return overflowed_; }
+
+  void clear_overflowed() { overflowed_ = false; }
+
+  // Read without synchronization, so only a hint.
+  bool is_empty() { return bottom_ == top_; }
+
+  // Pushes count objects onto the top of the deque.  The objects that do
+  // not fit are marked as overflowed.
+  void PushBatch(HeapObject** objects, int count) {
+    ScopedLock lock(mutex_);
+    if (high_ - top_ < count && bottom_ > low_) {
+      // Reuse the space freed by thieves.
+      int size = static_cast<int>(top_ - bottom_);
+      memmove(low_, bottom_, size * sizeof(*low_));
+      bottom_ = low_;
+      top_ = low_ + size;
+    }
+    for (int i = 0; i < count; i++) {
+      if (top_ < high_) {
+        *(top_++) = objects[i];
+      } else {
+        objects[i]->SetOverflow();
+        overflowed_ = true;
+      }
+    }
+  }
+
+  // Pops up to max objects from the top.  Returns the number popped.
+  int PopBatch(HeapObject** objects, int max) {
+    ScopedLock lock(mutex_);
+    int count = 0;
+    while (count < max && top_ > bottom_) objects[count++] = *(--top_);
+    if (top_ == bottom_) top_ = bottom_ = low_;
+    return count;
+  }
+
+  // Steals up to max objects, but no more than half of the deque rounded
+  // up, from the bottom.  Returns the number stolen.
+  int StealBatch(HeapObject** objects, int max) {
+    ScopedLock lock(mutex_);
+    int count = Min(max, static_cast<int>(top_ - bottom_ + 1) / 2);
+    for (int i = 0; i < count; i++) objects[i] = *(bottom_++);
+    if (top_ == bottom_) top_ = bottom_ = low_;
+    return count;
+  }
+
+ private:
+  HeapObject** low_;
+  HeapObject** volatile bottom_;
+  HeapObject** volatile top_;
+  HeapObject** high_;
+  bool overflowed_;
+  Mutex* mutex_;
+};
+
+
+// Coordinates the markers of a parallel marking phase.
+class ParallelMarking : public AllStatic {
+ public:
+  // Whether the marking stack is emptied by parallel markers.
+  static bool IsEnabled() {
+    return markers_ != NULL && !IncrementalMarking::IsMarking();
+  }
+
+  // Divides the marking area between the marking stack and the deques of
+  // the markers.  Parallel marking is enabled until TearDown is called.
+  static void Setup(Address low, Address high);
+  static void TearDown();
+
+  // Empties the marking stack with all markers.  Like the serial
+  // EmptyMarkingStack, this may leave overflowed objects in the heap.
+  static void EmptyMarkingStack();
+
+  // Takes up to max objects from the marking stack.
+  static int TakeFromPool(HeapObject** objects, int max);
+
+  // Steals up to max objects from the deque of a marker other than the
+  // given one.
+  static int Steal(ParallelMarker* thief, HeapObject** objects, int max);
+
+  // Whether some marker is waiting for work.  Only a hint.
+  static bool HasIdleMarkers() { return idle_markers_ > 0; }
+
+  // Called by a marker that has run out of work.  Returns true if all
+  // markers are out of work and marking is done, or false if work has
+  // become available.
+  static bool Terminate();
+
+  static Mutex* mutex() { return mutex_; }
+
+ private:
+  static ParallelMarker* markers_;
+  static int marker_count_;
+  static Mutex* mutex_;
+  static volatile int idle_markers_;
+  static volatile bool pool_is_empty_;
+};
+
+
+ParallelMarker* ParallelMarking::markers_ = NULL;
+int ParallelMarking::marker_count_ = 0;
+Mutex* ParallelMarking::mutex_ = NULL;
+volatile int ParallelMarking::idle_markers_ = 0;
+volatile bool ParallelMarking::pool_is_empty_ = true;
+
+
+// Visitor for the objects popped by a parallel marker.  Unlike the
+// MarkingVisitor it never recurses, since the stack limit of helper threads
+// is not known.
+class ParallelMarkingVisitor : public ObjectVisitor {
+ public:
+  explicit ParallelMarkingVisitor(ParallelMarker* marker) : marker_(marker) { }
+
+  void VisitPointer(Object** p) {
+    MarkObjectByPointer(p);
+  }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) MarkObjectByPointer(p);
+  }
+
+  inline void VisitCodeTarget(RelocInfo* rinfo);
+  inline void VisitDebugTarget(RelocInfo* rinfo);
+
+ private:
+  inline void MarkObjectByPointer(Object** p);
+
+  ParallelMarker* marker_;
+};
+
+
+// A marker owns a deque and a private buffer of objects to visit.
+class ParallelMarker {
+ public:
+  ParallelMarker() : visitor_(this), buffer_count_(0), marked_count_(0) { }
+
+  void Initialize(HeapObject** low, HeapObject** high) {
+    deque_.Initialize(low, high);
+  }
+
+  MarkingDeque* deque() { return &deque_; }
+
+  // The number of objects marked by this marker since the last Reset.
+  int marked_count() { return marked_count_; }
+
+  void Reset() {
+    ASSERT(buffer_count_ == 0 && deque_.is_empty());
+    marked_count_ = 0;
+    deque_.clear_overflowed();
+  }
+
+  // Visits objects until all markers have run out of work.
+  void Run() {
+    while (true) {
+      for (HeapObject* object = Next(); object != NULL; object = Next()) {
+        Visit(object);
+        // Share work if some marker is idle and our deque has none.
+        if (buffer_count_ > kShareThreshold &&
+            deque_.is_empty() &&
+            ParallelMarking::HasIdleMarkers()) {
+          Spill(buffer_count_ / 2);
+        }
+      }
+      if (ParallelMarking::Terminate()) return;
+    }
+  }
+
+  void MarkObject(HeapObject* object) {
+    MapWord map_word = object->map_word();
+    if (map_word.IsMarked()) return;
+    Map* map = map_word.ToMap();
+    if (!Mark(object)) return;
+    if (map->instance_type() == MAP_TYPE) {
+      Map* object_map = reinterpret_cast<Map*>(object);
+      if (FLAG_cleanup_caches_in_maps_at_gc) {
+        object_map->ClearCodeCache();
+      }
+      if (FLAG_collect_maps &&
+          object_map->instance_type() >= FIRST_JS_OBJECT_TYPE &&
+          object_map->instance_type() <= JS_FUNCTION_TYPE) {
+        MarkMapContents(object_map);
+        return;
+      }
+    }
+    Push(object);
+  }
+
+ private:
+  static const int kBufferSize = 256;
+  static const int kBatchSize = 64;
+  static const int kShareThreshold = 16;
+
+  bool Mark(HeapObject* object) {
+    if (!MarkCompactCollector::SetMarkInParallel(object)) return false;
+    marked_count_++;
+    return true;
+  }
+
+  // The parallel version of MarkCompactCollector::MarkMapContents.
+  void MarkMapContents(Map* map) {
+    DescriptorArray* descriptors = reinterpret_cast<DescriptorArray*>(
+        *HeapObject::RawField(map, Map::kInstanceDescriptorsOffset));
+    if (Mark(descriptors)) {
+      FixedArray* contents = reinterpret_cast<FixedArray*>(
+          descriptors->get(DescriptorArray::kContentArrayIndex));
+      if (Mark(contents)) {
+        // Only the values of descriptors that are not transitions or null
+        // descriptors are live.
+        for (int i = 0; i < contents->length(); i += 2) {
+          PropertyDetails details(Smi::cast(contents->get(i + 1)));
+          if (details.type() < FIRST_PHANTOM_PROPERTY_TYPE) {
+            HeapObject* object =
+                reinterpret_cast<HeapObject*>(contents->get(i));
+            if (object->IsHeapObject()) MarkObject(object);
+          }
+        }
+      }
+      Push(descriptors);
+    }
+    visitor_.VisitPointers(HeapObject::RawField(map, Map::kPrototypeOffset),
+                           HeapObject::RawField(map, Map::kSize));
+  }
+
+  void Visit(HeapObject* object) {
+    ASSERT(object->IsMarked());
+    ASSERT(!object->IsOverflowed());
+    MapWord map_word = object->map_word();
+    map_word.ClearMark();
+    Map* map = map_word.ToMap();
+    MarkObject(map);
+    object->IterateBody(map->instance_type(), object->SizeFromMap(map),
+                        &visitor_);
+  }
+
+  void Push(HeapObject* object) {
+    if (buffer_count_ == kBufferSize) Spill(kBufferSize / 2);
+    buffer_[buffer_count_++] = object;
+  }
+
+  // Moves the count oldest objects of the buffer to the deque.
+  void Spill(int count) {
+    deque_.PushBatch(buffer_, count);
+    buffer_count_ -= count;
+    memmove(buffer_, buffer_ + count, buffer_count_ * sizeof(*buffer_));
+  }
+
+  HeapObject* Next() {
+    if (buffer_count_ == 0) {
+      buffer_count_ = deque_.PopBatch(buffer_, kBatchSize);
+    }
+    if (buffer_count_ == 0) {
+      buffer_count_ = ParallelMarking::TakeFromPool(buffer_, kBatchSize);
+    }
+    if (buffer_count_ == 0) {
+      buffer_count_ = ParallelMarking::Steal(this, buffer_, kBatchSize);
+    }
+    if (buffer_count_ == 0) return NULL;
+    return buffer_[--buffer_count_];
+  }
+
+  ParallelMarkingVisitor visitor_;
+  MarkingDeque deque_;
+  HeapObject* buffer_[kBufferSize];
+  int buffer_count_;
+  int marked_count_;
+};
+
+
+void ParallelMarkingVisitor::VisitCodeTarget(RelocInfo* rinfo) {
+  ASSERT(RelocInfo::IsCodeTarget(rinfo->rmode()));
+  Code* code = Code::GetCodeFromTargetAddress(rinfo->target_address());
+  if (FLAG_cleanup_ics_at_gc && code->is_inline_cache_stub()) {
+    IC::Clear(rinfo->pc());
+  } else {
+    marker_->MarkObject(code);
+  }
+}
+
+
+void ParallelMarkingVisitor::VisitDebugTarget(RelocInfo* rinfo) {
+  ASSERT(RelocInfo::IsJSReturn(rinfo->rmode()) &&
+         rinfo->IsPatchedReturnSequence());
+  HeapObject* code = Code::GetCodeFromTargetAddress(rinfo->call_address());
+  marker_->MarkObject(code);
+}
+
+
+void ParallelMarkingVisitor::MarkObjectByPointer(Object** p) {
+  if (!(*p)->IsHeapObject()) return;
+  marker_->MarkObject(ShortCircuitConsString(p));
+}
+
+
+class ParallelMarkingThread : public Thread {
+ public:
+  explicit ParallelMarkingThread(ParallelMarker* marker) : marker_(marker) { }
+
+  void Run() { marker_->Run(); }
+
+ private:
+  ParallelMarker* marker_;
+};
+
+
+void ParallelMarking::Setup(Address low, Address high) {
+  ASSERT(markers_ == NULL);
+  marker_count_ = FLAG_gc_parallel_marking_threads;
+  markers_ = new ParallelMarker[marker_count_];
+  mutex_ = OS::CreateMutex();
+  HeapObject** start = reinterpret_cast<HeapObject**>(low);
+  int deque_size =
+      static_cast<int>((high - low) / kPointerSize) / marker_count_;
+  for (int i = 0; i < marker_count_; i++) {
+    markers_[i].Initialize(start + i * deque_size,
+                           start + (i + 1) * deque_size);
+  }
+}
+
+
+void ParallelMarking::TearDown() {
+  delete[] markers_;
+  markers_ = NULL;
+  delete mutex_;
+  mutex_ = NULL;
+}
+
+
+void ParallelMarking::EmptyMarkingStack() {
+  if (marking_stack.is_empty()) return;
+  pool_is_empty_ = false;
+  idle_markers_ = 0;
+
+  // The main thread is the first marker.
+  List<ParallelMarkingThread*> threads(marker_count_ - 1);
+  for (int i = 1; i < marker_count_; i++) {
+    ParallelMarkingThread* thread = new ParallelMarkingThread(&markers_[i]);
+    thread->Start();
+    threads.Add(thread);
+  }
+  markers_[0].Run();
+  for (int i = 0; i < threads.length(); i++) {
+    threads[i]->Join();
+    delete threads[i];
+  }
+
+  for (int i = 0; i < marker_count_; i++) {
+    MarkCompactCollector::tracer()->add_marked_count(
+        markers_[i].marked_count());
+    if (markers_[i].deque()->overflowed()) marking_stack.set_overflowed();
+    markers_[i].Reset();
+  }
+}
+
+
+int ParallelMarking::TakeFromPool(HeapObject** objects, int max) {
+  if (pool_is_empty_) return 0;
+  ScopedLock lock(mutex_);
+  int count = 0;
+  while (count < max && !marking_stack.is_empty()) {
+    objects[count++] = marking_stack.Pop();
+  }
+  if (marking_stack.is_empty()) pool_is_empty_ = true;
+  return count;
+}
+
+
+int ParallelMarking::Steal(ParallelMarker* thief,
+                           HeapObject** objects,
+                           int max) {
+  int first = static_cast<int>(thief - markers_);
+  for (int i = 1; i < marker_count_; i++) {
+    MarkingDeque* deque = markers_[(first + i) % marker_count_].deque();
+    if (deque->is_empty()) continue;
+    int count = deque->StealBatch(objects, max);
+    if (count > 0) return count;
+  }
+  return 0;
+}
+
+
+bool ParallelMarking::Terminate() {
+  {
+    ScopedLock lock(mutex_);
+    idle_markers_++;
+  }
+  while (true) {
+    // A marker only becomes idle after emptying its own deque, and only
+    // its owner adds to a deque, so there is no work left when all markers
+    // are idle.
+    if (idle_markers_ == marker_count_) return true;
+    bool work_available = !pool_is_empty_;
+    for (int i = 0; !work_available && i < marker_count_; i++) {
+      work_available = !markers_[i].deque()->is_empty();
+    }
+    if (work_available) {
+      ScopedLock lock(mutex_);
+      idle_markers_--;
+      return false;
+    }
+    Thread::YieldCPU();
+  }
+}
+
+
+bool MarkCompactCollector::SetMarkInParallel(HeapObject* obj) {
+  if (!obj->SetMarkAtomically()) return false;
+#ifdef DEBUG
+  {
+    ScopedLock lock(ParallelMarking::mutex());
+    UpdateLiveObjectCount(obj);
+  }
+#endif
+  // See SetMark.  Other markers may set bits in the same remembered set
+  // word.
+  if (sweep_lazily_ &&
+      !Heap::InNewSpace(obj) &&
+      Heap::old_data_space()->Contains(obj)) {
+    uint32_t bitmask;
+    Address rset_address =
+        Page::ComputeRSetBitPosition(obj->address(), 0, &bitmask);
+    volatile int32_t* rset_word =
+        reinterpret_cast<volatile int32_t*>(rset_address);
+    int32_t value = *rset_word;
+    while (true) {
+      int32_t previous = OS::CompareAndSwap32(
+          rset_word, value, value | static_cast<int32_t>(bitmask));
+      if (previous == value) break;
+      value = previous;
+    }
+  }
+  return true;
+}
+
+
 // Visitor class for marking heap roots.
 class RootMarkingVisitor : public ObjectVisitor {
  public:
@@ -364,8 +863,11 @@ class RootMarkingVisitor : public ObjectVisitor {
                         &stack_visitor_);
 
     // Mark all the objects reachable from the map and body.  May leave
-    // overflowed objects in the heap.
-    MarkCompactCollector::EmptyMarkingStack(&stack_visitor_);
+    // overflowed objects in the heap.  Parallel markers are only started
+    // once there is enough work to share.
+    if (!ParallelMarking::IsEnabled() || marking_stack.is_full()) {
+      MarkCompactCollector::EmptyMarkingStack(&stack_visitor_);
+    }
   }
 };
 
@@ -462,9 +964,14 @@ void MarkCompactCollector::MarkDescriptorArray(
     PropertyDetails details(Smi::cast(contents->get(i + 1)));
     if (details.type() < FIRST_PHANTOM_PROPERTY_TYPE) {
       HeapObject* object = reinterpret_cast<HeapObject*>(contents->get(i));
-      if (object->IsHeapObject() && !object->IsMarked()) {
-        SetMark(object);
-        marking_stack.Push(object);
+      if (object->IsHeapObject()) {
+        RecordSlot(HeapObject::RawField(contents,
+                                        FixedArray::OffsetOfElementAt(i)),
+                   object);
+        if (!object->IsMarked()) {
+          SetMark(object);
+          marking_stack.Push(object);
+        }
       }
     }
   }
@@ -554,6 +1061,69 @@ void MarkCompactCollector::MarkRoots(RootMarkingVisitor* visitor) {
 }
 
 
+void MarkCompactCollector::TransferIncrementalMark(HeapObject* object) {
+  SetMark(object);
+}
+
+
+void MarkCompactCollector::MarkIncrementallyMarkedMap(HeapObject* object) {
+  ASSERT(object->IsMarked());
+  MapWord map_word = object->map_word();
+  map_word.ClearMark();
+  Map* map = map_word.ToMap();
+  // The body of the object was visited during incremental marking, but
+  // map words are changed without a write barrier.
+  MarkObject(map);
+  if (FLAG_collect_maps &&
+      map->instance_type() == MAP_TYPE &&
+      reinterpret_cast<Map*>(object)->instance_type() >= FIRST_JS_OBJECT_TYPE &&
+      reinterpret_cast<Map*>(object)->instance_type() <= JS_FUNCTION_TYPE) {
+    // The prototype field now holds the back pointer created in Prepare().
+    // Keep the maps above a live map alive, as MarkMapContents does.
+    Object* back_pointer =
+        *HeapObject::RawField(object, Map::kPrototypeOffset);
+    if (back_pointer->IsHeapObject()) {
+      MarkObject(HeapObject::cast(back_pointer));
+    }
+  }
+}
+
+
+void MarkCompactCollector::MarkNewSpaceReference(HeapObject* object) {
+  MarkObject(object);
+}
+
+
+void MarkCompactCollector::MarkIncrementallyMarkedObjects(
+    MarkingVisitor* visitor) {
+  // Objects marked incrementally have had their bodies visited, and the
+  // old objects they reference are marked too.  Only their mark bits have
+  // to be transferred.  All of them are transferred before any map is
+  // marked, because marking a map marks its descriptor array in place.
+  IncrementalMarking::IterateMarkedObjects(&TransferIncrementalMark);
+  IncrementalMarking::IterateMarkedObjects(&MarkIncrementallyMarkedMap);
+
+  // Generated code stores into global property cells without a write
+  // barrier, so the values of live cells are visited again.
+  HeapObjectIterator cell_iterator(Heap::cell_space(), &CountMarkedCallback);
+  for (HeapObject* cell = cell_iterator.next();
+       cell != NULL; cell = cell_iterator.next()) {
+    if (!cell->IsMarked()) continue;
+    Object* value =
+        *HeapObject::RawField(cell, JSGlobalPropertyCell::kValueOffset);
+    if (value->IsHeapObject()) MarkObject(HeapObject::cast(value));
+  }
+
+  // Incremental marking does not mark new space objects.  Those
+  // referenced from the old generation are found through the remembered
+  // set.
+  IncrementalMarking::IterateNewSpaceReferences(&MarkNewSpaceReference);
+  ProcessMarkingStack(visitor);
+
+  IncrementalMarking::Stop();
+}
+
+
 void MarkCompactCollector::MarkObjectGroups() {
   List<ObjectGroup*>* object_groups = GlobalHandles::ObjectGroups();
 
@@ -593,6 +1163,10 @@ void MarkCompactCollector::MarkObjectGroups() {
 // After: the marking stack is empty, and all objects reachable from the
 // marking stack have been marked, or are overflowed in the heap.
 void MarkCompactCollector::EmptyMarkingStack(MarkingVisitor* visitor) {
+  if (ParallelMarking::IsEnabled()) {
+    ParallelMarking::EmptyMarkingStack();
+    return;
+  }
   while (!marking_stack.is_empty()) {
     HeapObject* object = marking_stack.Pop();
     ASSERT(object->IsHeapObject());
@@ -683,13 +1257,23 @@ void MarkCompactCollector::MarkLiveObjects() {
   state_ = MARK_LIVE_OBJECTS;
 #endif
   // The to space contains live objects, the from space is used as a marking
-  // stack.
-  marking_stack.Initialize(Heap::new_space()->FromSpaceLow(),
-                           Heap::new_space()->FromSpaceHigh());
+  // stack.  Parallel marking gives the upper half to the markers.
+  Address marking_area_low = Heap::new_space()->FromSpaceLow();
+  Address marking_area_high = Heap::new_space()->FromSpaceHigh();
+  if (FLAG_gc_parallel_marking_threads > 1) {
+    Address middle = marking_area_low +
+        RoundDown((marking_area_high - marking_area_low) / 2, kPointerSize);
+    ParallelMarking::Setup(middle, marking_area_high);
+    marking_area_high = middle;
+  }
+  marking_stack.Initialize(marking_area_low, marking_area_high);
 
   ASSERT(!marking_stack.overflowed());
 
   RootMarkingVisitor root_visitor;
+  if (IncrementalMarking::IsMarking()) {
+    MarkIncrementallyMarkedObjects(root_visitor.stack_visitor());
+  }
   MarkRoots(&root_visitor);
 
   // The objects reachable from the roots are marked, yet unreachable
@@ -707,10 +1291,7 @@ void MarkCompactCollector::MarkLiveObjects() {
   GlobalHandles::IdentifyWeakHandles(&IsUnmarkedHeapObject);
   // Then we mark the objects and process the transitive closure.
   GlobalHandles::IterateWeakRoots(&root_visitor);
-  while (marking_stack.overflowed()) {
-    RefillMarkingStack();
-    EmptyMarkingStack(root_visitor.stack_visitor());
-  }
+  ProcessMarkingStack(root_visitor.stack_visitor());
 
   // Repeat the object groups to mark unmarked groups reachable from the
   // weak roots.
@@ -728,6 +1309,8 @@ void MarkCompactCollector::MarkLiveObjects() {
 
   // Remove object groups after marking phase.
   GlobalHandles::RemoveObjectGroups();
+
+  if (FLAG_gc_parallel_marking_threads > 1) ParallelMarking::TearDown();
 }
 
 
@@ -740,14 +1323,14 @@ static int CountMarkedCallback(HeapObject* obj) {
 
 #ifdef DEBUG
 void MarkCompactCollector::UpdateLiveObjectCount(HeapObject* obj) {
-  live_bytes_ += obj->Size();
+  // The object may already be marked by a parallel marker.
+  live_bytes_ += CountMarkedCallback(obj);
   if (Heap::new_space()->Contains(obj)) {
     live_young_objects_++;
   } else if (Heap::map_space()->Contains(obj)) {
-    ASSERT(obj->IsMap());
+    ASSERT(SafeIsMap(obj));
     live_map_objects_++;
   } else if (Heap::cell_space()->Contains(obj)) {
-    ASSERT(obj->IsJSGlobalPropertyCell());
     live_cell_objects_++;
   } else if (Heap::old_pointer_space()->Contains(obj)) {
     live_old_pointer_objects_++;
@@ -1096,52 +1679,66 @@ static void SweepSpace(NewSpace* space) {
 }
 
 
-static void SweepSpace(PagedSpace* space, DeallocateFunction dealloc) {
-  PageIterator it(space, PageIterator::PAGES_IN_USE);
-  while (it.has_next()) {
-    Page* p = it.next();
-
-    bool is_previous_alive = true;
-    Address free_start = NULL;
-    HeapObject* object;
+// Clears the mark bits of the live objects in [start, end) and deallocates
+// the non-live regions.
+static void SweepRange(Address start, Address end, DeallocateFunction dealloc) {
+  bool is_previous_alive = true;
+  Address free_start = NULL;
+  HeapObject* object;
 
-    for (Address current = p->ObjectAreaStart();
-         current < p->AllocationTop();
-         current += object->Size()) {
-      object = HeapObject::FromAddress(current);
-      if (object->IsMarked()) {
-        object->ClearMark();
-        MarkCompactCollector::tracer()->decrement_marked_count();
-        if (!is_previous_alive) {  // Transition from free to live.
-          dealloc(free_start, static_cast<int>(current - free_start));
-          is_previous_alive = true;
-        }
-      } else {
-        MarkCompactCollector::ReportDeleteIfNeeded(object);
-        if (is_previous_alive) {  // Transition from live to free.
-          free_start = current;
-          is_previous_alive = false;
-        }
+  for (Address current = start; current < end; current += object->Size()) {
+    object = HeapObject::FromAddress(current);
+    if (object->IsMarked()) {
+      object->ClearMark();
+      MarkCompactCollector::tracer()->decrement_marked_count();
+      if (!is_previous_alive) {  // Transition from free to live.
+        dealloc(free_start, static_cast<int>(current - free_start));
+        is_previous_alive = true;
+      }
+    } else {
+      MarkCompactCollector::ReportDeleteIfNeeded(object);
+      if (is_previous_alive) {  // Transition from live to free.
+        free_start = current;
+        is_previous_alive = false;
       }
-      // The object is now unmarked for the call to Size() at the top of the
-      // loop.
     }
+    // The object is now unmarked for the call to Size() at the top of the
+    // loop.
+  }
 
-    // If the last region was not live we need to deallocate from
-    // free_start to the allocation top in the page.
-    if (!is_previous_alive) {
-      int free_size = static_cast<int>(p->AllocationTop() - free_start);
-      if (free_size > 0) {
-        dealloc(free_start, free_size);
-      }
+  // If the last region was not live we need to deallocate from
+  // free_start to the end of the range.
+  if (!is_previous_alive) {
+    int free_size = static_cast<int>(end - free_start);
+    if (free_size > 0) {
+      dealloc(free_start, free_size);
     }
   }
 }
 
 
+static void SweepSpace(PagedSpace* space, DeallocateFunction dealloc) {
+  PageIterator it(space, PageIterator::PAGES_IN_USE);
+  while (it.has_next()) {
+    Page* p = it.next();
+    // Evacuation candidates are emptied by EvacuateCandidates.
+    if (p->IsEvacuationCandidate()) continue;
+    SweepRange(p->ObjectAreaStart(), p->AllocationTop(), dealloc);
+  }
+}
+
+
+// Callback for OldSpace::StartLazySweeping.
+static int UnmarkLiveObject(HeapObject* obj) {
+  ASSERT(obj->IsMarked());
+  obj->ClearMark();
+  MarkCompactCollector::tracer()->decrement_marked_count();
+  return obj->Size();
+}
+
+
 void MarkCompactCollector::DeallocateOldPointerBlock(Address start,
                                                      int size_in_bytes) {
-  Heap::ClearRSetRange(start, size_in_bytes);
   Heap::old_pointer_space()->Free(start, size_in_bytes);
 }
 
@@ -1164,7 +1761,6 @@ void MarkCompactCollector::DeallocateMapBlock(Address start,
   // valid map in their first word.  Thus, we break the free block up into
   // chunks and free them separately.
   ASSERT(size_in_bytes % Map::kSize == 0);
-  Heap::ClearRSetRange(start, size_in_bytes);
   Address end = start + size_in_bytes;
   for (Address a = start; a < end; a += Map::kSize) {
     Heap::map_space()->Free(a);
@@ -1179,7 +1775,6 @@ void MarkCompactCollector::DeallocateCellBlock(Address start,
   // individually.
   int size = Heap::cell_space()->object_size_in_bytes();
   ASSERT(size_in_bytes % size == 0);
-  Heap::ClearRSetRange(start, size_in_bytes);
   Address end = start + size_in_bytes;
   for (Address a = start; a < end; a += size) {
     Heap::cell_space()->Free(a);
@@ -1278,20 +1873,6 @@ class MapCompact {
     GlobalHandles::IterateWeakRoots(&map_updating_visitor_);
   }
 
-  void FinishMapSpace() {
-    // Iterate through to space and finish move.
-    MapIterator it;
-    HeapObject* o = it.next();
-    for (; o != first_map_to_evacuate_; o = it.next()) {
-      ASSERT(o != NULL);
-      Map* map = reinterpret_cast<Map*>(o);
-      ASSERT(!map->IsMarked());
-      ASSERT(!map->IsOverflowed());
-      ASSERT(map->IsMap());
-      Heap::UpdateRSet(map);
-    }
-  }
-
   void UpdateMapPointersInPagedSpace(PagedSpace* space) {
     ASSERT(space != Heap::map_space());
 
@@ -1460,9 +2041,15 @@ void MarkCompactCollector::SweepSpaces() {
   // bits and free the nonlive blocks (for old and map spaces).  We sweep
   // the map space last because freeing non-live maps overwrites them and
   // the other spaces rely on possibly non-live maps to get the sizes for
-  // non-live objects.
+  // non-live objects.  The old data space may be swept lazily: its dead
+  // objects keep their maps, which are all roots.
   SweepSpace(Heap::old_pointer_space(), &DeallocateOldPointerBlock);
-  SweepSpace(Heap::old_data_space(), &DeallocateOldDataBlock);
+  if (evacuating_) EvacuateCandidates();
+  if (sweep_lazily_) {
+    Heap::old_data_space()->StartLazySweeping(&UnmarkLiveObject);
+  } else {
+    SweepSpace(Heap::old_data_space(), &DeallocateOldDataBlock);
+  }
   SweepSpace(Heap::code_space(), &DeallocateCodeBlock);
   SweepSpace(Heap::cell_space(), &DeallocateCellBlock);
   SweepSpace(Heap::new_space());
@@ -1476,7 +2063,6 @@ void MarkCompactCollector::SweepSpaces() {
     map_compact.CompactMaps();
     map_compact.UpdateMapPointersInRoots();
 
-    map_compact.FinishMapSpace();
     PagedSpaces spaces;
     for (PagedSpace* space = spaces.next();
          space != NULL; space = spaces.next()) {
@@ -1491,6 +2077,147 @@ void MarkCompactCollector::SweepSpaces() {
 }
 
 
+// Helper class for updating pointers to the objects moved out of the
+// evacuation candidates.  A moved object has the address of its copy in its
+// map word.
+class EvacuationUpdatingVisitor: public ObjectVisitor {
+ public:
+  void VisitPointer(Object** p) {
+    UpdatePointer(p);
+  }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) UpdatePointer(p);
+  }
+
+ private:
+  void UpdatePointer(Object** p) {
+    if (!(*p)->IsHeapObject()) return;
+
+    HeapObject* obj = HeapObject::cast(*p);
+    if (Heap::InNewSpace(obj) ||
+        !Page::FromAddress(obj->address())->IsEvacuationCandidate()) {
+      return;
+    }
+    MapWord map_word = obj->map_word();
+    if (map_word.IsForwardingAddress()) {
+      *p = map_word.ToForwardingAddress();
+    }
+  }
+};
+
+
+void MarkCompactCollector::EvacuateCandidates() {
+  ASSERT(evacuating_);
+  OldSpace* space = Heap::old_pointer_space();
+
+  // Collect the candidates first, the copies may move the allocation top
+  // to later pages.
+  List<Page*> candidates(FLAG_max_evacuation_candidates);
+  PageIterator it(space, PageIterator::PAGES_IN_USE);
+  while (it.has_next()) {
+    Page* p = it.next();
+    if (p->IsEvacuationCandidate()) candidates.Add(p);
+  }
+
+  // Copy the live objects and leave the address of the copy in the map
+  // word of the original.  The evacuated part of each candidate ends at
+  // evacuated_ends[i].  Once an allocation fails the remaining part of the
+  // candidates is swept as usual.
+  List<Address> evacuated_ends(candidates.length());
+  bool out_of_space = false;
+  int evacuated_bytes = 0;
+  for (int i = 0; i < candidates.length(); i++) {
+    Page* p = candidates[i];
+    Address current = p->ObjectAreaStart();
+    Address end = p->AllocationTop();
+    while (!out_of_space && current < end) {
+      HeapObject* object = HeapObject::FromAddress(current);
+      if (!object->IsMarked()) {
+        ReportDeleteIfNeeded(object);
+        current += object->Size();
+        continue;
+      }
+      MapWord map_word = object->map_word();
+      map_word.ClearMark();
+      int size = object->SizeFromMap(map_word.ToMap());
+      Object* result = space->AllocateRaw(size);
+      if (result->IsFailure()) {
+        out_of_space = true;
+        break;
+      }
+      HeapObject* copy = HeapObject::cast(result);
+      memcpy(copy->address(), current, size);
+      copy->set_map_word(map_word);
+      object->set_map_word(MapWord::FromForwardingAddress(copy));
+      tracer_->decrement_marked_count();
+      if (copy->IsJSFunction()) {
+        LOG(FunctionMoveEvent(current, copy->address()));
+      }
+      evacuated_bytes += size;
+      current += size;
+    }
+    evacuated_ends.Add(current);
+    SweepRange(current, end, &DeallocateOldPointerBlock);
+  }
+
+  // Update the recorded slots and everything that was not recorded: the
+  // roots, the fields of the maps (their prototypes are restored after
+  // marking) and the fields of the copies.
+  EvacuationUpdatingVisitor updating_visitor;
+  for (int i = 0; i < evacuation_slots_->length(); i++) {
+    updating_visitor.VisitPointer(evacuation_slots_->at(i));
+  }
+  Heap::IterateRoots(&updating_visitor, VISIT_ONLY_STRONG);
+  GlobalHandles::IterateWeakRoots(&updating_visitor);
+
+  HeapObjectIterator map_iterator(Heap::map_space(), &CountMarkedCallback);
+  for (HeapObject* obj = map_iterator.next();
+       obj != NULL; obj = map_iterator.next()) {
+    if (obj->IsMarked()) {
+      reinterpret_cast<Map*>(obj)->MapIterateBody(&updating_visitor);
+    }
+  }
+
+  for (int i = 0; i < candidates.length(); i++) {
+    Address current = candidates[i]->ObjectAreaStart();
+    while (current < evacuated_ends[i]) {
+      HeapObject* object = HeapObject::FromAddress(current);
+      MapWord map_word = object->map_word();
+      if (map_word.IsForwardingAddress()) {
+        HeapObject* copy = map_word.ToForwardingAddress();
+        int size = copy->Size();
+        copy->IterateBody(copy->map()->instance_type(), size,
+                          &updating_visitor);
+        current += size;
+      } else {
+        current += object->Size();
+      }
+    }
+  }
+
+  // Nothing refers to the evacuated parts of the candidates anymore.
+  for (int i = 0; i < candidates.length(); i++) {
+    Page* p = candidates[i];
+    int size = static_cast<int>(evacuated_ends[i] - p->ObjectAreaStart());
+    if (size > 0) DeallocateOldPointerBlock(p->ObjectAreaStart(), size);
+    p->SetIsEvacuationCandidate(false);
+  }
+
+  if (FLAG_trace_evacuation) {
+    PrintF("Evacuated %d bytes from %d pages%s, %d slots recorded\n",
+           evacuated_bytes,
+           candidates.length(),
+           out_of_space ? " (out of space)" : "",
+           evacuation_slots_->length());
+  }
+
+  delete evacuation_slots_;
+  evacuation_slots_ = NULL;
+  evacuating_ = false;
+}
+
+
 // Iterate the live objects in a range of addresses (eg, a page or a
 // semispace).  The live regions of the range have been linked into a list.
 // The first live region is [first_live_start, first_live_end), and the last
@@ -1996,11 +2723,11 @@ int MarkCompactCollector::RelocateNewObject(HeapObject* obj) {
 
 
 // -------------------------------------------------------------------------
-// Phase 5: rebuild remembered sets
+// Phase 5: rebuild the store buffer
 
 void MarkCompactCollector::RebuildRSets() {
 #ifdef DEBUG
-  ASSERT(state_ == RELOCATE_OBJECTS);
+  ASSERT(state_ == RELOCATE_OBJECTS || state_ == SWEEP_SPACES);
   state_ = REBUILD_RSETS;
 #endif
   Heap::RebuildRSets();
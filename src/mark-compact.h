@@ -43,6 +43,7 @@ typedef void (*DeallocateFunction)(Address start, int size_in_bytes);
 // Forward declarations.
 class RootMarkingVisitor;
 class MarkingVisitor;
+class ParallelMarker;
 
 
 // -------------------------------------------------------------------------
@@ -144,6 +145,17 @@ class MarkCompactCollector: public AllStatic {
   // Global flag indicating whether spaces will be compacted on the next GC.
   static bool compact_on_next_gc_;
 
+  // Global flag indicating whether the old data space is swept lazily by
+  // the current GC.
+  static bool sweep_lazily_;
+
+  // Global flag indicating whether the current GC moves the live objects
+  // out of the evacuation candidate pages of the old pointer space.
+  static bool evacuating_;
+
+  // The slots found during marking that point into evacuation candidates.
+  static List<Object**>* evacuation_slots_;
+
   // The number of objects left marked at the end of the last completed full
   // GC (expected to be zero).
   static int previous_marked_count_;
@@ -167,6 +179,7 @@ class MarkCompactCollector: public AllStatic {
 
   friend class RootMarkingVisitor;
   friend class MarkingVisitor;
+  friend class ParallelMarker;
 
   // Marking operations for objects reachable from roots.
   static void MarkLiveObjects();
@@ -183,8 +196,29 @@ class MarkCompactCollector: public AllStatic {
     UpdateLiveObjectCount(obj);
 #endif
     obj->SetMark();
+    // The live objects of a lazily swept space are recorded in the
+    // remembered set area of their pages, see OldSpace::StartLazySweeping.
+    if (sweep_lazily_ &&
+        !Heap::InNewSpace(obj) &&
+        Heap::old_data_space()->Contains(obj)) {
+      Page::SetRSet(obj->address(), 0);
+    }
+  }
+
+  // Records a slot that has to be updated if its target is evacuated.
+  static inline void RecordSlot(Object** slot, HeapObject* target) {
+    if (evacuating_ &&
+        !Heap::InNewSpace(target) &&
+        Page::FromAddress(target->address())->IsEvacuationCandidate()) {
+      evacuation_slots_->Add(slot);
+    }
   }
 
+  // Marks an object on a parallel marking thread, like SetMark but without
+  // counting it in the tracer.  Returns false if another thread marked the
+  // object first.
+  static bool SetMarkInParallel(HeapObject* obj);
+
   // Creates back pointers for all map transitions, stores them in
   // the prototype field.  The original prototype pointers are restored
   // in ClearNonLiveTransitions().  All JSObject maps
@@ -199,6 +233,13 @@ class MarkCompactCollector: public AllStatic {
   // Mark the heap roots and all objects reachable from them.
   static void MarkRoots(RootMarkingVisitor* visitor);
 
+  // Transfer the marks set by incremental marking into the map words and
+  // mark what was reachable from them but not marked incrementally.
+  static void MarkIncrementallyMarkedObjects(MarkingVisitor* visitor);
+  static void TransferIncrementalMark(HeapObject* object);
+  static void MarkIncrementallyMarkedMap(HeapObject* object);
+  static void MarkNewSpaceReference(HeapObject* object);
+
   // Mark the symbol table specially.  References to symbols from the
   // symbol table are weak.
   static void MarkSymbolTable();
@@ -324,6 +365,14 @@ class MarkCompactCollector: public AllStatic {
   // regions to each space's free list.
   static void SweepSpaces();
 
+  // Moves the live objects of the evacuation candidates to the other pages
+  // of the old pointer space, updates the recorded slots, the roots, the
+  // maps and the moved objects to point to the copies, and frees the
+  // candidates.  The remaining old pointer space pages must have been
+  // swept.  If the space runs out of room the rest of the candidates are
+  // swept instead.
+  static void EvacuateCandidates();
+
   // -----------------------------------------------------------------------
   // Phase 3: Updating pointers in live objects.
   //
@@ -391,14 +440,15 @@ class MarkCompactCollector: public AllStatic {
   static int RelocateNewObject(HeapObject* obj);
 
   // -----------------------------------------------------------------------
-  // Phase 5: Rebuilding remembered sets.
+  // Phase 5: Rebuilding the store buffer.
   //
-  //  Before: The heap is in a normal state except that remembered sets
-  //          in the paged spaces are not correct.
+  //  Before: The heap is in a normal state except that the store buffer
+  //          may hold slots of freed or moved objects.
   //
   //   After: The heap is in a normal state.
 
-  // Rebuild remembered set in old and map spaces.
+  // Rebuild the store buffer from the objects in the old pointer, map and
+  // large object spaces.
   static void RebuildRSets();
 
 #ifdef DEBUG
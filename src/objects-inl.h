@@ -1038,6 +1038,17 @@ void HeapObject::set_map_word(MapWord map_word) {
 }
 
 
+bool HeapObject::SetForwardingAddressAtomically(MapWord map_word,
+                                                HeapObject* target) {
+  volatile intptr_t* slot =
+      reinterpret_cast<volatile intptr_t*>(FIELD_ADDR(this, kMapOffset));
+  intptr_t value = static_cast<intptr_t>(map_word.value_);
+  intptr_t forwarding_value = static_cast<intptr_t>(
+      MapWord::FromForwardingAddress(target).value_);
+  return OS::CompareAndSwap(slot, value, forwarding_value) == value;
+}
+
+
 HeapObject* HeapObject::FromAddress(Address address) {
   ASSERT_TAG_ALIGNED(address);
   return reinterpret_cast<HeapObject*>(address + kHeapObjectTag);
@@ -1078,6 +1089,22 @@ void HeapObject::SetMark() {
 }
 
 
+bool HeapObject::SetMarkAtomically() {
+  volatile intptr_t* slot =
+      reinterpret_cast<volatile intptr_t*>(FIELD_ADDR(this, kMapOffset));
+  intptr_t value = *slot;
+  while (true) {
+    MapWord first_word(static_cast<uintptr_t>(value));
+    if (first_word.IsMarked()) return false;
+    first_word.SetMark();
+    intptr_t marked_value = static_cast<intptr_t>(first_word.value_);
+    intptr_t previous = OS::CompareAndSwap(slot, value, marked_value);
+    if (previous == value) return true;
+    value = previous;
+  }
+}
+
+
 void HeapObject::ClearMark() {
   ASSERT(IsMarked());
   MapWord first_word = map_word();
@@ -1783,6 +1810,18 @@ void ConsString::set_second(String* value, WriteBarrierMode mode) {
 }
 
 
+Vector<const char> ConsStringIterator::ToAsciiVector() {
+  ASSERT(is_ascii_);
+  return Vector<const char>(reinterpret_cast<const char*>(start_), length_);
+}
+
+
+Vector<const uc16> ConsStringIterator::ToUC16Vector() {
+  ASSERT(!is_ascii_);
+  return Vector<const uc16>(reinterpret_cast<const uc16*>(start_), length_);
+}
+
+
 ExternalAsciiString::Resource* ExternalAsciiString::resource() {
   return *reinterpret_cast<Resource**>(FIELD_ADDR(this, kResourceOffset));
 }
@@ -2821,12 +2860,18 @@ bool StringHasher::has_trivial_hash() {
 }
 
 
+uint32_t StringHasher::AddCharacterCore(uint32_t running_hash, uint32_t c) {
+  running_hash += c;
+  running_hash += (running_hash << 10);
+  running_hash ^= (running_hash >> 6);
+  return running_hash;
+}
+
+
 void StringHasher::AddCharacter(uc32 c) {
   // Use the Jenkins one-at-a-time hash function to update the hash
   // for the given character.
-  raw_running_hash_ += c;
-  raw_running_hash_ += (raw_running_hash_ << 10);
-  raw_running_hash_ ^= (raw_running_hash_ >> 6);
+  raw_running_hash_ = AddCharacterCore(raw_running_hash_, c);
   // Incremental array index computation.
   if (is_array_index_) {
     if (c < '0' || c > '9') {
@@ -2852,9 +2897,33 @@ void StringHasher::AddCharacter(uc32 c) {
 
 void StringHasher::AddCharacterNoIndex(uc32 c) {
   ASSERT(!is_array_index());
-  raw_running_hash_ += c;
-  raw_running_hash_ += (raw_running_hash_ << 10);
-  raw_running_hash_ ^= (raw_running_hash_ >> 6);
+  raw_running_hash_ = AddCharacterCore(raw_running_hash_, c);
+}
+
+
+template <typename Char>
+void StringHasher::AddCharactersNoIndex(const Char* chars, int length) {
+  ASSERT(!is_array_index());
+  uint32_t running_hash = raw_running_hash_;
+  int i = 0;
+#if defined(V8_HOST_CAN_READ_UNALIGNED) && \
+    (defined(V8_HOST_ARCH_IA32) || defined(V8_HOST_ARCH_X64))
+  if (sizeof(Char) == 1) {
+    // Read four ASCII characters at a time and hash them in string order,
+    // which is the order of the bytes in a little endian word.
+    for (; i <= length - 4; i += 4) {
+      uint32_t word = *reinterpret_cast<const uint32_t*>(chars + i);
+      running_hash = AddCharacterCore(running_hash, word & 0xFF);
+      running_hash = AddCharacterCore(running_hash, (word >> 8) & 0xFF);
+      running_hash = AddCharacterCore(running_hash, (word >> 16) & 0xFF);
+      running_hash = AddCharacterCore(running_hash, word >> 24);
+    }
+  }
+#endif
+  for (; i < length; i++) {
+    running_hash = AddCharacterCore(running_hash, chars[i]);
+  }
+  raw_running_hash_ = running_hash;
 }
 
 
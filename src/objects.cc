@@ -36,6 +36,7 @@
 #include "macro-assembler.h"
 #include "scanner.h"
 #include "scopeinfo.h"
+#include "string-kernels.h"
 #include "string-stream.h"
 #include "utils.h"
 
@@ -4071,6 +4072,136 @@ void SafeStringInputBuffer::Seek(unsigned pos) {
 }
 
 
+ConsStringIterator::ConsStringIterator(String* string, int offset)
+    : stack_(inline_stack_),
+      depth_(0),
+      capacity_(kInlineStackSize),
+      start_(NULL),
+      is_ascii_(true),
+      length_(0),
+      offset_(offset) {
+  ASSERT(0 <= offset && offset <= string->length());
+  // Descend to the leaf containing the offset.  Only the right hand sides
+  // of the cons strings entered on the left are still to be visited.
+  while (StringShape(string).IsCons()) {
+    ConsString* cons_string = ConsString::cast(string);
+    String* first = cons_string->first();
+    int first_length = first->length();
+    if (offset < first_length) {
+      Push(cons_string->second());
+      string = first;
+    } else {
+      offset -= first_length;
+      string = cons_string->second();
+    }
+  }
+  first_leaf_ = string;
+  first_leaf_offset_ = offset;
+}
+
+
+ConsStringIterator::~ConsStringIterator() {
+  if (stack_ != inline_stack_) DeleteArray(stack_);
+}
+
+
+bool ConsStringIterator::Next() {
+  offset_ += length_;
+  String* leaf = first_leaf_;
+  int from = first_leaf_offset_;
+  first_leaf_ = NULL;
+  while (leaf == NULL || leaf->length() == from) {
+    if (depth_ == 0) {
+      length_ = 0;
+      return false;
+    }
+    leaf = stack_[--depth_];
+    from = 0;
+    while (StringShape(leaf).IsCons()) {
+      ConsString* cons_string = ConsString::cast(leaf);
+      Push(cons_string->second());
+      leaf = cons_string->first();
+    }
+  }
+  SetSegment(leaf, from);
+  return true;
+}
+
+
+void ConsStringIterator::Push(String* string) {
+  if (depth_ == capacity_) {
+    String** new_stack = NewArray<String*>(2 * capacity_);
+    memcpy(new_stack, stack_, depth_ * sizeof(stack_[0]));
+    if (stack_ != inline_stack_) DeleteArray(stack_);
+    stack_ = new_stack;
+    capacity_ *= 2;
+  }
+  stack_[depth_++] = string;
+}
+
+
+void ConsStringIterator::SetSegment(String* leaf, int from) {
+  ASSERT(!StringShape(leaf).IsCons());
+  is_ascii_ = leaf->IsAsciiRepresentation();
+  length_ = leaf->length() - from;
+  if (is_ascii_) {
+    start_ = leaf->ToAsciiVector().start() + from;
+  } else {
+    start_ = leaf->ToUC16Vector().start() + from;
+  }
+}
+
+
+template <typename Char>
+static inline int CompareCharsWithSegment(const Char* chars,
+                                          ConsStringIterator* segment,
+                                          int position,
+                                          int length) {
+  if (segment->is_ascii()) {
+    return StringKernels::Compare(chars,
+                                  segment->ToAsciiVector().start() + position,
+                                  length);
+  } else {
+    return StringKernels::Compare(chars,
+                                  segment->ToUC16Vector().start() + position,
+                                  length);
+  }
+}
+
+
+int ConsStringIterator::Compare(String* a, String* b, int length) {
+  ASSERT(length <= a->length() && length <= b->length());
+  ConsStringIterator iterator_a(a);
+  ConsStringIterator iterator_b(b);
+  int position_a = 0;
+  int position_b = 0;
+  while (length > 0) {
+    if (position_a == iterator_a.length()) {
+      iterator_a.Next();
+      position_a = 0;
+    }
+    if (position_b == iterator_b.length()) {
+      iterator_b.Next();
+      position_b = 0;
+    }
+    int chars = Min(length, Min(iterator_a.length() - position_a,
+                                iterator_b.length() - position_b));
+    int result = iterator_a.is_ascii()
+        ? CompareCharsWithSegment(
+              iterator_a.ToAsciiVector().start() + position_a,
+              &iterator_b, position_b, chars)
+        : CompareCharsWithSegment(
+              iterator_a.ToUC16Vector().start() + position_a,
+              &iterator_b, position_b, chars);
+    if (result != 0) return result;
+    position_a += chars;
+    position_b += chars;
+    length -= chars;
+  }
+  return 0;
+}
+
+
 // This method determines the type of string involved and then copies
 // a whole chunk of characters into a buffer.  It can be used with strings
 // that have been glued together to form a ConsString and which must cooperate
@@ -4359,70 +4490,15 @@ static inline bool CompareStringContents(IteratorA* ia, IteratorB* ib) {
 }
 
 
-// Compares the contents of two strings by reading and comparing
-// int-sized blocks of characters.
+// Compares the contents of two strings with the string kernels.
 template <typename Char>
 static inline bool CompareRawStringContents(Vector<Char> a, Vector<Char> b) {
   int length = a.length();
   ASSERT_EQ(length, b.length());
-  const Char* pa = a.start();
-  const Char* pb = b.start();
-  int i = 0;
-#ifndef V8_HOST_CAN_READ_UNALIGNED
-  // If this architecture isn't comfortable reading unaligned ints
-  // then we have to check that the strings are aligned before
-  // comparing them blockwise.
-  const int kAlignmentMask = sizeof(uint32_t) - 1;  // NOLINT
-  uint32_t pa_addr = reinterpret_cast<uint32_t>(pa);
-  uint32_t pb_addr = reinterpret_cast<uint32_t>(pb);
-  if (((pa_addr & kAlignmentMask) | (pb_addr & kAlignmentMask)) == 0) {
-#endif
-    const int kStepSize = sizeof(int) / sizeof(Char);  // NOLINT
-    int endpoint = length - kStepSize;
-    // Compare blocks until we reach near the end of the string.
-    for (; i <= endpoint; i += kStepSize) {
-      uint32_t wa = *reinterpret_cast<const uint32_t*>(pa + i);
-      uint32_t wb = *reinterpret_cast<const uint32_t*>(pb + i);
-      if (wa != wb) {
-        return false;
-      }
-    }
-#ifndef V8_HOST_CAN_READ_UNALIGNED
-  }
-#endif
-  // Compare the remaining characters that didn't fit into a block.
-  for (; i < length; i++) {
-    if (a[i] != b[i]) {
-      return false;
-    }
-  }
-  return true;
+  return StringKernels::Mismatch(a.start(), b.start(), length) == length;
 }
 
 
-static StringInputBuffer string_compare_buffer_b;
-
-
-template <typename IteratorA>
-static inline bool CompareStringContentsPartial(IteratorA* ia, String* b) {
-  if (b->IsFlat()) {
-    if (b->IsAsciiRepresentation()) {
-      VectorIterator<char> ib(b->ToAsciiVector());
-      return CompareStringContents(ia, &ib);
-    } else {
-      VectorIterator<uc16> ib(b->ToUC16Vector());
-      return CompareStringContents(ia, &ib);
-    }
-  } else {
-    string_compare_buffer_b.Reset(0, b);
-    return CompareStringContents(ia, &string_compare_buffer_b);
-  }
-}
-
-
-static StringInputBuffer string_compare_buffer_a;
-
-
 bool String::SlowEquals(String* other) {
   // Fast check: negative check with lengths.
   int len = length();
@@ -4443,43 +4519,31 @@ bool String::SlowEquals(String* other) {
                                     Vector<const char>(str2, len));
   }
 
-  if (this->IsFlat()) {
-    if (IsAsciiRepresentation()) {
-      Vector<const char> vec1 = this->ToAsciiVector();
-      if (other->IsFlat()) {
-        if (other->IsAsciiRepresentation()) {
-          Vector<const char> vec2 = other->ToAsciiVector();
-          return CompareRawStringContents(vec1, vec2);
-        } else {
-          VectorIterator<char> buf1(vec1);
-          VectorIterator<uc16> ib(other->ToUC16Vector());
-          return CompareStringContents(&buf1, &ib);
-        }
-      } else {
-        VectorIterator<char> buf1(vec1);
-        string_compare_buffer_b.Reset(0, other);
-        return CompareStringContents(&buf1, &string_compare_buffer_b);
-      }
+  if (!this->IsFlat() || !other->IsFlat()) {
+    // Compare the segments of cons strings without flattening them.
+    return ConsStringIterator::Compare(this, other, len) == 0;
+  }
+
+  if (IsAsciiRepresentation()) {
+    Vector<const char> vec1 = this->ToAsciiVector();
+    if (other->IsAsciiRepresentation()) {
+      Vector<const char> vec2 = other->ToAsciiVector();
+      return CompareRawStringContents(vec1, vec2);
     } else {
-      Vector<const uc16> vec1 = this->ToUC16Vector();
-      if (other->IsFlat()) {
-        if (other->IsAsciiRepresentation()) {
-          VectorIterator<uc16> buf1(vec1);
-          VectorIterator<char> ib(other->ToAsciiVector());
-          return CompareStringContents(&buf1, &ib);
-        } else {
-          Vector<const uc16> vec2(other->ToUC16Vector());
-          return CompareRawStringContents(vec1, vec2);
-        }
-      } else {
-        VectorIterator<uc16> buf1(vec1);
-        string_compare_buffer_b.Reset(0, other);
-        return CompareStringContents(&buf1, &string_compare_buffer_b);
-      }
+      VectorIterator<char> buf1(vec1);
+      VectorIterator<uc16> ib(other->ToUC16Vector());
+      return CompareStringContents(&buf1, &ib);
     }
   } else {
-    string_compare_buffer_a.Reset(0, this);
-    return CompareStringContentsPartial(&string_compare_buffer_a, other);
+    Vector<const uc16> vec1 = this->ToUC16Vector();
+    if (other->IsAsciiRepresentation()) {
+      VectorIterator<uc16> buf1(vec1);
+      VectorIterator<char> ib(other->ToAsciiVector());
+      return CompareStringContents(&buf1, &ib);
+    } else {
+      Vector<const uc16> vec2(other->ToUC16Vector());
+      return CompareRawStringContents(vec1, vec2);
+    }
   }
 }
 
@@ -4502,6 +4566,13 @@ bool String::MarkAsUndetectable() {
 
 bool String::IsEqualTo(Vector<const char> str) {
   int slen = length();
+  // An ASCII string is equal to a UTF-8 string only if they have the same
+  // bytes, so no decoding is needed.
+  if (IsAsciiRepresentation() && IsFlat()) {
+    if (slen != str.length()) return false;
+    Vector<const char> chars = ToAsciiVector();
+    return StringKernels::Mismatch(chars.start(), str.start(), slen) == slen;
+  }
   Access<Scanner::Utf8Decoder> decoder(Scanner::utf8_decoder());
   decoder->Reset(str.start(), str.length());
   int i;
@@ -4513,13 +4584,60 @@ bool String::IsEqualTo(Vector<const char> str) {
 }
 
 
+template <typename Char>
+static inline void AddCharactersToHash(StringHasher* hasher,
+                                       Vector<const Char> chars) {
+  int i = 0;
+  int length = chars.length();
+  // Do the iterative array index computation as long as there is a
+  // chance this is an array index.
+  for (; i < length && hasher->is_array_index(); i++) {
+    hasher->AddCharacter(chars[i]);
+  }
+  hasher->AddCharactersNoIndex(chars.start() + i, length - i);
+}
+
+
+// Computes the hash field of a flat sequence of characters.
+template <typename Char>
+static uint32_t ComputeFlatHashField(Vector<const Char> chars) {
+  StringHasher hasher(chars.length());
+  if (!hasher.has_trivial_hash()) AddCharactersToHash(&hasher, chars);
+  return hasher.GetHashField();
+}
+
+
+// Computes the hash field of a cons string from its segments, without the
+// block copying of a StringInputBuffer.
+static uint32_t ComputeConsHashField(String* string) {
+  StringHasher hasher(string->length());
+  if (!hasher.has_trivial_hash()) {
+    ConsStringIterator iterator(string);
+    while (iterator.Next()) {
+      if (iterator.is_ascii()) {
+        AddCharactersToHash(&hasher, iterator.ToAsciiVector());
+      } else {
+        AddCharactersToHash(&hasher, iterator.ToUC16Vector());
+      }
+    }
+  }
+  return hasher.GetHashField();
+}
+
+
 uint32_t String::ComputeAndSetHash() {
   // Should only be called if hash code has not yet been computed.
   ASSERT(!(hash_field() & kHashComputedMask));
 
   // Compute the hash code.
-  StringInputBuffer buffer(this);
-  uint32_t field = ComputeHashField(&buffer, length());
+  uint32_t field;
+  if (StringShape(this).IsCons()) {
+    field = ComputeConsHashField(this);
+  } else if (IsAsciiRepresentation()) {
+    field = ComputeFlatHashField(ToAsciiVector());
+  } else {
+    field = ComputeFlatHashField(ToUC16Vector());
+  }
 
   // Store the hash code in the object.
   set_hash_field(field);
@@ -6817,10 +6935,17 @@ class Utf8SymbolKey : public HashTableKey {
 
   uint32_t Hash() {
     if (hash_field_ != 0) return hash_field_ >> String::kHashShift;
-    unibrow::Utf8InputBuffer<> buffer(string_.start(),
-                                      static_cast<unsigned>(string_.length()));
-    chars_ = buffer.Length();
-    hash_field_ = String::ComputeHashField(&buffer, chars_);
+    if (StringKernels::IsAscii(string_.start(), string_.length())) {
+      // ASCII is its own UTF-8 encoding, so the characters can be hashed
+      // without decoding them.
+      chars_ = string_.length();
+      hash_field_ = ComputeFlatHashField(string_);
+    } else {
+      unibrow::Utf8InputBuffer<> buffer(
+          string_.start(), static_cast<unsigned>(string_.length()));
+      chars_ = buffer.Length();
+      hash_field_ = String::ComputeHashField(&buffer, chars_);
+    }
     uint32_t result = hash_field_ >> String::kHashShift;
     ASSERT(result != 0);  // Ensure that the hash value of 0 is never computed.
     return result;
@@ -964,6 +964,12 @@ class HeapObject: public Object {
   inline MapWord map_word();
   inline void set_map_word(MapWord map_word);
 
+  // Replaces the map word with a forwarding address if it is still the
+  // given map word, safely with respect to other threads doing the same.
+  // Returns false if the map word has changed.
+  inline bool SetForwardingAddressAtomically(MapWord map_word,
+                                             HeapObject* target);
+
   // Converts an address to a HeapObject pointer.
   static inline HeapObject* FromAddress(Address address);
 
@@ -998,6 +1004,10 @@ class HeapObject: public Object {
   // Mutate this object's map pointer to indicate that the object is live.
   inline void SetMark();
 
+  // Like SetMark, but safe when other threads mark objects concurrently.
+  // Returns false if the object was already marked.
+  inline bool SetMarkAtomically();
+
   // Mutate this object's map pointer to remove the indication that the
   // object is live (ie, partially restore the map pointer).
   inline void ClearMark();
@@ -2907,6 +2917,20 @@ class Map: public HeapObject {
     return ((1 << kIsExtensible) & bit_field2()) != 0;
   }
 
+  inline void set_is_pretenured(bool value) {
+    if (value) {
+      set_bit_field2(bit_field2() | (1 << kIsPretenured));
+    } else {
+      set_bit_field2(bit_field2() & ~(1 << kIsPretenured));
+    }
+  }
+
+  // Are the objects of this map allocated by literals and constructors
+  // created in old space, because most of them survive scavenges?
+  inline bool is_pretenured() {
+    return ((1 << kIsPretenured) & bit_field2()) != 0;
+  }
+
   // Tells whether the instance needs security checks when accessing its
   // properties.
   inline void set_is_access_check_needed(bool access_check_needed);
@@ -3025,6 +3049,7 @@ class Map: public HeapObject {
   // Bit positions for bit field 2
   static const int kNeedsLoading = 0;
   static const int kIsExtensible = 1;
+  static const int kIsPretenured = 2;
 
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(Map);
@@ -3731,6 +3756,12 @@ class StringHasher {
   // that the input is not an array index.
   inline void AddCharacterNoIndex(uc32 c);
 
+  // Adds a sequence of characters to the hash without updating the array
+  // index calculation, like AddCharacterNoIndex.  The running hash is kept
+  // in a register and ASCII characters are read a word at a time.
+  template <typename Char>
+  inline void AddCharactersNoIndex(const Char* chars, int length);
+
   // Returns the value to store in the hash field of a string with
   // the given length and contents.
   uint32_t GetHashField();
@@ -3752,6 +3783,9 @@ class StringHasher {
 
   inline uint32_t GetHash();
 
+  // One step of the Jenkins one-at-a-time hash function.
+  static inline uint32_t AddCharacterCore(uint32_t running_hash, uint32_t c);
+
   int length_;
   uint32_t raw_running_hash_;
   uint32_t array_index_;
@@ -4374,6 +4408,60 @@ class SafeStringInputBuffer
 };
 
 
+// Iterates over the contents of a string as a sequence of flat segments,
+// from left to right.  The leaves of a ConsString tree are visited using an
+// explicit stack rather than by flattening the string, so reading a cons
+// string built by repeated concatenation does not copy it.  The segments
+// point into the heap, so the iterator is not valid across a GC.
+class ConsStringIterator BASE_EMBEDDED {
+ public:
+  // Starts the iteration at the given character offset.
+  explicit ConsStringIterator(String* string, int offset = 0);
+  ~ConsStringIterator();
+
+  // Moves to the next non-empty segment.  Returns false when there are no
+  // more characters.
+  bool Next();
+
+  // The current segment.
+  bool is_ascii() { return is_ascii_; }
+  int length() { return length_; }
+  // The position of the segment in the string.
+  int offset() { return offset_; }
+  inline Vector<const char> ToAsciiVector();
+  inline Vector<const uc16> ToUC16Vector();
+
+  // Compares the first length characters of two strings segment by
+  // segment.  Returns the difference between the first pair of characters
+  // that differ, or zero if they are all equal.
+  static int Compare(String* a, String* b, int length);
+
+ private:
+  void Push(String* string);
+  void SetSegment(String* leaf, int from);
+
+  // The stack holds the right hand sides of the cons strings that have
+  // been entered on the left.  It only grows beyond the inline space for
+  // deep trees.
+  static const int kInlineStackSize = 32;
+  String* inline_stack_[kInlineStackSize];
+  String** stack_;
+  int depth_;
+  int capacity_;
+
+  // The leaf and position the iteration starts at.
+  String* first_leaf_;
+  int first_leaf_offset_;
+
+  const void* start_;
+  bool is_ascii_;
+  int length_;
+  int offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConsStringIterator);
+};
+
+
 template <typename T>
 class VectorIterator {
  public:
@@ -4171,6 +4171,435 @@ Expression* Parser::ParseJsonArray(bool* ok) {
 }
 
 
+// ----------------------------------------------------------------------------
+// JSON values
+
+JsonParser::JsonParser(Handle<String> source)
+    : length_(source->length()),
+      position_(0),
+      literal_is_ascii_(true),
+      number_(0),
+      stack_overflow_(false) {
+  source_ = NewArray<uc16>(length_);
+  String::WriteToFlat(*source, source_, 0, length_);
+  Advance();
+}
+
+
+JsonParser::~JsonParser() {
+  DeleteArray(source_);
+}
+
+
+Handle<Object> JsonParser::ParseJson() {
+  Handle<Object> result = ParseJsonValue(Next());
+  if (!result.is_null()) {
+    Token::Value token = Next();
+    if (token != Token::EOS) {
+      ReportUnexpectedToken(token);
+      result = Handle<Object>::null();
+    }
+  }
+  if (result.is_null() && stack_overflow_) {
+    // The exception has not been thrown yet, see ReportUnexpectedToken.
+    Top::StackOverflow();
+  }
+  return result;
+}
+
+
+// Parse any JSON value.
+Handle<Object> JsonParser::ParseJsonValue(Token::Value token) {
+  switch (token) {
+    case Token::STRING:
+      return GetString();
+    case Token::NUMBER:
+      return Factory::NewNumber(number_);
+    case Token::FALSE_LITERAL:
+      return Factory::false_value();
+    case Token::TRUE_LITERAL:
+      return Factory::true_value();
+    case Token::NULL_LITERAL:
+      return Factory::null_value();
+    case Token::LBRACE:
+      return ParseJsonObject();
+    case Token::LBRACK:
+      return ParseJsonArray();
+    default:
+      ReportUnexpectedToken(token);
+      return Handle<Object>::null();
+  }
+}
+
+
+// Parse a JSON object. Scanner must be right after '{' token.
+Handle<Object> JsonParser::ParseJsonObject() {
+  int start = values_.length();
+  Token::Value token = Next();
+  if (token != Token::RBRACE) {
+    while (true) {
+      if (token != Token::STRING) break;
+      values_.Add(GetSymbol());
+      token = Next();
+      if (token != Token::COLON) break;
+      Handle<Object> value = ParseJsonValue(Next());
+      if (value.is_null()) {
+        values_.Rewind(start);
+        return value;
+      }
+      values_.Add(value);
+      token = Next();
+      if (token != Token::COMMA) break;
+      token = Next();
+    }
+    if (token != Token::RBRACE) {
+      ReportUnexpectedToken(token);
+      values_.Rewind(start);
+      return Handle<Object>::null();
+    }
+  }
+
+  int property_count = (values_.length() - start) / 2;
+  bool is_result_from_cache;
+  Handle<Map> map =
+      ComputeObjectMap(start, property_count, &is_result_from_cache);
+  Handle<JSObject> object = Factory::NewJSObjectFromMap(map);
+  {  // Add the properties in the order they were parsed.
+    OptimizedObjectForAddingMultipleProperties opt(object,
+                                                   property_count,
+                                                   !is_result_from_cache);
+    for (int i = start; i < values_.length(); i += 2) {
+      Handle<String> key = Handle<String>::cast(values_[i]);
+      Handle<Object> value = values_[i + 1];
+      uint32_t index;
+      Handle<Object> result;
+      if (key->AsArrayIndex(&index)) {
+        result = SetElement(object, index, value);
+      } else {
+        // JSON.parse defines own properties, so setters and read-only
+        // properties on the prototype chain are ignored.
+        result = IgnoreAttributesAndSetLocalProperty(object, key, value, NONE);
+      }
+      if (result.is_null()) {
+        values_.Rewind(start);
+        return result;
+      }
+    }
+  }
+  values_.Rewind(start);
+  return object;
+}
+
+
+// Parse a JSON array. Scanner must be right after '[' token.
+Handle<Object> JsonParser::ParseJsonArray() {
+  int start = values_.length();
+  Token::Value token = Next();
+  if (token != Token::RBRACK) {
+    while (true) {
+      Handle<Object> value = ParseJsonValue(token);
+      if (value.is_null()) {
+        values_.Rewind(start);
+        return value;
+      }
+      values_.Add(value);
+      token = Next();
+      if (token != Token::COMMA) break;
+      token = Next();
+    }
+    if (token != Token::RBRACK) {
+      ReportUnexpectedToken(token);
+      values_.Rewind(start);
+      return Handle<Object>::null();
+    }
+  }
+
+  int length = values_.length() - start;
+  Handle<FixedArray> elements = Factory::NewFixedArray(length);
+  for (int i = 0; i < length; i++) {
+    elements->set(i, *values_[start + i]);
+  }
+  values_.Rewind(start);
+  return Factory::NewJSArrayWithElements(elements);
+}
+
+
+Token::Value JsonParser::Next() {
+  // Check for stack-overflow before returning any tokens, objects and
+  // arrays are parsed recursively.
+  StackLimitCheck check;
+  if (check.HasOverflowed()) {
+    stack_overflow_ = true;
+    return Token::ILLEGAL;
+  }
+  // The only whitespace characters allowed are tab, carriage-return,
+  // newline and space.
+  while (c0_ == '\t' || c0_ == '\r' || c0_ == '\n' || c0_ == ' ') {
+    Advance();
+  }
+  Token::Value token;
+  switch (c0_) {
+    case '"':
+      return ScanJsonString();
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+      return ScanJsonNumber();
+    case 't':
+      return ScanJsonIdentifier("true", Token::TRUE_LITERAL);
+    case 'f':
+      return ScanJsonIdentifier("false", Token::FALSE_LITERAL);
+    case 'n':
+      return ScanJsonIdentifier("null", Token::NULL_LITERAL);
+    case '{':
+      token = Token::LBRACE;
+      break;
+    case '}':
+      token = Token::RBRACE;
+      break;
+    case '[':
+      token = Token::LBRACK;
+      break;
+    case ']':
+      token = Token::RBRACK;
+      break;
+    case ':':
+      token = Token::COLON;
+      break;
+    case ',':
+      token = Token::COMMA;
+      break;
+    default:
+      if (c0_ < 0) return Token::EOS;
+      token = Token::ILLEGAL;
+      break;
+  }
+  Advance();
+  return token;
+}
+
+
+Token::Value JsonParser::ScanJsonString() {
+  ASSERT_EQ('"', c0_);
+  Advance();
+  literal_buffer_.Reset();
+  literal_is_ascii_ = true;
+  while (c0_ != '"') {
+    // Control characters and the end of the input are not allowed in
+    // strings.
+    if (c0_ < 0x20) return Token::ILLEGAL;
+    uc32 c = c0_;
+    if (c == '\\') {
+      Advance();
+      switch (c0_) {
+        case '"':
+        case '\\':
+        case '/':
+          c = c0_;
+          break;
+        case 'b':
+          c = '\x08';
+          break;
+        case 'f':
+          c = '\x0c';
+          break;
+        case 'n':
+          c = '\x0a';
+          break;
+        case 'r':
+          c = '\x0d';
+          break;
+        case 't':
+          c = '\x09';
+          break;
+        case 'u':
+          c = ScanHexEscape();
+          if (c < 0) return Token::ILLEGAL;
+          break;
+        default:
+          return Token::ILLEGAL;
+      }
+    }
+    if (c > unibrow::Utf8::kMaxOneByteChar) literal_is_ascii_ = false;
+    literal_buffer_.AddChar(c);
+    Advance();
+  }
+  Advance();
+  return Token::STRING;
+}
+
+
+// Scan the four hex digits after "\u".  The last digit is left in c0_.
+uc32 JsonParser::ScanHexEscape() {
+  uc32 value = 0;
+  for (int i = 0; i < 4; i++) {
+    Advance();
+    int digit = HexValue(c0_);
+    if (digit < 0) return -1;
+    value = value * 16 + digit;
+  }
+  return value;
+}
+
+
+Token::Value JsonParser::ScanJsonNumber() {
+  // A JSON number has an optional minus sign, no leading zeros (unless
+  // the integer part is zero), at least one digit after a decimal point
+  // and an optional exponent part.  Hexadecimal and octal numbers are not
+  // allowed.
+  int start = CurrentPosition();
+  bool negative = (c0_ == '-');
+  if (negative) Advance();
+  if (c0_ == '0') {
+    Advance();
+  } else if (IsDecimalDigit(c0_)) {
+    ScanDecimalDigits();
+  } else {
+    return Token::ILLEGAL;
+  }
+  // Small integers are by far the most common numbers, so they are
+  // converted here.  Negative zero is not a small integer.
+  if (c0_ != '.' && c0_ != 'e' && c0_ != 'E') {
+    int digits_start = negative ? start + 1 : start;
+    int end = CurrentPosition();
+    if (end - digits_start <= kMaxSmallIntegerDigits &&
+        !(negative && source_[digits_start] == '0')) {
+      int value = 0;
+      for (int i = digits_start; i < end; i++) {
+        value = value * 10 + (source_[i] - '0');
+      }
+      number_ = negative ? -value : value;
+      return Token::NUMBER;
+    }
+  }
+  if (c0_ == '.') {
+    Advance();
+    if (!IsDecimalDigit(c0_)) return Token::ILLEGAL;
+    ScanDecimalDigits();
+  }
+  if (c0_ == 'e' || c0_ == 'E') {
+    Advance();
+    if (c0_ == '-' || c0_ == '+') Advance();
+    if (!IsDecimalDigit(c0_)) return Token::ILLEGAL;
+    ScanDecimalDigits();
+  }
+  // The number consists of ASCII characters only.
+  int end = CurrentPosition();
+  literal_buffer_.Reset();
+  for (int i = start; i < end; i++) literal_buffer_.AddChar(source_[i]);
+  literal_buffer_.AddChar('\0');
+  number_ = StringToDouble(literal_buffer_.data(),
+                           NO_FLAGS,  // Hex, octal or trailing junk.
+                           OS::nan_value());
+  return Token::NUMBER;
+}
+
+
+void JsonParser::ScanDecimalDigits() {
+  while (IsDecimalDigit(c0_)) Advance();
+}
+
+
+Token::Value JsonParser::ScanJsonIdentifier(const char* text,
+                                            Token::Value token) {
+  while (*text != '\0') {
+    if (c0_ != *text) return Token::ILLEGAL;
+    Advance();
+    text++;
+  }
+  if (Scanner::kIsIdentifierPart.get(c0_)) return Token::ILLEGAL;
+  return token;
+}
+
+
+Handle<String> JsonParser::GetString() {
+  int literal_length = literal_buffer_.pos();
+  if (literal_length == 0) {
+    return Factory::empty_string();
+  }
+  Vector<const char> literal(literal_buffer_.data(), literal_length);
+  if (literal_is_ascii_) return Factory::NewStringFromAscii(literal);
+  return Factory::NewStringFromUtf8(literal);
+}
+
+
+Handle<String> JsonParser::GetSymbol() {
+  return Factory::LookupSymbol(Vector<const char>(literal_buffer_.data(),
+                                                  literal_buffer_.pos()));
+}
+
+
+// Objects with up to this many properties that all have symbol keys share
+// their maps.  JSON data tends to have more properties per object than
+// object literals, so the limit is higher than for object literals.
+static const int kMaxJsonMapCacheKeys = 32;
+
+
+Handle<Map> JsonParser::ComputeObjectMap(int start,
+                                         int property_count,
+                                         bool* is_result_from_cache) {
+  Handle<Context> context = Top::global_context();
+  bool use_cache = FLAG_canonicalize_object_literal_maps &&
+      property_count <= kMaxJsonMapCacheKeys;
+  for (int i = 0; use_cache && i < property_count; i++) {
+    uint32_t index;
+    Handle<String> key = Handle<String>::cast(values_[start + i * 2]);
+    use_cache = !key->AsArrayIndex(&index);
+  }
+  *is_result_from_cache = use_cache;
+  if (use_cache) {
+    Handle<FixedArray> keys = Factory::NewFixedArray(property_count);
+    for (int i = 0; i < property_count; i++) {
+      keys->set(i, *values_[start + i * 2]);
+    }
+    return Factory::ObjectLiteralMapFromCache(context, keys);
+  }
+  return Factory::CopyMap(
+      Handle<Map>(context->object_function()->initial_map()),
+      property_count);
+}
+
+
+void JsonParser::ReportUnexpectedToken(Token::Value token) {
+  // As in the parser, stack overflows are reported when parsing is over.
+  if (token == Token::ILLEGAL && stack_overflow_) return;
+  const char* message;
+  Vector<const char*> args = Vector<const char*>::empty();
+  const char* name = NULL;
+  switch (token) {
+    case Token::EOS:
+      message = "unexpected_eos";
+      break;
+    case Token::NUMBER:
+      message = "unexpected_token_number";
+      break;
+    case Token::STRING:
+      message = "unexpected_token_string";
+      break;
+    default:
+      message = "unexpected_token";
+      name = Token::String(token);
+      ASSERT(name != NULL);
+      args = Vector<const char*>(&name, 1);
+      break;
+  }
+  Handle<JSArray> array = Factory::NewJSArray(args.length());
+  for (int i = 0; i < args.length(); i++) {
+    SetElement(array, i, Factory::NewStringFromUtf8(CStrVector(args[i])));
+  }
+  Handle<Object> result = Factory::NewSyntaxError(message, array);
+  Top::Throw(*result);
+}
+
+
 // ----------------------------------------------------------------------------
 // Regular expressions
 
@@ -191,6 +191,79 @@ class CompileTimeValue: public AllStatic {
 };
 
 
+// JSON is parsed directly into heap objects, without building an AST and
+// compiling it.  Objects with the same keys in the same order share a map
+// through the object literal map cache of the global context, and the keys
+// are symbols.
+class JsonParser BASE_EMBEDDED {
+ public:
+  // Parse the source as a single JSON value.  Returns a null handle and
+  // throws a SyntaxError if the source is not valid JSON.
+  static Handle<Object> Parse(Handle<String> source) {
+    return JsonParser(source).ParseJson();
+  }
+
+ private:
+  explicit JsonParser(Handle<String> source);
+  ~JsonParser();
+
+  Handle<Object> ParseJson();
+  // Each parse function returns a null handle on error.  A value starts
+  // with the given token, objects and arrays start after the '{' or '['.
+  Handle<Object> ParseJsonValue(Token::Value token);
+  Handle<Object> ParseJsonObject();
+  Handle<Object> ParseJsonArray();
+
+  // Scan the next token.  The JSON lexical grammar is specified in the
+  // ECMAScript 5 standard, section 15.12.1.1.
+  Token::Value Next();
+  Token::Value ScanJsonString();
+  Token::Value ScanJsonNumber();
+  Token::Value ScanJsonIdentifier(const char* text, Token::Value token);
+  void ScanDecimalDigits();
+  uc32 ScanHexEscape();
+
+  // One character look-ahead; c0_ < 0 at the end of the input.
+  void Advance() {
+    c0_ = (position_ < length_) ? source_[position_++] : -1;
+  }
+  // The position of c0_ in the source.
+  int CurrentPosition() { return (c0_ < 0) ? length_ : position_ - 1; }
+
+  // Integers with up to this many digits are Smis.
+  static const int kMaxSmallIntegerDigits = 9;
+
+  // The value of the last STRING token.
+  Handle<String> GetString();
+  Handle<String> GetSymbol();
+
+  Handle<Map> ComputeObjectMap(int start,
+                               int property_count,
+                               bool* is_result_from_cache);
+  void ReportUnexpectedToken(Token::Value token);
+
+  // A copy of the source, since the source string may be moved by a
+  // garbage collection while its values are allocated.
+  uc16* source_;
+  int length_;
+  int position_;
+  uc32 c0_;
+
+  // The characters of the last STRING or NUMBER token in UTF-8, and whether
+  // they are all ASCII.
+  UTF8Buffer literal_buffer_;
+  bool literal_is_ascii_;
+  // The value of the last NUMBER token.
+  double number_;
+  bool stack_overflow_;
+
+  // The values of the objects and arrays being parsed.  An object is
+  // built when all of its properties have been parsed, so it can get the
+  // map for its keys.  Until then its keys and values alternate here.
+  List<Handle<Object> > values_;
+};
+
+
 } }  // namespace v8::internal
 
 #endif  // V8_PARSER_H_
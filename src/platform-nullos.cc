@@ -138,6 +138,12 @@ void OS::VPrintError(const char* format, va_list args) {
 }
 
 
+bool OS::WriteToFileDescriptor(int fd, const char* data, int length) {
+  UNIMPLEMENTED();
+  return false;
+}
+
+
 int OS::SNPrintF(char* str, size_t size, const char* format, ...) {
   UNIMPLEMENTED();
   return 0;
@@ -192,6 +198,20 @@ void OS::Free(void* buf, const size_t length) {
 }
 
 
+void OS::ReleasePages(void* address, const size_t size) {
+  UNIMPLEMENTED();
+}
+
+
+size_t OS::HugePageSize() {
+  return 0;
+}
+
+
+void OS::AdviseHugePages(void* address, const size_t size) {
+}
+
+
 #ifdef ENABLE_HEAP_PROTECTION
 
 void OS::Protect(void* address, size_t size) {
@@ -211,6 +231,25 @@ void OS::Sleep(int milliseconds) {
 }
 
 
+// There are no threads, so plain loads and stores are atomic.
+intptr_t OS::CompareAndSwap(volatile intptr_t* ptr,
+                            intptr_t old_value,
+                            intptr_t new_value) {
+  intptr_t result = *ptr;
+  if (result == old_value) *ptr = new_value;
+  return result;
+}
+
+
+int32_t OS::CompareAndSwap32(volatile int32_t* ptr,
+                             int32_t old_value,
+                             int32_t new_value) {
+  int32_t result = *ptr;
+  if (result == old_value) *ptr = new_value;
+  return result;
+}
+
+
 void OS::Abort() {
   // Minimalistic implementation for bootstrapping.
   abort();
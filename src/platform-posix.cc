@@ -33,6 +33,7 @@
 #include <errno.h>
 #include <time.h>
 
+#include <sys/mman.h>  // madvise
 #include <sys/socket.h>
 #include <sys/resource.h>
 #include <sys/time.h>
@@ -47,6 +48,8 @@
 #include <utils/Log.h>  // LOG_PRI_VA
 #endif
 
+#undef MAP_TYPE
+
 #include "v8.h"
 
 #include "platform.h"
@@ -68,6 +71,35 @@ double OS::nan_value() {
 }
 
 
+// ----------------------------------------------------------------------------
+// POSIX memory support.
+//
+
+void OS::ReleasePages(void* address, const size_t size) {
+  // TODO(1240712): madvise has a return value which is ignored here.
+  madvise(reinterpret_cast<char*>(address), size, MADV_DONTNEED);
+}
+
+
+size_t OS::HugePageSize() {
+#ifdef MADV_HUGEPAGE
+  // Transparent huge pages are only available on Linux, where they are 2MB
+  // on x86-64.
+  return 2 * MB;
+#else
+  return 0;
+#endif
+}
+
+
+void OS::AdviseHugePages(void* address, const size_t size) {
+#ifdef MADV_HUGEPAGE
+  // TODO(1240712): madvise has a return value which is ignored here.
+  madvise(reinterpret_cast<char*>(address), size, MADV_HUGEPAGE);
+#endif
+}
+
+
 // ----------------------------------------------------------------------------
 // POSIX date/time support.
 //
@@ -117,6 +149,20 @@ FILE* OS::FOpen(const char* path, const char* mode) {
 }
 
 
+bool OS::WriteToFileDescriptor(int fd, const char* data, int length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += written;
+    length -= static_cast<int>(written);
+  }
+  return true;
+}
+
+
 const char* OS::LogFileOpenMode = "w";
 
 
@@ -190,6 +236,24 @@ void OS::StrNCpy(Vector<char> dest, const char* src, size_t n) {
 }
 
 
+// ----------------------------------------------------------------------------
+// POSIX atomic operations.
+//
+
+intptr_t OS::CompareAndSwap(volatile intptr_t* ptr,
+                            intptr_t old_value,
+                            intptr_t new_value) {
+  return __sync_val_compare_and_swap(ptr, old_value, new_value);
+}
+
+
+int32_t OS::CompareAndSwap32(volatile int32_t* ptr,
+                             int32_t old_value,
+                             int32_t new_value) {
+  return __sync_val_compare_and_swap(ptr, old_value, new_value);
+}
+
+
 // ----------------------------------------------------------------------------
 // POSIX socket support.
 //
@@ -75,6 +75,7 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <process.h>  // for _beginthreadex()
+#include <io.h>  // for _write()
 #include <stdlib.h>
 
 #undef VOID
@@ -715,6 +716,17 @@ FILE* OS::FOpen(const char* path, const char* mode) {
 }
 
 
+bool OS::WriteToFileDescriptor(int fd, const char* data, int length) {
+  while (length > 0) {
+    int written = _write(fd, data, length);
+    if (written < 0) return false;
+    data += written;
+    length -= written;
+  }
+  return true;
+}
+
+
 // Open log file in binary mode to avoid /n -> /r/n conversion.
 const char* OS::LogFileOpenMode = "wb";
 
@@ -864,6 +876,22 @@ void OS::Free(void* address, const size_t size) {
 }
 
 
+void OS::ReleasePages(void* address, const size_t size) {
+  // TODO(1240712): VirtualAlloc has a return value which is ignored here.
+  VirtualAlloc(address, size, MEM_RESET, PAGE_READWRITE);
+}
+
+
+size_t OS::HugePageSize() {
+  // Large pages on Windows need privileges and cannot be paged out.
+  return 0;
+}
+
+
+void OS::AdviseHugePages(void* address, const size_t size) {
+}
+
+
 #ifdef ENABLE_HEAP_PROTECTION
 
 void OS::Protect(void* address, size_t size) {
@@ -888,6 +916,25 @@ void OS::Sleep(int milliseconds) {
 }
 
 
+intptr_t OS::CompareAndSwap(volatile intptr_t* ptr,
+                            intptr_t old_value,
+                            intptr_t new_value) {
+  return reinterpret_cast<intptr_t>(InterlockedCompareExchangePointer(
+      reinterpret_cast<PVOID volatile*>(ptr),
+      reinterpret_cast<PVOID>(new_value),
+      reinterpret_cast<PVOID>(old_value)));
+}
+
+
+int32_t OS::CompareAndSwap32(volatile int32_t* ptr,
+                             int32_t old_value,
+                             int32_t new_value) {
+  return InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(ptr),
+                                    new_value,
+                                    old_value);
+}
+
+
 void OS::Abort() {
   if (!IsDebuggerPresent()) {
 #ifdef _MSC_VER
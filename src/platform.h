@@ -161,6 +161,10 @@ class OS {
 
   static FILE* FOpen(const char* path, const char* mode);
 
+  // Writes the data to an open file descriptor.  Returns false if writing
+  // failed.
+  static bool WriteToFileDescriptor(int fd, const char* data, int length);
+
   // Log file open mode is platform-dependent due to line ends issues.
   static const char* LogFileOpenMode;
 
@@ -185,6 +189,15 @@ class OS {
   static void Free(void* address, const size_t size);
   // Get the Alignment guaranteed by Allocate().
   static size_t AllocateAlignment();
+  // Give the physical pages of memory returned by Allocate() back to the
+  // OS without unmapping it.  The contents of the memory are lost.
+  static void ReleasePages(void* address, const size_t size);
+  // Get the size of the huge pages that the OS can transparently back
+  // aligned memory with, or 0 if it cannot.
+  static size_t HugePageSize();
+  // Ask the OS to back the aligned huge pages in a block of memory returned
+  // by Allocate() or committed in a VirtualMemory with huge pages.
+  static void AdviseHugePages(void* address, const size_t size);
 
 #ifdef ENABLE_HEAP_PROTECTION
   // Protect/unprotect a block of memory by marking it read-only/writable.
@@ -205,6 +218,16 @@ class OS {
   // Abort the current process.
   static void Abort();
 
+  // Atomically replace *ptr with new_value if it equals old_value.
+  // Returns the value *ptr had before the operation, which equals
+  // old_value if the swap took place.  Acts as a full memory barrier.
+  static intptr_t CompareAndSwap(volatile intptr_t* ptr,
+                                 intptr_t old_value,
+                                 intptr_t new_value);
+  static int32_t CompareAndSwap32(volatile int32_t* ptr,
+                                  int32_t old_value,
+                                  int32_t new_value);
+
   // Debug break.
   static void DebugBreak();
 
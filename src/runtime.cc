@@ -43,6 +43,7 @@
 #include "runtime.h"
 #include "scopeinfo.h"
 #include "smart-pointer.h"
+#include "string-kernels.h"
 #include "stub-cache.h"
 #include "v8threads.h"
 
@@ -96,11 +97,19 @@ namespace internal {
 static StaticResource<StringInputBuffer> runtime_string_input_buffer;
 
 
+// Literals whose copies mostly survive scavenges are copied into old space,
+// see Heap::UpdatePretenuringDecisions.
+static PretenureFlag LiteralPretenureFlag(JSObject* boilerplate) {
+  return boilerplate->map()->is_pretenured() ? TENURED : NOT_TENURED;
+}
+
+
 static Object* DeepCopyBoilerplate(JSObject* boilerplate) {
   StackLimitCheck check;
   if (check.HasOverflowed()) return Top::StackOverflow();
 
-  Object* result = Heap::CopyJSObject(boilerplate);
+  Object* result =
+      Heap::CopyJSObject(boilerplate, LiteralPretenureFlag(boilerplate));
   if (result->IsFailure()) return result;
   JSObject* copy = JSObject::cast(result);
 
@@ -202,7 +211,7 @@ static Object* Runtime_CloneLiteralBoilerplate(Arguments args) {
 
 static Object* Runtime_CloneShallowLiteralBoilerplate(Arguments args) {
   CONVERT_CHECKED(JSObject, boilerplate, args[0]);
-  return Heap::CopyJSObject(boilerplate);
+  return Heap::CopyJSObject(boilerplate, LiteralPretenureFlag(boilerplate));
 }
 
 
@@ -429,7 +438,8 @@ static Object* Runtime_CreateObjectLiteralShallow(Arguments args) {
     // Update the functions literal and return the boilerplate.
     literals->set(literals_index, *boilerplate);
   }
-  return Heap::CopyJSObject(JSObject::cast(*boilerplate));
+  JSObject* object = JSObject::cast(*boilerplate);
+  return Heap::CopyJSObject(object, LiteralPretenureFlag(object));
 }
 
 
@@ -467,7 +477,8 @@ static Object* Runtime_CreateArrayLiteralShallow(Arguments args) {
     // Update the functions literal and return the boilerplate.
     literals->set(literals_index, *boilerplate);
   }
-  return Heap::CopyJSObject(JSObject::cast(*boilerplate));
+  JSObject* object = JSObject::cast(*boilerplate);
+  return Heap::CopyJSObject(object, LiteralPretenureFlag(object));
 }
 
 
@@ -1425,9 +1436,9 @@ static Object* Runtime_SetCode(Arguments args) {
       literals->set(JSFunction::kLiteralGlobalContextIndex,
                     context->global_context());
     }
-    // It's okay to skip the write barrier here because the literals
-    // are guaranteed to be in old space.
-    target->set_literals(*literals, SKIP_WRITE_BARRIER);
+    // The literals are in old space, but the write barrier is still needed
+    // to keep incremental marking informed.
+    target->set_literals(*literals);
   }
 
   target->set_context(*context);
@@ -2268,12 +2279,10 @@ template <typename schar>
 static int SingleCharIndexOf(Vector<const schar> string,
                              schar pattern_char,
                              int start_index) {
-  for (int i = start_index, n = string.length(); i < n; i++) {
-    if (pattern_char == string[i]) {
-      return i;
-    }
-  }
-  return -1;
+  int index = StringKernels::IndexOf(string.start() + start_index,
+                                     string.length() - start_index,
+                                     pattern_char);
+  return (index < 0) ? -1 : start_index + index;
 }
 
 
@@ -2306,8 +2315,11 @@ static int SimpleIndexOf(Vector<const schar> subject,
   // algorithm.
   int badness = -10 - (pattern.length() << 2);
   // We know our pattern is at least 2 characters, we cache the first so
-  // the common case of the first character not matching is faster.
-  pchar pattern_first_char = pattern[0];
+  // the common case of the first character not matching is faster.  The
+  // candidates are found with a scan for the first character, which does
+  // not count towards the badness.
+  ASSERT(sizeof(schar) > 1 || pattern[0] <= String::kMaxAsciiCharCode);
+  schar pattern_first_char = static_cast<schar>(pattern[0]);
 
   for (int i = idx, n = subject.length() - pattern.length(); i <= n; i++) {
     badness++;
@@ -2315,7 +2327,11 @@ static int SimpleIndexOf(Vector<const schar> subject,
       *complete = false;
       return i;
     }
-    if (subject[i] != pattern_first_char) continue;
+    int skip = StringKernels::IndexOf(subject.start() + i,
+                                      n - i + 1,
+                                      pattern_first_char);
+    if (skip < 0) break;
+    i += skip;
     int j = 1;
     do {
       if (pattern[j] != subject[i+j]) {
@@ -2338,9 +2354,14 @@ template <typename pchar, typename schar>
 static int SimpleIndexOf(Vector<const schar> subject,
                          Vector<const pchar> pattern,
                          int idx) {
-  pchar pattern_first_char = pattern[0];
+  ASSERT(sizeof(schar) > 1 || pattern[0] <= String::kMaxAsciiCharCode);
+  schar pattern_first_char = static_cast<schar>(pattern[0]);
   for (int i = idx, n = subject.length() - pattern.length(); i <= n; i++) {
-    if (subject[i] != pattern_first_char) continue;
+    int skip = StringKernels::IndexOf(subject.start() + i,
+                                      n - i + 1,
+                                      pattern_first_char);
+    if (skip < 0) break;
+    i += skip;
     int j = 1;
     do {
       if (pattern[j] != subject[i+j]) {
@@ -2367,12 +2388,7 @@ static int StringMatchStrategy(Vector<const schar> sub,
   // really is a non-ASCII character in the needle and bail out if there
   // is.
   if (sizeof(schar) == 1 && sizeof(pchar) > 1) {
-    for (int i = 0; i < pat.length(); i++) {
-      uc16 c = pat[i];
-      if (c > String::kMaxAsciiCharCode) {
-        return -1;
-      }
-    }
+    if (!StringKernels::IsAscii(pat.start(), pat.length())) return -1;
   }
   if (pat.length() < kBMMinPatternLength) {
     // We don't believe fancy searching can ever be more efficient.
@@ -2389,6 +2405,67 @@ static int StringMatchStrategy(Vector<const schar> sub,
   return BoyerMooreIndexOf(sub, pat, idx);
 }
 
+// Search for the pattern in a block of a subject string.
+template <typename schar, typename pchar>
+static int BlockIndexOf(Vector<const schar> block, Vector<const pchar> pat) {
+  if (pat.length() == 1) {
+    if (sizeof(schar) == 1 && pat[0] > String::kMaxAsciiCharCode) return -1;
+    return SingleCharIndexOf(block, static_cast<schar>(pat[0]), 0);
+  }
+  return StringMatchStrategy(block, pat, 0);
+}
+
+
+static const int kConsStringMatchBlockSize = 16 * KB;
+
+
+// Search a subject that is not flat without flattening it.  The segments
+// of the subject are copied into a block of bounded size which is searched
+// with the strategies for flat strings.  The last pattern length - 1
+// characters of a block, which can start a match that is not complete
+// yet, are kept at the start of the next block.
+template <typename schar, typename pchar>
+static int ConsStringMatch(String* sub,
+                           Vector<const pchar> pat,
+                           int start_index) {
+  int pattern_length = pat.length();
+  int capacity = Max(kConsStringMatchBlockSize, 2 * pattern_length);
+  ScopedVector<schar> block(capacity);
+  int block_length = 0;
+  int block_offset = start_index;
+  ConsStringIterator segment(sub, start_index);
+  bool has_more = segment.Next();
+  int position = 0;
+  while (has_more) {
+    while (has_more && block_length < capacity) {
+      int chars = Min(capacity - block_length, segment.length() - position);
+      schar* dest = block.start() + block_length;
+      if (segment.is_ascii()) {
+        CopyChars(dest, segment.ToAsciiVector().start() + position, chars);
+      } else {
+        CopyChars(dest, segment.ToUC16Vector().start() + position, chars);
+      }
+      block_length += chars;
+      position += chars;
+      if (position == segment.length()) {
+        has_more = segment.Next();
+        position = 0;
+      }
+    }
+    int index = BlockIndexOf(Vector<const schar>(block.start(), block_length),
+                             pat);
+    if (index >= 0) return block_offset + index;
+    int keep = Min(block_length, pattern_length - 1);
+    memmove(block.start(),
+            block.start() + block_length - keep,
+            keep * sizeof(schar));
+    block_offset += block_length - keep;
+    block_length = keep;
+  }
+  return -1;
+}
+
+
 // Perform string match of pattern on subject, starting at start index.
 // Caller must ensure that 0 <= start_index <= sub->length(),
 // and should check that pat->length() + start_index <= sub->length()
@@ -2405,7 +2482,27 @@ int Runtime::StringMatch(Handle<String> sub,
   if (start_index + pattern_length > subject_length) return -1;
 
   if (!sub->IsFlat()) {
-    FlattenString(sub);
+    // A search that does not start at the beginning is usually one in a
+    // series of searches through the same subject, which is worth
+    // flattening.  Otherwise search the segments in place.
+    if (start_index > 0) {
+      FlattenString(sub);
+    } else {
+      if (!pat->IsFlat()) FlattenString(pat);
+      AssertNoAllocation no_heap_allocation;  // ensure vectors stay valid
+      if (pat->IsAsciiRepresentation()) {
+        Vector<const char> pat_vector = pat->ToAsciiVector();
+        if (sub->IsAsciiRepresentation()) {
+          return ConsStringMatch<char>(*sub, pat_vector, start_index);
+        }
+        return ConsStringMatch<uc16>(*sub, pat_vector, start_index);
+      }
+      Vector<const uc16> pat_vector = pat->ToUC16Vector();
+      if (sub->IsAsciiRepresentation()) {
+        return ConsStringMatch<char>(*sub, pat_vector, start_index);
+      }
+      return ConsStringMatch<uc16>(*sub, pat_vector, start_index);
+    }
   }
   // Searching for one specific character is common.  For one
   // character patterns linear search is necessary, so any smart
@@ -2417,16 +2514,9 @@ int Runtime::StringMatch(Handle<String> sub,
       if (pchar > String::kMaxAsciiCharCode) {
         return -1;
       }
-      Vector<const char> ascii_vector =
-        sub->ToAsciiVector().SubVector(start_index, subject_length);
-      const void* pos = memchr(ascii_vector.start(),
-                               static_cast<const char>(pchar),
-                               static_cast<size_t>(ascii_vector.length()));
-      if (pos == NULL) {
-        return -1;
-      }
-      return static_cast<int>(reinterpret_cast<const char*>(pos)
-          - ascii_vector.start() + start_index);
+      return SingleCharIndexOf(sub->ToAsciiVector(),
+                               static_cast<char>(pchar),
+                               start_index);
     }
     return SingleCharIndexOf(sub->ToUC16Vector(), pat->Get(0), start_index);
   }
@@ -2592,7 +2682,7 @@ static Object* Runtime_StringLocaleCompare(Arguments args) {
   int str1_length = str1->length();
   int str2_length = str2->length();
 
-  // Decide trivial cases without flattening.
+  // Decide trivial cases without traversing the strings.
   if (str1_length == 0) {
     if (str2_length == 0) return Smi::FromInt(0);  // Equal.
     return Smi::FromInt(-str2_length);
@@ -2602,26 +2692,15 @@ static Object* Runtime_StringLocaleCompare(Arguments args) {
 
   int end = str1_length < str2_length ? str1_length : str2_length;
 
-  // No need to flatten if we are going to find the answer on the first
-  // character.  At this point we know there is at least one character
-  // in each string, due to the trivial case handling above.
+  // No need to traverse the strings if we are going to find the answer on
+  // the first character.  At this point we know there is at least one
+  // character in each string, due to the trivial case handling above.
   int d = str1->Get(0) - str2->Get(0);
   if (d != 0) return Smi::FromInt(d);
 
-  str1->TryFlatten();
-  str2->TryFlatten();
-
-  static StringInputBuffer buf1;
-  static StringInputBuffer buf2;
-
-  buf1.Reset(str1);
-  buf2.Reset(str2);
-
-  for (int i = 0; i < end; i++) {
-    uint16_t char1 = buf1.GetNext();
-    uint16_t char2 = buf2.GetNext();
-    if (char1 != char2) return Smi::FromInt(char1 - char2);
-  }
+  // Compare the rest segment by segment, cons strings are not flattened.
+  d = ConsStringIterator::Compare(str1, str2, end);
+  if (d != 0) return Smi::FromInt(d);
 
   return Smi::FromInt(str1_length - str2_length);
 }
@@ -4643,7 +4722,9 @@ static Object* FlatStringCompare(String* x, String* y) {
       r = CompareChars(x_chars.start(), y_chars.start(), prefix_length);
     } else {
       Vector<const uc16> y_chars = y->ToUC16Vector();
-      r = CompareChars(x_chars.start(), y_chars.start(), prefix_length);
+      r = StringKernels::Compare(x_chars.start(),
+                                 y_chars.start(),
+                                 prefix_length);
     }
   }
   Object* result;
@@ -4666,7 +4747,7 @@ static Object* Runtime_StringCompare(Arguments args) {
 
   Counters::string_compare_runtime.Increment();
 
-  // A few fast case tests before we flatten.
+  // A few fast case tests before we traverse the strings.
   if (x == y) return Smi::FromInt(EQUAL);
   if (y->length() == 0) {
     if (x->length() == 0) return Smi::FromInt(EQUAL);
@@ -4679,11 +4760,15 @@ static Object* Runtime_StringCompare(Arguments args) {
   if (d < 0) return Smi::FromInt(LESS);
   else if (d > 0) return Smi::FromInt(GREATER);
 
-  x->TryFlatten();
-  y->TryFlatten();
+  if (x->IsFlat() && y->IsFlat()) return FlatStringCompare(x, y);
 
-  return (x->IsFlat() && y->IsFlat()) ? FlatStringCompare(x, y)
-                                      : StringInputBufferCompare(x, y);
+  // Compare cons strings segment by segment instead of flattening them.
+  int x_length = x->length();
+  int y_length = y->length();
+  d = ConsStringIterator::Compare(x, y, Min(x_length, y_length));
+  if (d == 0) d = x_length - y_length;
+  if (d < 0) return Smi::FromInt(LESS);
+  return Smi::FromInt(d > 0 ? GREATER : EQUAL);
 }
 
 
@@ -5038,7 +5123,13 @@ static Object* Runtime_NewObject(Arguments args) {
   EnsureCompiled(shared, CLEAR_EXCEPTION);
 
   bool first_allocation = !function->has_initial_map();
-  Handle<JSObject> result = Factory::NewJSObject(function);
+  // The construct stubs leave the allocation of objects of pretenured maps
+  // to this function.
+  PretenureFlag pretenure =
+      (!first_allocation && function->initial_map()->is_pretenured())
+      ? TENURED
+      : NOT_TENURED;
+  Handle<JSObject> result = Factory::NewJSObject(function, pretenure);
   if (first_allocation) {
     Handle<Code> stub = Handle<Code>(
         ComputeConstructStub(Handle<JSFunction>(function)));
@@ -5666,6 +5757,346 @@ static Object* Runtime_CompileString(Arguments args) {
 }
 
 
+static Object* Runtime_ParseJson(Arguments args) {
+  HandleScope scope;
+  ASSERT_EQ(1, args.length());
+  CONVERT_ARG_CHECKED(String, source, 0);
+
+  Handle<Object> result = JsonParser::Parse(source);
+  if (result.is_null()) return Failure::Exception();
+  return *result;
+}
+
+
+// Serializes values to JSON without calling into JavaScript, for
+// JSON.stringify without a replacer.  Values that may run JavaScript or
+// need the full algorithm are left to JSONSerialize in json-delay.js:
+// objects with a toJSON property, accessors, interceptors, holes in
+// arrays, wrapper objects and other special objects, and cycles.
+class JsonStringifier BASE_EMBEDDED {
+ public:
+  JsonStringifier()
+      : to_json_symbol_(Factory::LookupAsciiSymbol("toJSON")),
+        checked_maps_gc_count_(Heap::gc_count()),
+        buffer_(NewArray<char>(kInitialCapacity)),
+        length_(0),
+        capacity_(kInitialCapacity) { }
+  ~JsonStringifier() { DeleteArray(buffer_); }
+
+  // Returns the JSON text of the value, or undefined if the value has no
+  // JSON text or cannot be serialized here.
+  Object* Stringify(Handle<Object> value, Handle<String> gap);
+
+ private:
+  enum Result { SUCCESS, UNDEFINED, BAILOUT };
+
+  Result SerializeValue(Handle<Object> value);
+  Result SerializeObject(Handle<JSObject> object);
+  Result SerializeArray(Handle<JSArray> array);
+  void SerializeString(String* string);
+  void SerializeCharacter(uc32 c) {
+    if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+      Append(static_cast<char>(c));
+    } else {
+      SerializeEscapedCharacter(c);
+    }
+  }
+  void SerializeEscapedCharacter(uc32 c);
+  void SerializeNumber(double number);
+
+  bool IsPlainObject(JSObject* object, InstanceType type);
+  bool Push(Handle<JSObject> object);
+  void Pop() { stack_.RemoveLast(); }
+  void NewLine();
+
+  void Append(char c) {
+    if (length_ == capacity_) Grow();
+    buffer_[length_++] = c;
+  }
+  void Append(const char* chars) {
+    while (*chars != '\0') Append(*chars++);
+  }
+  void Grow();
+
+  Handle<String> to_json_symbol_;
+  // The maps that have been checked for a toJSON property.  No JavaScript
+  // runs while serializing, so the result holds for the whole call.  The
+  // maps are forgotten when a garbage collection may have moved them.
+  List<Map*> checked_maps_;
+  int checked_maps_gc_count_;
+  // The objects and arrays being serialized, for detecting cycles.
+  List<Handle<JSObject> > stack_;
+  List<char> gap_;
+
+  // The JSON text.
+  static const int kInitialCapacity = 256;
+  char* buffer_;
+  int length_;
+  int capacity_;
+};
+
+
+Object* JsonStringifier::Stringify(Handle<Object> value, Handle<String> gap) {
+  // The JSON text is ASCII since all other characters are escaped, so a
+  // gap with other characters is left to the full serializer.
+  for (int i = 0; i < gap->length(); i++) {
+    uc16 c = gap->Get(i);
+    if (c > String::kMaxAsciiCharCode) return Heap::undefined_value();
+    gap_.Add(static_cast<char>(c));
+  }
+  if (SerializeValue(value) != SUCCESS) return Heap::undefined_value();
+  return *Factory::NewStringFromAscii(Vector<const char>(buffer_, length_));
+}
+
+
+JsonStringifier::Result JsonStringifier::SerializeValue(
+    Handle<Object> value) {
+  if (value->IsSmi()) {
+    char arr[100];
+    Vector<char> buffer(arr, ARRAY_SIZE(arr));
+    Append(IntToCString(Smi::cast(*value)->value(), buffer));
+    return SUCCESS;
+  }
+  switch (HeapObject::cast(*value)->map()->instance_type()) {
+    case HEAP_NUMBER_TYPE:
+      SerializeNumber(HeapNumber::cast(*value)->value());
+      return SUCCESS;
+    case ODDBALL_TYPE:
+      if (value->IsTrue()) {
+        Append("true");
+      } else if (value->IsFalse()) {
+        Append("false");
+      } else if (value->IsNull()) {
+        Append("null");
+      } else if (value->IsUndefined()) {
+        return UNDEFINED;
+      } else {
+        return BAILOUT;  // The hole.
+      }
+      return SUCCESS;
+    case JS_FUNCTION_TYPE:
+      return UNDEFINED;
+    case JS_OBJECT_TYPE:
+      return SerializeObject(Handle<JSObject>::cast(value));
+    case JS_ARRAY_TYPE:
+      return SerializeArray(Handle<JSArray>::cast(value));
+    default:
+      if (value->IsString()) {
+        SerializeString(String::cast(*value));
+        return SUCCESS;
+      }
+      return BAILOUT;
+  }
+}
+
+
+JsonStringifier::Result JsonStringifier::SerializeObject(
+    Handle<JSObject> object) {
+  if (!IsPlainObject(*object, JS_OBJECT_TYPE)) return BAILOUT;
+  // Properties with array index names come first in a for-in loop.
+  if (object->elements()->length() > 0) return BAILOUT;
+  if (!Push(object)) return BAILOUT;
+
+  HandleScope scope;
+  Handle<FixedArray> keys = GetEnumPropertyKeys(object, true);
+  Append('{');
+  bool empty = true;
+  for (int i = 0; i < keys->length(); i++) {
+    String* key = String::cast(keys->get(i));
+    LookupResult result;
+    object->LocalLookupRealNamedProperty(key, &result);
+    Object* property;
+    if (!result.IsProperty()) return BAILOUT;
+    switch (result.type()) {
+      case FIELD:
+        property = object->FastPropertyAt(result.GetFieldIndex());
+        break;
+      case NORMAL:
+        property = object->property_dictionary()->ValueAt(
+            result.GetDictionaryEntry());
+        break;
+      case CONSTANT_FUNCTION:
+        continue;  // Functions have no JSON text.
+      default:
+        return BAILOUT;
+    }
+    Handle<Object> value(property);
+    if (value->IsUndefined() || value->IsJSFunction()) continue;
+    if (!empty) Append(',');
+    empty = false;
+    NewLine();
+    SerializeString(String::cast(keys->get(i)));
+    Append(':');
+    if (gap_.length() > 0) Append(' ');
+    if (SerializeValue(value) != SUCCESS) return BAILOUT;
+  }
+  Pop();
+  if (!empty) NewLine();
+  Append('}');
+  return SUCCESS;
+}
+
+
+JsonStringifier::Result JsonStringifier::SerializeArray(
+    Handle<JSArray> array) {
+  if (!IsPlainObject(*array, JS_ARRAY_TYPE)) return BAILOUT;
+  int length = Smi::cast(array->length())->value();
+  if (length > array->elements()->length()) return BAILOUT;
+  if (!Push(array)) return BAILOUT;
+
+  HandleScope scope;
+  Handle<FixedArray> elements(FixedArray::cast(array->elements()));
+  Append('[');
+  for (int i = 0; i < length; i++) {
+    if (i > 0) Append(',');
+    NewLine();
+    Handle<Object> value(elements->get(i));
+    Result result = SerializeValue(value);
+    if (result == UNDEFINED) {
+      Append("null");
+    } else if (result == BAILOUT) {
+      return BAILOUT;
+    }
+  }
+  Pop();
+  if (length > 0) NewLine();
+  Append(']');
+  return SUCCESS;
+}
+
+
+bool JsonStringifier::IsPlainObject(JSObject* object, InstanceType type) {
+  if (object->map()->instance_type() != type ||
+      object->IsAccessCheckNeeded() ||
+      object->HasNamedInterceptor() ||
+      object->HasIndexedInterceptor() ||
+      !object->HasFastElements()) {
+    return false;
+  }
+  // A toJSON property anywhere on the prototype chain is looked up and
+  // possibly called by the full serializer.
+  if (checked_maps_gc_count_ != Heap::gc_count()) {
+    checked_maps_.Clear();
+    checked_maps_gc_count_ = Heap::gc_count();
+  }
+  Map* map = object->map();
+  for (int i = 0; i < checked_maps_.length(); i++) {
+    if (checked_maps_[i] == map) return true;
+  }
+  LookupResult result;
+  object->Lookup(*to_json_symbol_, &result);
+  if (result.IsProperty()) return false;
+  checked_maps_.Add(map);
+  return true;
+}
+
+
+bool JsonStringifier::Push(Handle<JSObject> object) {
+  // Cycles and deep nesting are reported by the full serializer.
+  StackLimitCheck check;
+  if (check.HasOverflowed()) return false;
+  for (int i = 0; i < stack_.length(); i++) {
+    if (*stack_[i] == *object) return false;
+  }
+  stack_.Add(object);
+  return true;
+}
+
+
+void JsonStringifier::NewLine() {
+  if (gap_.length() == 0) return;
+  Append('\n');
+  for (int i = 0; i < stack_.length(); i++) {
+    for (int j = 0; j < gap_.length(); j++) Append(gap_[j]);
+  }
+}
+
+
+void JsonStringifier::Grow() {
+  int new_capacity = capacity_ * 2;
+  char* new_buffer = NewArray<char>(new_capacity);
+  memcpy(new_buffer, buffer_, length_);
+  DeleteArray(buffer_);
+  buffer_ = new_buffer;
+  capacity_ = new_capacity;
+}
+
+
+void JsonStringifier::SerializeString(String* string) {
+  Append('"');
+  if (StringShape(string).IsSequentialAscii()) {
+    char* chars = SeqAsciiString::cast(string)->GetChars();
+    int length = string->length();
+    for (int i = 0; i < length; i++) {
+      SerializeCharacter(static_cast<unsigned char>(chars[i]));
+    }
+  } else {
+    Access<StringInputBuffer> buffer(&runtime_string_input_buffer);
+    buffer->Reset(string);
+    while (buffer->has_more()) SerializeCharacter(buffer->GetNext());
+  }
+  Append('"');
+}
+
+
+void JsonStringifier::SerializeEscapedCharacter(uc32 c) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  switch (c) {
+    case '"':
+      Append("\\\"");
+      break;
+    case '\\':
+      Append("\\\\");
+      break;
+    case '\b':
+      Append("\\b");
+      break;
+    case '\f':
+      Append("\\f");
+      break;
+    case '\n':
+      Append("\\n");
+      break;
+    case '\r':
+      Append("\\r");
+      break;
+    case '\t':
+      Append("\\t");
+      break;
+    default:
+      // Other control characters and all non-ASCII characters are written
+      // as four digit hex escapes.
+      Append("\\u");
+      Append(kHexDigits[(c >> 12) & 0xf]);
+      Append(kHexDigits[(c >> 8) & 0xf]);
+      Append(kHexDigits[(c >> 4) & 0xf]);
+      Append(kHexDigits[c & 0xf]);
+      break;
+  }
+}
+
+
+void JsonStringifier::SerializeNumber(double number) {
+  if (isnan(number) || isinf(number)) {
+    Append("null");
+    return;
+  }
+  char arr[100];
+  Vector<char> buffer(arr, ARRAY_SIZE(arr));
+  Append(DoubleToCString(number, buffer));
+}
+
+
+static Object* Runtime_StringifyJson(Arguments args) {
+  HandleScope scope;
+  ASSERT_EQ(2, args.length());
+  CONVERT_ARG_CHECKED(String, gap, 1);
+
+  JsonStringifier stringifier;
+  return stringifier.Stringify(args.at<Object>(0), gap);
+}
+
+
 static ObjectPair Runtime_ResolvePossiblyDirectEval(Arguments args) {
   ASSERT(args.length() == 3);
   if (!args[0]->IsJSFunction()) {
@@ -207,6 +207,8 @@ namespace internal {
   \
   /* Globals */ \
   F(CompileString, 2, 1) \
+  F(ParseJson, 1, 1) \
+  F(StringifyJson, 2, 1) \
   F(GlobalPrint, 1, 1) \
   \
   /* Eval */ \
@@ -436,6 +436,27 @@ void ExternalReferenceTable::PopulateTable() {
       UNCLASSIFIED,
       25,
       "TranscendentalCache::caches()");
+  // Store buffer.
+  Add(ExternalReference::store_buffer_top().address(),
+      UNCLASSIFIED,
+      26,
+      "StoreBuffer::top_address()");
+  Add(ExternalReference::store_buffer_limit().address(),
+      UNCLASSIFIED,
+      27,
+      "StoreBuffer::limit_address()");
+  Add(ExternalReference::store_buffer_overflow_function().address(),
+      UNCLASSIFIED,
+      28,
+      "StoreBuffer::Compact()");
+  Add(ExternalReference::old_pointer_space_allocation_top_address().address(),
+      UNCLASSIFIED,
+      29,
+      "Heap::OldPointerSpaceAllocationTopAddress()");
+  Add(ExternalReference::old_pointer_space_allocation_limit_address().address(),
+      UNCLASSIFIED,
+      30,
+      "Heap::OldPointerSpaceAllocationLimitAddress()");
 }
 
 
@@ -94,27 +94,7 @@ Address Page::ComputeRSetBitPosition(Address address, int offset,
 
   Address rset_address =
       page->address() + kRSetOffset + (bit_offset / kBitsPerInt) * kIntSize;
-  // The remembered set address is either in the normal remembered set range
-  // of a page or else we have a large object page.
-  ASSERT((page->RSetStart() <= rset_address && rset_address < page->RSetEnd())
-         || page->IsLargeObjectPage());
-
-  if (rset_address >= page->RSetEnd()) {
-    // We have a large object page, and the remembered set address is actually
-    // past the end of the object.
-
-    // The first part of the remembered set is still located at the start of
-    // the page, but anything after kRSetEndOffset must be relocated to after
-    // the large object, i.e. after
-    //   (page->ObjectAreaStart() + object size)
-    // We do that by adding the difference between the normal RSet's end and
-    // the object's end.
-    ASSERT(HeapObject::FromAddress(address)->IsFixedArray());
-    int fixedarray_length =
-        FixedArray::SizeFor(Memory::int_at(page->ObjectAreaStart()
-                                           + Array::kLengthOffset));
-    rset_address += kObjectStartOffset - kRSetEndOffset + fixedarray_length;
-  }
+  ASSERT(page->RSetStart() <= rset_address && rset_address < page->RSetEnd());
   return rset_address;
 }
 
@@ -281,6 +261,17 @@ Object* PagedSpace::AllocateRaw(int size_in_bytes) {
 }
 
 
+Object* OldSpace::AllocateRawInBuffer(int size_in_bytes) {
+  Address current_top = allocation_buffer_.top;
+  Address new_top = current_top + size_in_bytes;
+  if (new_top <= allocation_buffer_.limit) {
+    allocation_buffer_.top = new_top;
+    return HeapObject::FromAddress(current_top);
+  }
+  return RefillAllocationBuffer(size_in_bytes);
+}
+
+
 // Reallocating (and promoting) objects during a compacting collection.
 Object* PagedSpace::MCAllocateRaw(int size_in_bytes) {
   ASSERT(HasBeenSetup());
@@ -309,18 +300,13 @@ HeapObject* LargeObjectChunk::GetObject() {
 // -----------------------------------------------------------------------------
 // LargeObjectSpace
 
-int LargeObjectSpace::ExtraRSetBytesFor(int object_size) {
-  int extra_rset_bits =
-      RoundUp((object_size - Page::kObjectAreaSize) / kPointerSize,
-              kBitsPerInt);
-  return extra_rset_bits / kBitsPerByte;
-}
-
-
 Object* NewSpace::AllocateRawInternal(int size_in_bytes,
                                       AllocationInfo* alloc_info) {
   Address new_top = alloc_info->top + size_in_bytes;
-  if (new_top > alloc_info->limit) return Failure::RetryAfterGC(size_in_bytes);
+  if (new_top > alloc_info->limit) {
+    if (alloc_info == &allocation_info_) return SlowAllocateRaw(size_in_bytes);
+    return Failure::RetryAfterGC(size_in_bytes);
+  }
 
   Object* obj = HeapObject::FromAddress(alloc_info->top);
   alloc_info->top = new_top;
@@ -328,8 +314,8 @@ Object* NewSpace::AllocateRawInternal(int size_in_bytes,
   SemiSpace* space =
       (alloc_info == &allocation_info_) ? &to_space_ : &from_space_;
   ASSERT(space->low() <= alloc_info->top
-         && alloc_info->top <= space->high()
-         && alloc_info->limit == space->high());
+         && alloc_info->top <= alloc_info->limit
+         && alloc_info->limit <= space->high());
 #endif
   return obj;
 }
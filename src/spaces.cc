@@ -27,6 +27,7 @@
 
 #include "v8.h"
 
+#include "allocation-sampler.h"
 #include "macro-assembler.h"
 #include "mark-compact.h"
 #include "platform.h"
@@ -38,31 +39,39 @@ namespace internal {
 // should be the end of the space.
 #define ASSERT_SEMISPACE_ALLOCATION_INFO(info, space) \
   ASSERT((space).low() <= (info).top                  \
-         && (info).top <= (space).high()              \
-         && (info).limit == (space).high())
+         && (info).top <= (info).limit                \
+         && (info).limit <= (space).high())
 
 
 // ----------------------------------------------------------------------------
 // HeapObjectIterator
 
 HeapObjectIterator::HeapObjectIterator(PagedSpace* space) {
+  space->EnsureSweepingCompleted();
+  space->FreeAllocationBuffer();
   Initialize(space->bottom(), space->top(), NULL);
 }
 
 
 HeapObjectIterator::HeapObjectIterator(PagedSpace* space,
                                        HeapObjectCallback size_func) {
+  space->EnsureSweepingCompleted();
+  space->FreeAllocationBuffer();
   Initialize(space->bottom(), space->top(), size_func);
 }
 
 
 HeapObjectIterator::HeapObjectIterator(PagedSpace* space, Address start) {
+  space->EnsureSweepingCompleted();
+  space->FreeAllocationBuffer();
   Initialize(start, space->top(), NULL);
 }
 
 
 HeapObjectIterator::HeapObjectIterator(PagedSpace* space, Address start,
                                        HeapObjectCallback size_func) {
+  space->EnsureSweepingCompleted();
+  space->FreeAllocationBuffer();
   Initialize(start, space->top(), size_func);
 }
 
@@ -244,6 +253,9 @@ void* CodeRange::AllocateRawMemory(const size_t requested, size_t* allocated) {
     *allocated = 0;
     return NULL;
   }
+  if (MemoryAllocator::UseHugePages()) {
+    OS::AdviseHugePages(current.start, *allocated);
+  }
   allocation_list_[current_allocation_block_index_].start += *allocated;
   allocation_list_[current_allocation_block_index_].size -= *allocated;
   if (*allocated == current.size) {
@@ -284,6 +296,10 @@ List<int> MemoryAllocator::free_chunk_ids_(kEstimatedNumberOfChunks);
 int MemoryAllocator::max_nof_chunks_ = 0;
 int MemoryAllocator::top_ = 0;
 
+List<MemoryAllocator::CachedChunk>
+    MemoryAllocator::large_object_cache_[kLargeObjectCacheClasses];
+int MemoryAllocator::large_object_cache_size_ = 0;
+
 
 void MemoryAllocator::Push(int free_chunk_id) {
   ASSERT(max_nof_chunks_ > 0);
@@ -325,6 +341,7 @@ bool MemoryAllocator::Setup(int capacity) {
 
 
 void MemoryAllocator::TearDown() {
+  FlushLargeObjectCache();
   for (int i = 0; i < max_nof_chunks_; i++) {
     if (chunks_[i].address() != NULL) DeleteChunk(i);
   }
@@ -352,9 +369,12 @@ void* MemoryAllocator::AllocateRawMemory(const size_t requested,
   void* mem;
   if (executable == EXECUTABLE  && CodeRange::exists()) {
     mem = CodeRange::AllocateRawMemory(requested, allocated);
+  } else if (UseHugePages() && requested % OS::HugePageSize() == 0) {
+    mem = AllocateHugePageAlignedMemory(requested, allocated, executable);
   } else {
     mem = OS::Allocate(requested, allocated, (executable == EXECUTABLE));
   }
+  if (mem == NULL) return NULL;
   int alloced = static_cast<int>(*allocated);
   size_ += alloced;
 #ifdef DEBUG
@@ -380,6 +400,153 @@ void MemoryAllocator::FreeRawMemory(void* mem, size_t length) {
 }
 
 
+bool MemoryAllocator::UseHugePages() {
+  return FLAG_transparent_huge_pages && OS::HugePageSize() > 0;
+}
+
+
+int MemoryAllocator::PagesPerChunk() {
+  if (UseHugePages()) {
+    return static_cast<int>(OS::HugePageSize()) / Page::kPageSize;
+  }
+  return kPagesPerChunk;
+}
+
+
+void* MemoryAllocator::AllocateHugePageAlignedMemory(
+    const size_t requested,
+    size_t* allocated,
+    Executability executable) {
+  size_t alignment = OS::HugePageSize();
+  ASSERT(requested % alignment == 0);
+
+  // Over-allocate by a huge page and unmap the unaligned ends.
+  size_t reserved;
+  Address base = static_cast<Address>(OS::Allocate(requested + alignment,
+                                                   &reserved,
+                                                   executable == EXECUTABLE));
+  if (base == NULL) return NULL;
+  Address start = RoundUp(base, alignment);
+  Address end = start + requested;
+  Address limit = base + reserved;
+  if (start > base) OS::Free(base, start - base);
+  if (limit > end) OS::Free(end, limit - end);
+
+  OS::AdviseHugePages(start, requested);
+  *allocated = requested;
+  return start;
+}
+
+
+int MemoryAllocator::LargeObjectCacheClass(size_t size) {
+  size_t pages = size >> kPageSizeBits;
+  int size_class = 0;
+  while (pages > 1 && size_class < kLargeObjectCacheClasses - 1) {
+    pages >>= 1;
+    size_class++;
+  }
+  return size_class;
+}
+
+
+void* MemoryAllocator::AllocateLargeObjectMemory(const size_t requested,
+                                                 size_t* allocated,
+                                                 Executability executable) {
+  if (executable == EXECUTABLE) {
+    return AllocateRawMemory(requested, allocated, executable);
+  }
+
+  // Take the first cached chunk that is big enough and wastes at most a
+  // quarter of the request.  Such chunks are in the class of the request or
+  // in the next one.
+  size_t max_size = requested + requested / 4;
+  int first_class = LargeObjectCacheClass(requested);
+  int last_class = Min(first_class + 1, kLargeObjectCacheClasses - 1);
+  for (int size_class = first_class; size_class <= last_class; size_class++) {
+    List<CachedChunk>& chunks = large_object_cache_[size_class];
+    for (int i = 0; i < chunks.length(); i++) {
+      CachedChunk chunk = chunks[i];
+      if (chunk.size < requested || chunk.size > max_size) continue;
+      if (size_ + static_cast<int>(chunk.size) > capacity_) return NULL;
+      chunks[i] = chunks.last();
+      chunks.RemoveLast();
+      int alloced = static_cast<int>(chunk.size);
+      large_object_cache_size_ -= alloced;
+      size_ += alloced;
+#ifdef DEBUG
+      ZapBlock(chunk.address, alloced);
+#endif
+      Counters::memory_allocated.Increment(alloced);
+      Counters::large_object_cache_hits.Increment();
+      *allocated = chunk.size;
+      return chunk.address;
+    }
+  }
+
+  Counters::large_object_cache_misses.Increment();
+  void* mem = AllocateRawMemory(requested, allocated, executable);
+  if (mem == NULL && large_object_cache_size_ > 0) {
+    // The OS may be short of memory that the cache is holding on to.
+    FlushLargeObjectCache();
+    mem = AllocateRawMemory(requested, allocated, executable);
+  }
+  return mem;
+}
+
+
+void MemoryAllocator::FreeLargeObjectMemory(void* mem,
+                                            size_t length,
+                                            Executability executable) {
+  int max_cache_size = FLAG_large_object_cache_size * MB;
+  if (executable == EXECUTABLE ||
+      large_object_cache_size_ + static_cast<int>(length) > max_cache_size) {
+    FreeRawMemory(mem, length);
+    return;
+  }
+
+#ifdef DEBUG
+  ZapBlock(reinterpret_cast<Address>(mem), length);
+#endif
+  CachedChunk chunk;
+  chunk.address = reinterpret_cast<Address>(mem);
+  chunk.size = length;
+  chunk.released = false;
+  large_object_cache_[LargeObjectCacheClass(length)].Add(chunk);
+  large_object_cache_size_ += static_cast<int>(length);
+  Counters::memory_allocated.Decrement(static_cast<int>(length));
+  size_ -= static_cast<int>(length);
+  ASSERT(size_ >= 0);
+}
+
+
+void MemoryAllocator::ReleaseLargeObjectCache() {
+  for (int size_class = 0;
+       size_class < kLargeObjectCacheClasses;
+       size_class++) {
+    List<CachedChunk>& chunks = large_object_cache_[size_class];
+    for (int i = 0; i < chunks.length(); i++) {
+      if (chunks[i].released) continue;
+      OS::ReleasePages(chunks[i].address, chunks[i].size);
+      chunks[i].released = true;
+    }
+  }
+}
+
+
+void MemoryAllocator::FlushLargeObjectCache() {
+  for (int size_class = 0;
+       size_class < kLargeObjectCacheClasses;
+       size_class++) {
+    List<CachedChunk>& chunks = large_object_cache_[size_class];
+    for (int i = 0; i < chunks.length(); i++) {
+      OS::Free(chunks[i].address, chunks[i].size);
+    }
+    chunks.Free();
+  }
+  large_object_cache_size_ = 0;
+}
+
+
 void* MemoryAllocator::ReserveInitialChunk(const size_t requested) {
   ASSERT(initial_chunk_ == NULL);
 
@@ -476,6 +643,7 @@ bool MemoryAllocator::CommitBlock(Address start,
   ASSERT(InInitialChunk(start + size - 1));
 
   if (!initial_chunk_->Commit(start, size, executable)) return false;
+  if (UseHugePages()) OS::AdviseHugePages(start, size);
 #ifdef DEBUG
   ZapBlock(start, size);
 #endif
@@ -653,7 +821,7 @@ bool PagedSpace::Setup(Address start, size_t size) {
                                                Page::kPageSize * pages_in_chunk,
                                                this, &num_pages);
   } else {
-    int requested_pages = Min(MemoryAllocator::kPagesPerChunk,
+    int requested_pages = Min(MemoryAllocator::PagesPerChunk(),
                               max_capacity_ / Page::kObjectAreaSize);
     first_page_ =
         MemoryAllocator::AllocatePages(requested_pages, &num_pages, this);
@@ -839,9 +1007,12 @@ bool PagedSpace::Expand(Page* last_page) {
   ASSERT(last_page->is_valid() && !last_page->next_page()->is_valid());
 
   int available_pages = (max_capacity_ - Capacity()) / Page::kObjectAreaSize;
+  // The embedder's hard limit on the old generation may be lower.
+  available_pages = Min(available_pages,
+      Heap::OldGenerationHardLimitAvailable() / Page::kObjectAreaSize);
   if (available_pages <= 0) return false;
 
-  int desired_pages = Min(available_pages, MemoryAllocator::kPagesPerChunk);
+  int desired_pages = Min(available_pages, MemoryAllocator::PagesPerChunk());
   Page* p = MemoryAllocator::AllocatePages(desired_pages, &desired_pages, this);
   if (!p->is_valid()) return false;
 
@@ -1111,13 +1282,18 @@ void NewSpace::Grow() {
       }
     }
   }
-  allocation_info_.limit = to_space_.high();
+  UpdateAllocationLimit();
   ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
 }
 
 
 void NewSpace::Shrink() {
-  int new_capacity = Max(InitialCapacity(), 2 * Size());
+  ShrinkTo(InitialCapacity());
+}
+
+
+void NewSpace::ShrinkTo(int new_capacity) {
+  new_capacity = Max(new_capacity, Max(InitialCapacity(), 2 * Size()));
   int rounded_new_capacity =
       RoundUp(new_capacity, static_cast<int>(OS::AllocateAlignment()));
   if (rounded_new_capacity < Capacity() &&
@@ -1133,14 +1309,14 @@ void NewSpace::Shrink() {
       }
     }
   }
-  allocation_info_.limit = to_space_.high();
+  UpdateAllocationLimit();
   ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
 }
 
 
 void NewSpace::ResetAllocationInfo() {
   allocation_info_.top = to_space_.low();
-  allocation_info_.limit = to_space_.high();
+  UpdateAllocationLimit();
   ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
 }
 
@@ -1156,11 +1332,66 @@ void NewSpace::MCCommitRelocationInfo() {
   // Assumes that the spaces have been flipped so that mc_forwarding_info_ is
   // valid allocation info for the to space.
   allocation_info_.top = mc_forwarding_info_.top;
-  allocation_info_.limit = to_space_.high();
+  UpdateAllocationLimit();
   ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
 }
 
 
+void NewSpace::LowerInlineAllocationLimit(int step) {
+  ASSERT(!allocation_steps_suspended_);
+  inline_allocation_limit_step_ = step;
+  top_on_previous_step_ = allocation_info_.top;
+  UpdateAllocationLimit();
+}
+
+
+void NewSpace::SuspendAllocationSteps() {
+  if (inline_allocation_limit_step_ == 0) return;
+  allocated_since_previous_step_ =
+      static_cast<int>(allocation_info_.top - top_on_previous_step_);
+  allocation_steps_suspended_ = true;
+  UpdateAllocationLimit();
+}
+
+
+void NewSpace::ResumeAllocationSteps() {
+  if (inline_allocation_limit_step_ == 0) return;
+  allocation_steps_suspended_ = false;
+  top_on_previous_step_ =
+      allocation_info_.top - allocated_since_previous_step_;
+  UpdateAllocationLimit();
+}
+
+
+void NewSpace::UpdateAllocationLimit() {
+  Address high = to_space_.high();
+  if (inline_allocation_limit_step_ == 0 || allocation_steps_suspended_) {
+    allocation_info_.limit = high;
+  } else {
+    allocation_info_.limit =
+        Min(top_on_previous_step_ + inline_allocation_limit_step_, high);
+  }
+}
+
+
+Object* NewSpace::SlowAllocateRaw(int size_in_bytes) {
+  Address high = to_space_.high();
+  Address new_top = allocation_info_.top + size_in_bytes;
+  if (allocation_info_.limit < high && new_top <= high) {
+    // The limit was lowered for an allocation step.  Take the step and
+    // move the limit on to the next one.
+    int allocated_bytes = static_cast<int>(new_top - top_on_previous_step_);
+    top_on_previous_step_ = new_top;
+    UpdateAllocationLimit();
+#ifdef ENABLE_LOGGING_AND_PROFILING
+    AllocationSampler::SampleAllocation(allocated_bytes);
+#endif
+    return AllocateRaw(size_in_bytes);
+  }
+  return Failure::RetryAfterGC(size_in_bytes);
+}
+
+
 #ifdef DEBUG
 // We do not use the SemispaceIterator because verification doesn't assume
 // that it works (it depends on the invariants we are checking).
@@ -1723,6 +1954,52 @@ Object* OldSpaceFreeList::Allocate(int size_in_bytes, int* wasted_bytes) {
 }
 
 
+Object* OldSpaceFreeList::AllocateBlock(int size_in_bytes,
+                                        int preferred_size_in_bytes,
+                                        int* block_size) {
+  ASSERT(0 < size_in_bytes);
+  ASSERT(size_in_bytes <= preferred_size_in_bytes);
+  ASSERT(IsAligned(size_in_bytes, kPointerSize));
+
+  if (needs_rebuild_) RebuildSizeList();
+  // Search the size list for a block of the preferred size first and of the
+  // requested size only if there is none.
+  int index = preferred_size_in_bytes >> kPointerSizeLog2;
+  int prev = kHead;
+  int cur = FindSize(index, &prev);
+  if (cur == kEnd) {
+    index = size_in_bytes >> kPointerSizeLog2;
+    prev = kHead;
+    cur = FindSize(index, &prev);
+    if (cur == kEnd) return Failure::RetryAfterGC(size_in_bytes, owner_);
+  }
+  ASSERT(!FLAG_always_compact);  // We only use the freelists with mark-sweep.
+  FreeListNode* cur_node = FreeListNode::FromAddress(free_[cur].head_node_);
+  ASSERT(cur_node->Size() == (cur << kPointerSizeLog2));
+  // If this was the last block of its size, remove the size.
+  if ((free_[cur].head_node_ = cur_node->next()) == NULL) {
+    finger_ = prev;
+    free_[prev].next_size_ = free_[cur].next_size_;
+  }
+  *block_size = cur << kPointerSizeLog2;
+  available_ -= *block_size;
+  return cur_node;
+}
+
+
+void OldSpaceFreeList::CountFreeBytesPerPage(int* free_bytes) {
+  for (int i = 0; i < kFreeListsLength; i++) {
+    Address cur_addr = free_[i].head_node_;
+    while (cur_addr != NULL) {
+      FreeListNode* cur_node = FreeListNode::FromAddress(cur_addr);
+      free_bytes[Page::FromAddress(cur_addr)->mc_page_index] +=
+          i << kPointerSizeLog2;
+      cur_addr = cur_node->next();
+    }
+  }
+}
+
+
 #ifdef DEBUG
 bool OldSpaceFreeList::Contains(FreeListNode* node) {
   for (int i = 0; i < kFreeListsLength; i++) {
@@ -1801,6 +2078,42 @@ void OldSpace::PrepareForMarkCompact(bool will_compact) {
 }
 
 
+int OldSpace::SelectEvacuationCandidates(int max_pages) {
+  // Number the pages so that the free list blocks can be attributed to
+  // them.
+  int page_count = 0;
+  PageIterator all_pages(this, PageIterator::ALL_PAGES);
+  while (all_pages.has_next()) all_pages.next()->mc_page_index = page_count++;
+
+  int* free_bytes = NewArray<int>(page_count);
+  for (int i = 0; i < page_count; i++) free_bytes[i] = 0;
+  free_list_.CountFreeBytesPerPage(free_bytes);
+
+  // Repeatedly pick the most fragmented page that is not yet a candidate.
+  Page* top_page = TopPageOf(allocation_info_);
+  int candidates = 0;
+  while (candidates < max_pages) {
+    Page* best = NULL;
+    int best_free_bytes = Page::kObjectAreaSize / 2 - 1;
+    PageIterator it(this, PageIterator::PAGES_IN_USE);
+    while (it.has_next()) {
+      Page* p = it.next();
+      if (p == top_page || p->IsEvacuationCandidate()) continue;
+      if (free_bytes[p->mc_page_index] > best_free_bytes) {
+        best = p;
+        best_free_bytes = free_bytes[p->mc_page_index];
+      }
+    }
+    if (best == NULL) break;
+    best->SetIsEvacuationCandidate(true);
+    candidates++;
+  }
+
+  DeleteArray(free_bytes);
+  return candidates;
+}
+
+
 void OldSpace::MCCommitRelocationInfo() {
   // Update fast allocation info.
   allocation_info_.top = mc_forwarding_info_.top;
@@ -1845,7 +2158,8 @@ bool NewSpace::ReserveSpace(int bytes) {
   // We can't reliably unpack a partial snapshot that needs more new space
   // space than the minimum NewSpace size.
   ASSERT(bytes <= InitialCapacity());
-  Address limit = allocation_info_.limit;
+  // The allocation limit may be lowered for an allocation step.
+  Address limit = to_space_.high();
   Address top = allocation_info_.top;
   return limit - top >= bytes;
 }
@@ -1899,11 +2213,16 @@ HeapObject* OldSpace::SlowAllocateRaw(int size_in_bytes) {
   }
 
   // There is no next page in this space.  Try free list allocation unless that
-  // is currently forbidden.
+  // is currently forbidden.  Pages left unswept by the last mark-compact
+  // collection are swept one at a time until the allocation succeeds.
   if (!Heap::linear_allocation()) {
     int wasted_bytes;
     Object* result = free_list_.Allocate(size_in_bytes, &wasted_bytes);
     accounting_stats_.WasteBytes(wasted_bytes);
+    while (result->IsFailure() && SweepNextPage()) {
+      result = free_list_.Allocate(size_in_bytes, &wasted_bytes);
+      accounting_stats_.WasteBytes(wasted_bytes);
+    }
     if (!result->IsFailure()) {
       accounting_stats_.AllocateBytes(size_in_bytes);
       return HeapObject::cast(result);
@@ -1928,6 +2247,77 @@ HeapObject* OldSpace::SlowAllocateRaw(int size_in_bytes) {
 }
 
 
+Object* OldSpace::RefillAllocationBuffer(int size_in_bytes) {
+  // Large objects would waste most of a buffer, and the buffer must not
+  // be taken from the free list while only linear allocation is allowed.
+  if (size_in_bytes > kMaxBufferedObjectSize || Heap::linear_allocation()) {
+    return AllocateRaw(size_in_bytes);
+  }
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  // The buffer stays empty while sampling, so that generated code has to
+  // allocate through the runtime, where the allocation is counted.
+  if (AllocationSampler::IsSampling()) return AllocateRaw(size_in_bytes);
+#endif
+  FreeAllocationBuffer();
+
+  // Take the rest of the top page if the object fits in it.
+  Page* top_page = TopPageOf(allocation_info_);
+  int rest_of_page =
+      static_cast<int>(top_page->ObjectAreaEnd() - allocation_info_.top);
+  if (rest_of_page < size_in_bytes) {
+    if (top_page->next_page()->is_valid()) {
+      // Moves the allocation info to the next page.  The next refill takes
+      // the rest of that page.
+      return AllocateRaw(size_in_bytes);
+    }
+    // Otherwise take a whole block off the free list, sweeping unswept
+    // pages until one is found.
+    int block_size;
+    Object* block = free_list_.AllocateBlock(size_in_bytes,
+                                             kAllocationBufferSize,
+                                             &block_size);
+    while (block->IsFailure() && SweepNextPage()) {
+      block = free_list_.AllocateBlock(size_in_bytes,
+                                       kAllocationBufferSize,
+                                       &block_size);
+    }
+    if (block->IsFailure()) {
+      // Expands the space or fails.
+      return AllocateRaw(size_in_bytes);
+    }
+    accounting_stats_.AllocateBytes(block_size);
+    allocation_buffer_.top = HeapObject::cast(block)->address();
+    allocation_buffer_.limit = allocation_buffer_.top + block_size;
+  } else {
+    allocation_buffer_.top =
+        AllocateLinearly(&allocation_info_, rest_of_page)->address();
+    allocation_buffer_.limit = allocation_info_.top;
+  }
+
+  Address result = allocation_buffer_.top;
+  allocation_buffer_.top += size_in_bytes;
+  return HeapObject::FromAddress(result);
+}
+
+
+void OldSpace::FreeAllocationBuffer() {
+  int size =
+      static_cast<int>(allocation_buffer_.limit - allocation_buffer_.top);
+  if (size > 0) {
+    if (allocation_buffer_.limit == allocation_info_.top) {
+      // The buffer is the end of the linear allocation area.  Give it back
+      // to it, so the top page can still be reserved and allocated linearly.
+      allocation_info_.top = allocation_buffer_.top;
+      accounting_stats_.DeallocateBytes(size);
+    } else {
+      Free(allocation_buffer_.top, size);
+    }
+  }
+  allocation_buffer_.top = NULL;
+  allocation_buffer_.limit = NULL;
+}
+
+
 void OldSpace::PutRestOfCurrentPageOnFreeList(Page* current_page) {
   int free_size =
       static_cast<int>(current_page->ObjectAreaEnd() - allocation_info_.top);
@@ -1938,6 +2328,111 @@ void OldSpace::PutRestOfCurrentPageOnFreeList(Page* current_page) {
 }
 
 
+// Returns the first address in [current, limit) whose remembered set bit is
+// set, or limit if there is none.  The bits are scanned a word at a time.
+static Address NextRecordedAddress(Page* p, Address current, Address limit) {
+  while (current < limit) {
+    int index = p->Offset(current) >> kPointerSizeLog2;
+    int bit = index % kBitsPerInt;
+    uint32_t rset_word = Memory::uint32_at(
+        p->address() + Page::kRSetOffset + (index / kBitsPerInt) * kIntSize);
+    rset_word >>= bit;
+    if (rset_word != 0) {
+      while ((rset_word & 1) == 0) {
+        rset_word >>= 1;
+        current += kPointerSize;
+      }
+      return Min(current, limit);
+    }
+    current += (kBitsPerInt - bit) * kPointerSize;
+  }
+  return limit;
+}
+
+
+void OldSpace::StartLazySweeping(HeapObjectCallback unmark_live_object) {
+  ASSERT(IsSweepingComplete());
+  Page* top_page = TopPageOf(allocation_info_);
+  Page* last_unswept_page = Page::FromAddress(NULL);
+  int dead_bytes = 0;
+
+  PageIterator it(this, PageIterator::PAGES_IN_USE);
+  while (it.has_next()) {
+    Page* p = it.next();
+    Address top = p->AllocationTop();
+    int live_bytes = 0;
+    for (Address current = NextRecordedAddress(p, p->ObjectAreaStart(), top);
+         current < top;
+         current = NextRecordedAddress(p, current, top)) {
+      int size = unmark_live_object(HeapObject::FromAddress(current));
+      live_bytes += size;
+      current += size;
+    }
+    dead_bytes += static_cast<int>(top - p->ObjectAreaStart()) - live_bytes;
+    if (p != top_page) last_unswept_page = p;
+  }
+
+  // Everything below the allocation top was counted as allocated by
+  // PrepareForMarkCompact.  The dead bytes are available right away, even
+  // though they only reach the free list when their page is swept.
+  accounting_stats_.DeallocateBytes(dead_bytes);
+
+  // Linear allocation continues in the top page, so it is swept now.
+  SweepPage(top_page);
+  if (last_unswept_page->is_valid()) {
+    first_unswept_page_ = first_page_;
+    last_unswept_page_ = last_unswept_page;
+  }
+}
+
+
+void OldSpace::SweepPage(Page* p) {
+  Address top = p->AllocationTop();
+  Address free_start = p->ObjectAreaStart();
+  while (free_start < top) {
+    Address live_start = NextRecordedAddress(p, free_start, top);
+    if (live_start > free_start) {
+      int wasted_bytes = free_list_.Free(
+          free_start, static_cast<int>(live_start - free_start));
+      accounting_stats_.WasteBytes(wasted_bytes);
+    }
+    if (live_start == top) break;
+    free_start = live_start + HeapObject::FromAddress(live_start)->Size();
+  }
+  p->ClearRSet();
+}
+
+
+bool OldSpace::SweepNextPage() {
+  if (IsSweepingComplete()) return false;
+  Page* p = first_unswept_page_;
+  if (p == last_unswept_page_) {
+    first_unswept_page_ = last_unswept_page_ = Page::FromAddress(NULL);
+  } else {
+    first_unswept_page_ = p->next_page();
+  }
+  SweepPage(p);
+  Counters::gc_pages_swept_lazily.Increment();
+  return true;
+}
+
+
+int OldSpace::CountUnsweptPages() {
+  if (IsSweepingComplete()) return 0;
+  int count = 1;
+  for (Page* p = first_unswept_page_; p != last_unswept_page_;
+       p = p->next_page()) {
+    count++;
+  }
+  return count;
+}
+
+
+void OldSpace::EnsureSweepingCompleted() {
+  while (SweepNextPage()) { }
+}
+
+
 void FixedSpace::PutRestOfCurrentPageOnFreeList(Page* current_page) {
   int free_size =
       static_cast<int>(current_page->ObjectAreaEnd() - allocation_info_.top);
@@ -2102,160 +2597,12 @@ void OldSpace::ReportStatistics() {
   PrintF("  capacity: %d, waste: %d, available: %d, %%%d\n",
          Capacity(), Waste(), Available(), pct);
 
-  // Report remembered set statistics.
-  int rset_marked_pointers = 0;
-  int rset_marked_arrays = 0;
-  int rset_marked_array_elements = 0;
-  int cross_gen_pointers = 0;
-  int cross_gen_array_elements = 0;
-
-  PageIterator page_it(this, PageIterator::PAGES_IN_USE);
-  while (page_it.has_next()) {
-    Page* p = page_it.next();
-
-    for (Address rset_addr = p->RSetStart();
-         rset_addr < p->RSetEnd();
-         rset_addr += kIntSize) {
-      int rset = Memory::int_at(rset_addr);
-      if (rset != 0) {
-        // Bits were set
-        int intoff =
-            static_cast<int>(rset_addr - p->address() - Page::kRSetOffset);
-        int bitoff = 0;
-        for (; bitoff < kBitsPerInt; ++bitoff) {
-          if ((rset & (1 << bitoff)) != 0) {
-            int bitpos = intoff*kBitsPerByte + bitoff;
-            Address slot = p->OffsetToAddress(bitpos << kObjectAlignmentBits);
-            Object** obj = reinterpret_cast<Object**>(slot);
-            if (*obj == Heap::raw_unchecked_fixed_array_map()) {
-              rset_marked_arrays++;
-              FixedArray* fa = FixedArray::cast(HeapObject::FromAddress(slot));
-
-              rset_marked_array_elements += fa->length();
-              // Manually inline FixedArray::IterateBody
-              Address elm_start = slot + FixedArray::kHeaderSize;
-              Address elm_stop = elm_start + fa->length() * kPointerSize;
-              for (Address elm_addr = elm_start;
-                   elm_addr < elm_stop; elm_addr += kPointerSize) {
-                // Filter non-heap-object pointers
-                Object** elm_p = reinterpret_cast<Object**>(elm_addr);
-                if (Heap::InNewSpace(*elm_p))
-                  cross_gen_array_elements++;
-              }
-            } else {
-              rset_marked_pointers++;
-              if (Heap::InNewSpace(*obj))
-                cross_gen_pointers++;
-            }
-          }
-        }
-      }
-    }
-  }
-
-  pct = rset_marked_pointers == 0 ?
-        0 : cross_gen_pointers * 100 / rset_marked_pointers;
-  PrintF("  rset-marked pointers %d, to-new-space %d (%%%d)\n",
-            rset_marked_pointers, cross_gen_pointers, pct);
-  PrintF("  rset_marked arrays %d, ", rset_marked_arrays);
-  PrintF("  elements %d, ", rset_marked_array_elements);
-  pct = rset_marked_array_elements == 0 ? 0
-           : cross_gen_array_elements * 100 / rset_marked_array_elements;
-  PrintF("  pointers to new space %d (%%%d)\n", cross_gen_array_elements, pct);
-  PrintF("  total rset-marked bits %d\n",
-            (rset_marked_pointers + rset_marked_arrays));
-  pct = (rset_marked_pointers + rset_marked_array_elements) == 0 ? 0
-        : (cross_gen_pointers + cross_gen_array_elements) * 100 /
-          (rset_marked_pointers + rset_marked_array_elements);
-  PrintF("  total rset pointers %d, true cross generation ones %d (%%%d)\n",
-         (rset_marked_pointers + rset_marked_array_elements),
-         (cross_gen_pointers + cross_gen_array_elements),
-         pct);
-
   ClearHistograms();
   HeapObjectIterator obj_it(this);
   for (HeapObject* obj = obj_it.next(); obj != NULL; obj = obj_it.next())
     CollectHistogramInfo(obj);
   ReportHistogram(true);
 }
-
-
-// Dump the range of remembered set words between [start, end) corresponding
-// to the pointers starting at object_p.  The allocation_top is an object
-// pointer which should not be read past.  This is important for large object
-// pages, where some bits in the remembered set range do not correspond to
-// allocated addresses.
-static void PrintRSetRange(Address start, Address end, Object** object_p,
-                           Address allocation_top) {
-  Address rset_address = start;
-
-  // If the range starts on on odd numbered word (eg, for large object extra
-  // remembered set ranges), print some spaces.
-  if ((reinterpret_cast<uintptr_t>(start) / kIntSize) % 2 == 1) {
-    PrintF("                                    ");
-  }
-
-  // Loop over all the words in the range.
-  while (rset_address < end) {
-    uint32_t rset_word = Memory::uint32_at(rset_address);
-    int bit_position = 0;
-
-    // Loop over all the bits in the word.
-    while (bit_position < kBitsPerInt) {
-      if (object_p == reinterpret_cast<Object**>(allocation_top)) {
-        // Print a bar at the allocation pointer.
-        PrintF("|");
-      } else if (object_p > reinterpret_cast<Object**>(allocation_top)) {
-        // Do not dereference object_p past the allocation pointer.
-        PrintF("#");
-      } else if ((rset_word & (1 << bit_position)) == 0) {
-        // Print a dot for zero bits.
-        PrintF(".");
-      } else if (Heap::InNewSpace(*object_p)) {
-        // Print an X for one bits for pointers to new space.
-        PrintF("X");
-      } else {
-        // Print a circle for one bits for pointers to old space.
-        PrintF("o");
-      }
-
-      // Print a space after every 8th bit except the last.
-      if (bit_position % 8 == 7 && bit_position != (kBitsPerInt - 1)) {
-        PrintF(" ");
-      }
-
-      // Advance to next bit.
-      bit_position++;
-      object_p++;
-    }
-
-    // Print a newline after every odd numbered word, otherwise a space.
-    if ((reinterpret_cast<uintptr_t>(rset_address) / kIntSize) % 2 == 1) {
-      PrintF("\n");
-    } else {
-      PrintF(" ");
-    }
-
-    // Advance to next remembered set word.
-    rset_address += kIntSize;
-  }
-}
-
-
-void PagedSpace::DoPrintRSet(const char* space_name) {
-  PageIterator it(this, PageIterator::PAGES_IN_USE);
-  while (it.has_next()) {
-    Page* p = it.next();
-    PrintF("%s page 0x%x:\n", space_name, p);
-    PrintRSetRange(p->RSetStart(), p->RSetEnd(),
-                   reinterpret_cast<Object**>(p->ObjectAreaStart()),
-                   p->AllocationTop());
-    PrintF("\n");
-  }
-}
-
-
-void OldSpace::PrintRSet() { DoPrintRSet("old"); }
 #endif
 
 // -----------------------------------------------------------------------------
@@ -2373,51 +2720,12 @@ void FixedSpace::ReportStatistics() {
   PrintF("  capacity: %d, waste: %d, available: %d, %%%d\n",
          Capacity(), Waste(), Available(), pct);
 
-  // Report remembered set statistics.
-  int rset_marked_pointers = 0;
-  int cross_gen_pointers = 0;
-
-  PageIterator page_it(this, PageIterator::PAGES_IN_USE);
-  while (page_it.has_next()) {
-    Page* p = page_it.next();
-
-    for (Address rset_addr = p->RSetStart();
-         rset_addr < p->RSetEnd();
-         rset_addr += kIntSize) {
-      int rset = Memory::int_at(rset_addr);
-      if (rset != 0) {
-        // Bits were set
-        int intoff =
-            static_cast<int>(rset_addr - p->address() - Page::kRSetOffset);
-        int bitoff = 0;
-        for (; bitoff < kBitsPerInt; ++bitoff) {
-          if ((rset & (1 << bitoff)) != 0) {
-            int bitpos = intoff*kBitsPerByte + bitoff;
-            Address slot = p->OffsetToAddress(bitpos << kObjectAlignmentBits);
-            Object** obj = reinterpret_cast<Object**>(slot);
-            rset_marked_pointers++;
-            if (Heap::InNewSpace(*obj))
-              cross_gen_pointers++;
-          }
-        }
-      }
-    }
-  }
-
-  pct = rset_marked_pointers == 0 ?
-          0 : cross_gen_pointers * 100 / rset_marked_pointers;
-  PrintF("  rset-marked pointers %d, to-new-space %d (%%%d)\n",
-            rset_marked_pointers, cross_gen_pointers, pct);
-
   ClearHistograms();
   HeapObjectIterator obj_it(this);
   for (HeapObject* obj = obj_it.next(); obj != NULL; obj = obj_it.next())
     CollectHistogramInfo(obj);
   ReportHistogram(false);
 }
-
-
-void FixedSpace::PrintRSet() { DoPrintRSet(name_); }
 #endif
 
 
@@ -2496,9 +2804,9 @@ LargeObjectChunk* LargeObjectChunk::New(int size_in_bytes,
                                         size_t* chunk_size,
                                         Executability executable) {
   size_t requested = ChunkSizeFor(size_in_bytes);
-  void* mem = MemoryAllocator::AllocateRawMemory(requested,
-                                                 chunk_size,
-                                                 executable);
+  void* mem = MemoryAllocator::AllocateLargeObjectMemory(requested,
+                                                         chunk_size,
+                                                         executable);
   if (mem == NULL) return NULL;
   LOG(NewEvent("LargeObjectChunk", mem, *chunk_size));
   if (*chunk_size < requested) {
@@ -2572,22 +2880,26 @@ void LargeObjectSpace::Unprotect() {
 #endif
 
 
-Object* LargeObjectSpace::AllocateRawInternal(int requested_size,
-                                              int object_size,
+Object* LargeObjectSpace::AllocateRawInternal(int size_in_bytes,
                                               Executability executable) {
-  ASSERT(0 < object_size && object_size <= requested_size);
+  ASSERT(0 < size_in_bytes);
 
   // Check if we want to force a GC before growing the old space further.
   // If so, fail the allocation.
   if (!Heap::always_allocate() && Heap::OldGenerationAllocationLimitReached()) {
-    return Failure::RetryAfterGC(requested_size, identity());
+    return Failure::RetryAfterGC(size_in_bytes, identity());
+  }
+
+  // Never grow the old generation past the embedder's hard limit.
+  if (size_in_bytes > Heap::OldGenerationHardLimitAvailable()) {
+    return Failure::RetryAfterGC(size_in_bytes, identity());
   }
 
   size_t chunk_size;
   LargeObjectChunk* chunk =
-      LargeObjectChunk::New(requested_size, &chunk_size, executable);
+      LargeObjectChunk::New(size_in_bytes, &chunk_size, executable);
   if (chunk == NULL) {
-    return Failure::RetryAfterGC(requested_size, identity());
+    return Failure::RetryAfterGC(size_in_bytes, identity());
   }
 
   size_ += static_cast<int>(chunk_size);
@@ -2596,8 +2908,7 @@ Object* LargeObjectSpace::AllocateRawInternal(int requested_size,
   chunk->set_size(chunk_size);
   first_chunk_ = chunk;
 
-  // Set the object address and size in the page header and clear its
-  // remembered set.
+  // Set the object address and size in the page header.
   Page* page = Page::FromAddress(RoundUp(chunk->address(), Page::kPageSize));
   Address object_address = page->ObjectAreaStart();
   // Clear the low order bit of the second word in the page to flag it as a
@@ -2605,12 +2916,6 @@ Object* LargeObjectSpace::AllocateRawInternal(int requested_size,
   // low order bit should already be clear.
   ASSERT((chunk_size & 0x1) == 0);
   page->is_normal_page &= ~0x1;
-  page->ClearRSet();
-  int extra_bytes = requested_size - object_size;
-  if (extra_bytes > 0) {
-    // The extra memory for the remembered set should be cleared.
-    memset(object_address + object_size, 0, extra_bytes);
-  }
 
   return HeapObject::FromAddress(object_address);
 }
@@ -2618,26 +2923,19 @@ Object* LargeObjectSpace::AllocateRawInternal(int requested_size,
 
 Object* LargeObjectSpace::AllocateRawCode(int size_in_bytes) {
   ASSERT(0 < size_in_bytes);
-  return AllocateRawInternal(size_in_bytes,
-                             size_in_bytes,
-                             EXECUTABLE);
+  return AllocateRawInternal(size_in_bytes, EXECUTABLE);
 }
 
 
 Object* LargeObjectSpace::AllocateRawFixedArray(int size_in_bytes) {
   ASSERT(0 < size_in_bytes);
-  int extra_rset_bytes = ExtraRSetBytesFor(size_in_bytes);
-  return AllocateRawInternal(size_in_bytes + extra_rset_bytes,
-                             size_in_bytes,
-                             NOT_EXECUTABLE);
+  return AllocateRawInternal(size_in_bytes, NOT_EXECUTABLE);
 }
 
 
 Object* LargeObjectSpace::AllocateRaw(int size_in_bytes) {
   ASSERT(0 < size_in_bytes);
-  return AllocateRawInternal(size_in_bytes,
-                             size_in_bytes,
-                             NOT_EXECUTABLE);
+  return AllocateRawInternal(size_in_bytes, NOT_EXECUTABLE);
 }
 
 
@@ -2655,64 +2953,6 @@ Object* LargeObjectSpace::FindObject(Address a) {
 }
 
 
-void LargeObjectSpace::ClearRSet() {
-  ASSERT(Page::is_rset_in_use());
-
-  LargeObjectIterator it(this);
-  for (HeapObject* object = it.next(); object != NULL; object = it.next()) {
-    // We only have code, sequential strings, or fixed arrays in large
-    // object space, and only fixed arrays need remembered set support.
-    if (object->IsFixedArray()) {
-      // Clear the normal remembered set region of the page;
-      Page* page = Page::FromAddress(object->address());
-      page->ClearRSet();
-
-      // Clear the extra remembered set.
-      int size = object->Size();
-      int extra_rset_bytes = ExtraRSetBytesFor(size);
-      memset(object->address() + size, 0, extra_rset_bytes);
-    }
-  }
-}
-
-
-void LargeObjectSpace::IterateRSet(ObjectSlotCallback copy_object_func) {
-  ASSERT(Page::is_rset_in_use());
-
-  static void* lo_rset_histogram = StatsTable::CreateHistogram(
-      "V8.RSetLO",
-      0,
-      // Keeping this histogram's buckets the same as the paged space histogram.
-      Page::kObjectAreaSize / kPointerSize,
-      30);
-
-  LargeObjectIterator it(this);
-  for (HeapObject* object = it.next(); object != NULL; object = it.next()) {
-    // We only have code, sequential strings, or fixed arrays in large
-    // object space, and only fixed arrays can possibly contain pointers to
-    // the young generation.
-    if (object->IsFixedArray()) {
-      // Iterate the normal page remembered set range.
-      Page* page = Page::FromAddress(object->address());
-      Address object_end = object->address() + object->Size();
-      int count = Heap::IterateRSetRange(page->ObjectAreaStart(),
-                                         Min(page->ObjectAreaEnd(), object_end),
-                                         page->RSetStart(),
-                                         copy_object_func);
-
-      // Iterate the extra array elements.
-      if (object_end > page->ObjectAreaEnd()) {
-        count += Heap::IterateRSetRange(page->ObjectAreaEnd(), object_end,
-                                        object_end, copy_object_func);
-      }
-      if (lo_rset_histogram != NULL) {
-        StatsTable::AddHistogramSample(lo_rset_histogram, count);
-      }
-    }
-  }
-}
-
-
 void LargeObjectSpace::FreeUnmarkedObjects() {
   LargeObjectChunk* previous = NULL;
   LargeObjectChunk* current = first_chunk_;
@@ -2736,10 +2976,14 @@ void LargeObjectSpace::FreeUnmarkedObjects() {
       }
 
       // Free the chunk.
+      Executability executable =
+          object->IsCode() ? EXECUTABLE : NOT_EXECUTABLE;
       MarkCompactCollector::ReportDeleteIfNeeded(object);
       size_ -= static_cast<int>(chunk_size);
       page_count_--;
-      MemoryAllocator::FreeRawMemory(chunk_address, chunk_size);
+      MemoryAllocator::FreeLargeObjectMemory(chunk_address,
+                                             chunk_size,
+                                             executable);
       LOG(DeleteEvent("LargeObjectChunk", chunk_address));
     }
   }
@@ -2793,22 +3037,10 @@ void LargeObjectSpace::Verify() {
                           object->Size(),
                           &code_visitor);
     } else if (object->IsFixedArray()) {
-      // We loop over fixed arrays ourselves, rather then using the visitor,
-      // because the visitor doesn't support the start/offset iteration
-      // needed for IsRSetSet.
-      FixedArray* array = FixedArray::cast(object);
-      for (int j = 0; j < array->length(); j++) {
-        Object* element = array->get(j);
-        if (element->IsHeapObject()) {
-          HeapObject* element_object = HeapObject::cast(element);
-          ASSERT(Heap::Contains(element_object));
-          ASSERT(element_object->map()->IsMap());
-          if (Heap::InNewSpace(element_object)) {
-            ASSERT(Page::IsRSetSet(object->address(),
-                                   FixedArray::kHeaderSize + j * kPointerSize));
-          }
-        }
-      }
+      VerifyPointersAndRSetVisitor rset_visitor;
+      object->IterateBody(map->instance_type(),
+                          object->Size(),
+                          &rset_visitor);
     }
   }
 }
@@ -2846,33 +3078,6 @@ void LargeObjectSpace::CollectCodeStatistics() {
     }
   }
 }
-
-
-void LargeObjectSpace::PrintRSet() {
-  LargeObjectIterator it(this);
-  for (HeapObject* object = it.next(); object != NULL; object = it.next()) {
-    if (object->IsFixedArray()) {
-      Page* page = Page::FromAddress(object->address());
-
-      Address allocation_top = object->address() + object->Size();
-      PrintF("large page 0x%x:\n", page);
-      PrintRSetRange(page->RSetStart(), page->RSetEnd(),
-                     reinterpret_cast<Object**>(object->address()),
-                     allocation_top);
-      int extra_array_bytes = object->Size() - Page::kObjectAreaSize;
-      int extra_rset_bits = RoundUp(extra_array_bytes / kPointerSize,
-                                    kBitsPerInt);
-      PrintF("------------------------------------------------------------"
-             "-----------\n");
-      PrintRSetRange(allocation_top,
-                     allocation_top + extra_rset_bits / kBitsPerByte,
-                     reinterpret_cast<Object**>(object->address()
-                                                + Page::kObjectAreaSize),
-                     allocation_top);
-      PrintF("\n");
-    }
-  }
-}
 #endif  // DEBUG
 
 } }  // namespace v8::internal
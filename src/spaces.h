@@ -51,16 +51,18 @@ namespace internal {
 // address of the next page and its ownership information. The second word may
 // have the allocation top address of this page. The next 248 bytes are
 // remembered sets. Heap objects are aligned to the pointer size (4 bytes). A
-// remembered set bit corresponds to a pointer in the object area.
+// remembered set bit corresponds to a pointer in the object area.  Pointers
+// from old objects into new space are not recorded in the remembered set
+// but in the store buffer (see store-buffer.h); the remembered sets of the
+// old data space hold the marks of the lazy sweeper.
 //
 // There is a separate large object space for objects larger than
 // Page::kMaxHeapObjectSize, so that they do not have to move during
-// collection.  The large object space is paged and uses the same remembered
-// set implementation.  Pages in large object space may be larger than 8K.
+// collection.  The large object space is paged.  Pages in large object space
+// may be larger than 8K.
 //
-// NOTE: The mark-compact collector rebuilds the remembered set after a
-// collection. It reuses first a few words of the remembered set for
-// bookkeeping relocation information.
+// NOTE: The mark-compact collector reuses first a few words of the
+// remembered set for bookkeeping relocation information.
 
 
 // Some assertion macros used in the debugging mode.
@@ -170,6 +172,21 @@ class Page {
   // True if this page is a large object page.
   bool IsLargeObjectPage() { return (is_normal_page & 0x1) == 0; }
 
+  // True if the live objects of this page are moved to other pages by the
+  // current mark-compact collection, see
+  // OldSpace::SelectEvacuationCandidates.  Only valid for addresses in
+  // paged spaces and in the first page of large object chunks.
+  bool IsEvacuationCandidate() { return (is_normal_page & 0x3) == 0x3; }
+
+  void SetIsEvacuationCandidate(bool is_candidate) {
+    ASSERT(!IsLargeObjectPage());
+    if (is_candidate) {
+      is_normal_page |= 0x2;
+    } else {
+      is_normal_page &= ~0x2;
+    }
+  }
+
   // Returns the offset of a given address to this page.
   INLINE(int Offset(Address a)) {
     int offset = static_cast<int>(a - address());
@@ -261,7 +278,8 @@ class Page {
   // second word is set. If the page is in the large object space, the
   // second word *may* (if the page start and large object chunk start are
   // the same) contain the large object chunk size.  In either case, the
-  // low-order bit for large object pages will be cleared.
+  // low-order bit for large object pages will be cleared.  The next bit
+  // of a normal page is set while it is an evacuation candidate.
   int is_normal_page;
 
   // The following fields may overlap with remembered set, they can only
@@ -478,6 +496,35 @@ class MemoryAllocator : public AllStatic {
                                  Executability executable);
   static void FreeRawMemory(void* buf, size_t length);
 
+  // Returns whether the heap is grown in chunks that are aligned to and a
+  // multiple of the huge page size, so that the OS can back them with
+  // transparent huge pages (--transparent_huge_pages).
+  static bool UseHugePages();
+
+  // Returns the number of pages a paged space is grown by at a time.
+  static int PagesPerChunk();
+
+  // Allocates and frees the raw memory of large object chunks.  Freed
+  // non-executable chunks are kept mapped in a cache of size classes, up to
+  // --large_object_cache_size, and handed out again to requests of about the
+  // same size.  Cached chunks do not count as allocated memory.
+  static void* AllocateLargeObjectMemory(const size_t requested,
+                                         size_t* allocated,
+                                         Executability executable);
+  static void FreeLargeObjectMemory(void* buf,
+                                    size_t length,
+                                    Executability executable);
+
+  // Gives the physical pages of the cached large object chunks back to the
+  // OS.  The chunks stay in the cache and are faulted in again on reuse.
+  static void ReleaseLargeObjectCache();
+
+  // Unmaps all cached large object chunks.
+  static void FlushLargeObjectCache();
+
+  // Returns the size in bytes of the cached large object chunks.
+  static int LargeObjectCacheSize() { return large_object_cache_size_; }
+
   // Returns the maximum available bytes of heaps.
   static int Available() { return capacity_ < size_ ? 0 : capacity_ - size_; }
 
@@ -561,6 +608,29 @@ class MemoryAllocator : public AllStatic {
     PagedSpace* owner_;
   };
 
+  // A cached large object chunk.  Released chunks have given their
+  // physical pages back to the OS.
+  struct CachedChunk {
+    Address address;
+    size_t size;
+    bool released;
+  };
+
+  // Cached large object chunks, by size class.  Class i holds the chunks
+  // whose size in pages has its most significant bit at position i.
+  static const int kLargeObjectCacheClasses = 20;
+  static List<CachedChunk> large_object_cache_[kLargeObjectCacheClasses];
+  static int large_object_cache_size_;
+
+  // Returns the size class of a chunk of the given size.
+  static int LargeObjectCacheClass(size_t size);
+
+  // Allocates raw memory aligned to the huge page size.  The requested size
+  // must be a multiple of the huge page size.
+  static void* AllocateHugePageAlignedMemory(const size_t requested,
+                                             size_t* allocated,
+                                             Executability executable);
+
   // Chunks_, free_chunk_ids_ and top_ act as a stack of free chunk ids.
   static List<ChunkInfo> chunks_;
   static List<int> free_chunk_ids_;
@@ -593,6 +663,9 @@ class MemoryAllocator : public AllStatic {
   // used as a marking stack and its page headers are destroyed.
   static Page* InitializePagesInChunk(int chunk_id, int pages_in_chunk,
                                       PagedSpace* owner);
+
+  // Incremental marking keeps its side mark bitmaps per chunk.
+  friend class IncrementalMarking;
 };
 
 
@@ -914,6 +987,15 @@ class PagedSpace : public Space {
   // Used by ReserveSpace.
   virtual void PutRestOfCurrentPageOnFreeList(Page* current_page) = 0;
 
+  // Sweeps the pages left unswept by the last mark-compact collection, so
+  // that the space only contains live objects and free blocks.  Only old
+  // spaces are swept lazily.
+  virtual void EnsureSweepingCompleted() { }
+
+  // Gives the unused part of the allocation buffer back to the space, so
+  // that it can be iterated.  Only old spaces have allocation buffers.
+  virtual void FreeAllocationBuffer() { }
+
   // ---------------------------------------------------------------------------
   // Mark-compact collection support functions
 
@@ -1033,8 +1115,6 @@ class PagedSpace : public Space {
 #ifdef DEBUG
   // Returns the number of total pages in this space.
   int CountTotalPages();
-
-  void DoPrintRSet(const char* space_name);
 #endif
  private:
   // Returns the page of the allocation pointer.
@@ -1257,7 +1337,12 @@ class SemiSpaceIterator : public ObjectIterator {
 class NewSpace : public Space {
  public:
   // Constructor.
-  NewSpace() : Space(NEW_SPACE, NOT_EXECUTABLE) {}
+  NewSpace()
+      : Space(NEW_SPACE, NOT_EXECUTABLE),
+        inline_allocation_limit_step_(0),
+        top_on_previous_step_(NULL),
+        allocated_since_previous_step_(0),
+        allocation_steps_suspended_(false) {}
 
   // Sets up the new space using the given chunk.
   bool Setup(Address start, int size);
@@ -1281,6 +1366,10 @@ class NewSpace : public Space {
   // Shrink the capacity of the semispaces.
   void Shrink();
 
+  // Shrink the capacity of the semispaces to new_capacity, or to as close
+  // to it as the initial capacity and the objects in to space allow.
+  void ShrinkTo(int new_capacity);
+
   // True if the address or object lies in the address range of either
   // semispace (not necessarily below the allocation pointer).
   bool Contains(Address a) {
@@ -1350,6 +1439,18 @@ class NewSpace : public Space {
     return AllocateRawInternal(size_in_bytes, &mc_forwarding_info_);
   }
 
+  // Allocation steps.  With a non-zero step the allocation limit is lowered
+  // so that AllocateRaw takes its slow path each time another 'step' bytes
+  // have been allocated, and the allocation sampler takes a sample there.
+  // Generated code, which allocates inline up to the limit, then falls into
+  // the runtime.  A step of zero turns the steps off.
+  void LowerInlineAllocationLimit(int step);
+
+  // The collectors suspend the steps while they move objects into the
+  // space.  The bytes allocated since the previous step carry over.
+  void SuspendAllocationSteps();
+  void ResumeAllocationSteps();
+
   // Reset the allocation pointer to the beginning of the active semispace.
   void ResetAllocationInfo();
   // Reset the reloction pointer to the bottom of the inactive semispace in
@@ -1447,10 +1548,24 @@ class NewSpace : public Space {
   HistogramInfo* promoted_histogram_;
 #endif
 
+  // Allocation steps, see LowerInlineAllocationLimit.
+  int inline_allocation_limit_step_;
+  Address top_on_previous_step_;
+  int allocated_since_previous_step_;  // Only while suspended.
+  bool allocation_steps_suspended_;
+
   // Implementation of AllocateRaw and MCAllocateRaw.
   inline Object* AllocateRawInternal(int size_in_bytes,
                                      AllocationInfo* alloc_info);
 
+  // Slow path of AllocateRaw, taken when the allocation does not fit below
+  // the allocation limit.
+  Object* SlowAllocateRaw(int size_in_bytes);
+
+  // Sets the allocation limit to the next allocation step, or to the end of
+  // the active semispace if the steps are off or suspended.
+  void UpdateAllocationLimit();
+
   friend class SemiSpaceIterator;
 
  public:
@@ -1512,6 +1627,18 @@ class OldSpaceFreeList BASE_EMBEDDED {
   // aligned, and the size should be a non-zero multiple of the word size.
   int Free(Address start, int size_in_bytes);
 
+  // Takes a whole block of at least 'size_in_bytes' off the free list,
+  // preferring blocks of at least 'preferred_size_in_bytes'.  The size of
+  // the block is returned in 'block_size'.  A failure is returned if no
+  // block is large enough.
+  Object* AllocateBlock(int size_in_bytes,
+                        int preferred_size_in_bytes,
+                        int* block_size);
+
+  // Adds the size of every block on the free list to the entry of
+  // 'free_bytes' indexed by the mc_page_index of the block's page.
+  void CountFreeBytesPerPage(int* free_bytes);
+
   // Allocate a block of size 'size_in_bytes' from the free list.  The block
   // is unitialized.  A failure is returned if no block is available.  The
   // number of bytes lost to fragmentation is returned in the output parameter
@@ -1644,8 +1771,13 @@ class OldSpace : public PagedSpace {
   explicit OldSpace(int max_capacity,
                     AllocationSpace id,
                     Executability executable)
-      : PagedSpace(max_capacity, id, executable), free_list_(id) {
+      : PagedSpace(max_capacity, id, executable),
+        free_list_(id),
+        first_unswept_page_(Page::FromAddress(NULL)),
+        last_unswept_page_(Page::FromAddress(NULL)) {
     page_extra_ = 0;
+    allocation_buffer_.top = NULL;
+    allocation_buffer_.limit = NULL;
   }
 
   // The bytes available on the free list (ie, not above the linear allocation
@@ -1675,11 +1807,58 @@ class OldSpace : public PagedSpace {
 
   virtual void PutRestOfCurrentPageOnFreeList(Page* current_page);
 
+  // Lazy sweeping, for spaces without remembered sets.  During a
+  // non-compacting collection the mark-compact collector records the start
+  // of every live object in the remembered set area of its page.  Only the
+  // live objects are visited when the collection finishes: the callback
+  // must clear their mark bits and return their sizes.  The dead objects
+  // stay in place and the pages below the top page are swept, i.e. have
+  // their free blocks put on the free list, when the free list runs dry.
+  void StartLazySweeping(HeapObjectCallback unmark_live_object);
+
+  // Sweeps the next unswept page.  Returns false if there is none left.
+  bool SweepNextPage();
+
+  bool IsSweepingComplete() { return !first_unswept_page_->is_valid(); }
+
+  // The number of pages still to be swept lazily.
+  int CountUnsweptPages();
+
+  virtual void EnsureSweepingCompleted();
+
+  // Allocation buffer.  Objects allocated by the mutator are bump allocated
+  // in a buffer that takes the rest of the top page or a whole free list
+  // block at once, instead of going to the free list for each object once
+  // the top page is full.  Generated code allocates in the buffer of the
+  // old pointer space directly.  The unused part of the buffer is not a
+  // valid object, so the buffer is given back before the heap is iterated
+  // or collected.  Objects allocated during GC bypass the buffer.
+  inline Object* AllocateRawInBuffer(int size_in_bytes);
+
+  virtual void FreeAllocationBuffer();
+
+  Address* allocation_buffer_top_address() { return &allocation_buffer_.top; }
+  Address* allocation_buffer_limit_address() {
+    return &allocation_buffer_.limit;
+  }
+
+  // Objects larger than this are not allocated in the buffer.
+  static const int kMaxBufferedObjectSize = 1 * KB;
+
+  // The buffer is preferably refilled from free list blocks of this size.
+  static const int kAllocationBufferSize = 4 * KB;
+
+  // Selective evacuation.  Before a non-compacting mark-compact collection
+  // the pages with the most bytes on the free list, at most 'max_pages' of
+  // them, are flagged as evacuation candidates.  Only pages that are at
+  // least half free qualify, and the page holding the allocation top never
+  // does.  Must be called before the free list is cleared.  Returns the
+  // number of candidates.
+  int SelectEvacuationCandidates(int max_pages);
+
 #ifdef DEBUG
   // Reports statistics for the space
   void ReportStatistics();
-  // Dump the remembered sets in the space to stdout.
-  void PrintRSet();
 #endif
 
  protected:
@@ -1691,9 +1870,24 @@ class OldSpace : public PagedSpace {
   HeapObject* AllocateInNextPage(Page* current_page, int size_in_bytes);
 
  private:
+  // Puts the gaps between the live objects recorded in the remembered set
+  // area of a page on the free list and clears the remembered set area.
+  void SweepPage(Page* p);
+
+  // Slow path of AllocateRawInBuffer.
+  Object* RefillAllocationBuffer(int size_in_bytes);
+
   // The space's free list.
   OldSpaceFreeList free_list_;
 
+  // The allocation buffer, empty if top == limit.
+  AllocationInfo allocation_buffer_;
+
+  // The range of pages, in page order, still to be swept lazily.  Both are
+  // invalid when sweeping is complete.
+  Page* first_unswept_page_;
+  Page* last_unswept_page_;
+
  public:
   TRACK_MEMORY("OldSpace")
 };
@@ -1741,9 +1935,6 @@ class FixedSpace : public PagedSpace {
 #ifdef DEBUG
   // Reports statistic info of the space
   void ReportStatistics();
-
-  // Dump the remembered sets in the space to stdout.
-  void PrintRSet();
 #endif
 
  protected:
@@ -1996,12 +2187,6 @@ class LargeObjectSpace : public Space {
   // space, may be slow.
   Object* FindObject(Address a);
 
-  // Clears remembered sets.
-  void ClearRSet();
-
-  // Iterates objects whose remembered set bits are set.
-  void IterateRSet(ObjectSlotCallback func);
-
   // Frees unmarked objects.
   void FreeUnmarkedObjects();
 
@@ -2027,8 +2212,6 @@ class LargeObjectSpace : public Space {
   virtual void Print();
   void ReportStatistics();
   void CollectCodeStatistics();
-  // Dump the remembered sets in the space to stdout.
-  void PrintRSet();
 #endif
   // Checks whether an address is in the object area in this space.  It
   // iterates all objects in the space. May be slow.
@@ -2043,13 +2226,7 @@ class LargeObjectSpace : public Space {
 
   // Shared implementation of AllocateRaw, AllocateRawCode and
   // AllocateRawFixedArray.
-  Object* AllocateRawInternal(int requested_size,
-                              int object_size,
-                              Executability executable);
-
-  // Returns the number of extra bytes (rounded up to the nearest full word)
-  // required for extra_object_bytes of extra pointers (in bytes).
-  static inline int ExtraRSetBytesFor(int extra_object_bytes);
+  Object* AllocateRawInternal(int size_in_bytes, Executability executable);
 
   friend class LargeObjectIterator;
 
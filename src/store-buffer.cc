@@ -0,0 +1,142 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "v8.h"
+
+#include "store-buffer.h"
+
+namespace v8 {
+namespace internal {
+
+// The number of slots the buffer holds initially.
+static const int kInitialCapacity = 16 * KB;
+
+Address* StoreBuffer::start_ = NULL;
+Address* StoreBuffer::top_ = NULL;
+Address* StoreBuffer::limit_ = NULL;
+
+
+bool StoreBuffer::Setup() {
+  start_ = NewArray<Address>(kInitialCapacity);
+  top_ = start_;
+  limit_ = start_ + kInitialCapacity;
+  return true;
+}
+
+
+void StoreBuffer::TearDown() {
+  DeleteArray(start_);
+  start_ = top_ = limit_ = NULL;
+}
+
+
+void StoreBuffer::Compact() {
+  Counters::store_buffer_compactions.Increment();
+  Vector<Address>(start_, Size()).Sort();
+  Address* write = start_;
+  Address previous = NULL;
+  for (Address* read = start_; read < top_; read++) {
+    Address slot = *read;
+    if (slot == previous) continue;
+    previous = slot;
+    // Cell values are visited by the scavenger directly.
+    Object** p = reinterpret_cast<Object**>(slot);
+    if (Heap::InNewSpace(*p) && !Heap::cell_space()->Contains(slot)) {
+      *write++ = slot;
+    } else {
+      IncrementalMarking::RecordSlot(p);
+    }
+  }
+  top_ = write;
+  if (Size() > (limit_ - start_) / 2) Grow();
+}
+
+
+void StoreBuffer::Grow() {
+  int capacity = static_cast<int>(limit_ - start_) * 2;
+  int size = Size();
+  Address* start = NewArray<Address>(capacity);
+  memcpy(start, start_, size * sizeof(*start));
+  DeleteArray(start_);
+  start_ = start;
+  top_ = start + size;
+  limit_ = start + capacity;
+}
+
+
+void StoreBuffer::Iterate(ObjectSlotCallback callback) {
+  List<Address> slots(Size());
+  TakeSlots(&slots);
+  for (int i = 0; i < slots.length(); i++) {
+    // Compaction has dropped the slots not pointing into new space.
+    Object** p = reinterpret_cast<Object**>(slots[i]);
+    callback(reinterpret_cast<HeapObject**>(p));
+    if (Heap::InNewSpace(*p)) {
+      Mark(slots[i]);
+    } else {
+      IncrementalMarking::RecordSlot(p);
+    }
+  }
+}
+
+
+void StoreBuffer::TakeSlots(List<Address>* slots) {
+  Compact();
+  for (Address* current = start_; current < top_; current++) {
+    slots->Add(*current);
+  }
+  Clear();
+}
+
+
+#ifdef DEBUG
+bool StoreBuffer::Contains(Address slot) {
+  Address* low = start_;
+  Address* high = top_;
+  while (low < high) {
+    Address* middle = low + (high - low) / 2;
+    if (*middle < slot) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low < top_ && *low == slot;
+}
+
+
+void StoreBuffer::Print() {
+  PrintF("store buffer: %d slots\n", Size());
+  for (Address* current = start_; current < top_; current++) {
+    Object** p = reinterpret_cast<Object**>(*current);
+    PrintF("  %p: %p\n", reinterpret_cast<void*>(p),
+           reinterpret_cast<void*>(*p));
+  }
+}
+#endif
+
+} }  // namespace v8::internal
@@ -0,0 +1,106 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef V8_STORE_BUFFER_H_
+#define V8_STORE_BUFFER_H_
+
+namespace v8 {
+namespace internal {
+
+// -------------------------------------------------------------------------
+// Store buffer
+//
+// The store buffer is the remembered set of the scavenger.  It holds the
+// addresses of the slots outside new space that may contain pointers into
+// new space.  The write barrier, both in Heap::RecordWrite and in generated
+// code, appends the address of every slot written to the end of the
+// buffer.  When the buffer is full it is compacted: the slots are sorted,
+// duplicates are removed and slots that no longer point into new space are
+// dropped.  The buffer is grown if compaction leaves it more than half
+// full.  Scavenges only visit the recorded slots, so their cost depends on
+// the number of slots written since the last collection rather than on the
+// size of the old generation.
+//
+// The values of dropped slots are passed to IncrementalMarking::RecordSlot
+// first, so the store buffer also serves as the write barrier of
+// incremental marking.  The mark-compact collector rebuilds the buffer from
+// the live objects after every full collection.  All methods are static.
+class StoreBuffer : public AllStatic {
+ public:
+  static bool Setup();
+  static void TearDown();
+
+  // Records a write to the given slot, which is outside new space.
+  static inline void Mark(Address slot) {
+    *top_++ = slot;
+    if (top_ == limit_) Compact();
+  }
+
+  // Sorts the slots, removes duplicates and drops the slots that do not
+  // point into new space.  Also called by generated code when the buffer is
+  // full.
+  static void Compact();
+
+  // Removes all slots.
+  static void Clear() { top_ = start_; }
+
+  // Calls the callback for every slot pointing into new space.  Afterwards
+  // only the slots still pointing into new space and the slots recorded by
+  // the callback are kept.
+  static void Iterate(ObjectSlotCallback callback);
+
+  // Compacts the buffer and moves its slots to the given list.  The buffer
+  // is empty afterwards.
+  static void TakeSlots(List<Address>* slots);
+
+  // The number of slots in the buffer, including duplicates.
+  static int Size() { return static_cast<int>(top_ - start_); }
+
+  // Generated code appends to the buffer through these addresses.
+  static Address** top_address() { return &top_; }
+  static Address** limit_address() { return &limit_; }
+
+#ifdef DEBUG
+  // Returns whether the slot is in the buffer.  Only valid right after
+  // Compact().
+  static bool Contains(Address slot);
+
+  static void Print();
+#endif
+
+ private:
+  // Reallocates the buffer with twice its capacity.
+  static void Grow();
+
+  static Address* start_;
+  static Address* top_;
+  static Address* limit_;
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_STORE_BUFFER_H_
@@ -0,0 +1,189 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "v8.h"
+
+#include "macro-assembler.h"
+#include "string-kernels.h"
+
+#ifdef V8_SSE2_STRING_KERNELS
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace v8 {
+namespace internal {
+
+bool StringKernels::use_sse2_ = false;
+
+
+void StringKernels::Setup() {
+#ifdef V8_SSE2_STRING_KERNELS
+  use_sse2_ = CpuFeatures::IsSupported(SSE2);
+#endif
+}
+
+
+#ifdef V8_SSE2_STRING_KERNELS
+
+// The kernels below process the input in blocks of 16 bytes with unaligned
+// loads.  The last block is loaded so that it ends with the input, which
+// makes it overlap the block before it unless the length is a multiple of
+// the block size.  The overlapping characters have already been found not
+// to be interesting, so no scalar loop is needed for the tail.  This
+// requires inputs of at least one block.
+static const int kBlockSize = sizeof(__m128i);  // NOLINT
+
+
+static inline __m128i LoadBlock(const void* address) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(address));
+}
+
+
+// Index of the lowest set bit of a non-zero mask.
+static inline int LowestSetBit(int mask) {
+  ASSERT(mask != 0);
+#ifdef _MSC_VER
+  unsigned long index;  // NOLINT
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+
+// Returns the index of the first character flagged by match, or -1.  The
+// call match(i) returns the byte mask of the flagged characters in the
+// block starting at chars + i.
+template <typename Char, typename Match>
+static inline int FindInBlocks(const Char* chars, int length, Match match) {
+  static const int kCharSize = sizeof(Char);  // NOLINT
+  static const int kBlockLength = kBlockSize / kCharSize;
+  ASSERT(length >= kBlockLength);
+  int i = 0;
+  for (; i <= length - kBlockLength; i += kBlockLength) {
+    int mask = match(i);
+    if (mask != 0) return i + LowestSetBit(mask) / kCharSize;
+  }
+  if (i < length) {
+    i = length - kBlockLength;
+    int mask = match(i);
+    if (mask != 0) return i + LowestSetBit(mask) / kCharSize;
+  }
+  return -1;
+}
+
+
+class MatchWord {
+ public:
+  MatchWord(const uc16* chars, uc16 c)
+      : chars_(chars), pattern_(_mm_set1_epi16(static_cast<int16_t>(c))) { }
+  int operator()(int i) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(LoadBlock(chars_ + i), pattern_));
+  }
+ private:
+  const uc16* chars_;
+  __m128i pattern_;
+};
+
+
+template <typename Char>
+class MatchDifference {
+ public:
+  MatchDifference(const Char* a, const Char* b) : a_(a), b_(b) { }
+  int operator()(int i) const {
+    __m128i equal = _mm_cmpeq_epi8(LoadBlock(a_ + i), LoadBlock(b_ + i));
+    return _mm_movemask_epi8(equal) ^ 0xFFFF;
+  }
+ private:
+  const Char* a_;
+  const Char* b_;
+};
+
+
+class MatchNonAsciiByte {
+ public:
+  explicit MatchNonAsciiByte(const char* chars) : chars_(chars) { }
+  int operator()(int i) const {
+    return _mm_movemask_epi8(LoadBlock(chars_ + i));
+  }
+ private:
+  const char* chars_;
+};
+
+
+class MatchNonAsciiWord {
+ public:
+  explicit MatchNonAsciiWord(const uc16* chars)
+      : chars_(chars),
+        non_ascii_bits_(_mm_set1_epi16(
+            static_cast<int16_t>(~String::kMaxAsciiCharCodeU))),
+        zero_(_mm_setzero_si128()) { }
+  int operator()(int i) const {
+    __m128i bits = _mm_and_si128(LoadBlock(chars_ + i), non_ascii_bits_);
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero_)) ^ 0xFFFF;
+  }
+ private:
+  const uc16* chars_;
+  __m128i non_ascii_bits_;
+  __m128i zero_;
+};
+
+
+int StringKernels::IndexOfSSE2(const uc16* chars, int length, uc16 c) {
+  return FindInBlocks(chars, length, MatchWord(chars, c));
+}
+
+
+int StringKernels::MismatchSSE2(const char* a, const char* b, int length) {
+  int i = FindInBlocks(a, length, MatchDifference<char>(a, b));
+  return (i < 0) ? length : i;
+}
+
+
+int StringKernels::MismatchSSE2(const uc16* a, const uc16* b, int length) {
+  int i = FindInBlocks(a, length, MatchDifference<uc16>(a, b));
+  return (i < 0) ? length : i;
+}
+
+
+bool StringKernels::IsAsciiSSE2(const char* chars, int length) {
+  return FindInBlocks(chars, length, MatchNonAsciiByte(chars)) < 0;
+}
+
+
+bool StringKernels::IsAsciiSSE2(const uc16* chars, int length) {
+  return FindInBlocks(chars, length, MatchNonAsciiWord(chars)) < 0;
+}
+
+#endif  // V8_SSE2_STRING_KERNELS
+
+} }  // namespace v8::internal
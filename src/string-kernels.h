@@ -0,0 +1,234 @@
+// Copyright 2010 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef V8_STRING_KERNELS_H_
+#define V8_STRING_KERNELS_H_
+
+// The SSE2 kernels are compiled in when the host compiler can emit SSE2
+// instructions and the target has CpuFeatures that can tell whether the
+// processor running the code supports them.
+#if (defined(V8_HOST_ARCH_IA32) || defined(V8_HOST_ARCH_X64)) &&     \
+    (defined(V8_TARGET_ARCH_IA32) || defined(V8_TARGET_ARCH_X64)) && \
+    (defined(__SSE2__) || defined(_M_X64) ||                         \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define V8_SSE2_STRING_KERNELS 1
+#endif
+
+namespace v8 {
+namespace internal {
+
+// Kernels for scanning and comparing the characters of flat strings.  The
+// dispatching functions use the SSE2 versions when the processor supports
+// them and the input is long enough to amortize the setup, and the generic
+// versions otherwise.
+class StringKernels : public AllStatic {
+ public:
+  // Select the kernels for the processor.  Must be called after the
+  // processor features have been probed.
+  static void Setup();
+
+  static bool use_sse2() { return use_sse2_; }
+
+  // Returns the index of the first occurrence of c in chars[0..length), or
+  // -1 if there is none.
+  static inline int IndexOf(const char* chars, int length, char c);
+  static inline int IndexOf(const uc16* chars, int length, uc16 c);
+
+  // Returns the index of the first character where a and b differ, or
+  // length if they are equal.
+  static inline int Mismatch(const char* a, const char* b, int length);
+  static inline int Mismatch(const uc16* a, const uc16* b, int length);
+
+  // Returns whether all characters are ASCII.
+  static inline bool IsAscii(const char* chars, int length);
+  static inline bool IsAscii(const uc16* chars, int length);
+
+  // Compares like CompareChars: the result is negative, zero or positive
+  // when a is less than, equal to or greater than b.
+  static inline int Compare(const char* a, const char* b, int length);
+  static inline int Compare(const uc16* a, const uc16* b, int length);
+  template <typename lchar, typename rchar>
+  static inline int Compare(const lchar* a, const rchar* b, int length) {
+    return CompareChars(a, b, length);
+  }
+
+  // Portable versions of the kernels.
+  static inline int IndexOfGeneric(const char* chars, int length, char c);
+  static inline int IndexOfGeneric(const uc16* chars, int length, uc16 c);
+  template <typename Char>
+  static inline int MismatchGeneric(const Char* a, const Char* b, int length);
+  template <typename Char>
+  static inline bool IsAsciiGeneric(const Char* chars, int length);
+
+#ifdef V8_SSE2_STRING_KERNELS
+  // SSE2 versions of the kernels.  Only to be called when use_sse2() is
+  // true.
+  static int IndexOfSSE2(const uc16* chars, int length, uc16 c);
+  static int MismatchSSE2(const char* a, const char* b, int length);
+  static int MismatchSSE2(const uc16* a, const uc16* b, int length);
+  static bool IsAsciiSSE2(const char* chars, int length);
+  static bool IsAsciiSSE2(const uc16* chars, int length);
+#endif
+
+  // Inputs shorter than this are handled by the generic versions.
+  static const int kMinSSE2Length = 16;
+
+ private:
+  static bool use_sse2_;
+};
+
+
+int StringKernels::IndexOfGeneric(const char* chars, int length, char c) {
+  const void* pos = memchr(chars, c, static_cast<size_t>(length));
+  if (pos == NULL) return -1;
+  return static_cast<int>(reinterpret_cast<const char*>(pos) - chars);
+}
+
+
+int StringKernels::IndexOfGeneric(const uc16* chars, int length, uc16 c) {
+  for (int i = 0; i < length; i++) {
+    if (chars[i] == c) return i;
+  }
+  return -1;
+}
+
+
+template <typename Char>
+int StringKernels::MismatchGeneric(const Char* a, const Char* b, int length) {
+  int i = 0;
+#ifndef V8_HOST_CAN_READ_UNALIGNED
+  // If this architecture isn't comfortable reading unaligned words then
+  // the strings are only compared blockwise if they are both aligned.
+  static const uintptr_t kAlignmentMask = sizeof(uintptr_t) - 1;  // NOLINT
+  if (((reinterpret_cast<uintptr_t>(a) | reinterpret_cast<uintptr_t>(b)) &
+       kAlignmentMask) == 0) {
+#endif
+    // Number of characters in a uintptr_t.
+    static const int kStepSize = sizeof(uintptr_t) / sizeof(Char);  // NOLINT
+    while (i <= length - kStepSize) {
+      if (*reinterpret_cast<const uintptr_t*>(a + i) !=
+          *reinterpret_cast<const uintptr_t*>(b + i)) {
+        break;
+      }
+      i += kStepSize;
+    }
+#ifndef V8_HOST_CAN_READ_UNALIGNED
+  }
+#endif
+  while (i < length && a[i] == b[i]) i++;
+  return i;
+}
+
+
+template <typename Char>
+bool StringKernels::IsAsciiGeneric(const Char* chars, int length) {
+  int i = 0;
+#ifdef V8_HOST_CAN_READ_UNALIGNED
+  // Number of characters in a uintptr_t and the bits that are set in a
+  // uintptr_t holding a non-ASCII character.
+  static const int kStepSize = sizeof(uintptr_t) / sizeof(Char);  // NOLINT
+  static const uintptr_t kNonAsciiMask = (sizeof(Char) == 1)
+      ? static_cast<uintptr_t>(V8_UINT64_C(0x8080808080808080))
+      : static_cast<uintptr_t>(V8_UINT64_C(0xFF80FF80FF80FF80));
+  while (i <= length - kStepSize) {
+    if ((*reinterpret_cast<const uintptr_t*>(chars + i) & kNonAsciiMask)
+        != 0) {
+      return false;
+    }
+    i += kStepSize;
+  }
+#endif
+  for (; i < length; i++) {
+    if ((static_cast<unsigned>(chars[i]) & ~String::kMaxAsciiCharCodeU) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+#ifdef V8_SSE2_STRING_KERNELS
+#define STRING_KERNEL_DISPATCH(name, length, args)               \
+  if (use_sse2_ && (length) >= kMinSSE2Length) return name##SSE2 args; \
+  return name##Generic args;
+#else
+#define STRING_KERNEL_DISPATCH(name, length, args)               \
+  return name##Generic args;
+#endif
+
+
+int StringKernels::IndexOf(const char* chars, int length, char c) {
+  // The C library's memchr is already vectorized.
+  return IndexOfGeneric(chars, length, c);
+}
+
+
+int StringKernels::IndexOf(const uc16* chars, int length, uc16 c) {
+  STRING_KERNEL_DISPATCH(IndexOf, length, (chars, length, c))
+}
+
+
+int StringKernels::Mismatch(const char* a, const char* b, int length) {
+  STRING_KERNEL_DISPATCH(Mismatch, length, (a, b, length))
+}
+
+
+int StringKernels::Mismatch(const uc16* a, const uc16* b, int length) {
+  STRING_KERNEL_DISPATCH(Mismatch, length, (a, b, length))
+}
+
+
+bool StringKernels::IsAscii(const char* chars, int length) {
+  STRING_KERNEL_DISPATCH(IsAscii, length, (chars, length))
+}
+
+
+bool StringKernels::IsAscii(const uc16* chars, int length) {
+  STRING_KERNEL_DISPATCH(IsAscii, length, (chars, length))
+}
+
+#undef STRING_KERNEL_DISPATCH
+
+
+int StringKernels::Compare(const char* a, const char* b, int length) {
+  int i = Mismatch(a, b, length);
+  if (i == length) return 0;
+  return static_cast<int>(static_cast<unsigned char>(a[i])) -
+         static_cast<int>(static_cast<unsigned char>(b[i]));
+}
+
+
+int StringKernels::Compare(const uc16* a, const uc16* b, int length) {
+  int i = Mismatch(a, b, length);
+  if (i == length) return 0;
+  return static_cast<int>(a[i]) - static_cast<int>(b[i]);
+}
+
+} }  // namespace v8::internal
+
+#endif  // V8_STRING_KERNELS_H_
@@ -38,6 +38,7 @@ namespace internal {
   HT(gc_compactor, V8.GCCompactor)                                    \
   HT(gc_scavenger, V8.GCScavenger)                                    \
   HT(gc_context, V8.GCContext) /* GC context cleanup time */          \
+  HT(gc_incremental_marking, V8.GCIncrementalMarking)                 \
   /* Parsing timers. */                                               \
   HT(parse, V8.Parse)                                                 \
   HT(parse_lazy, V8.ParseLazy)                                        \
@@ -67,11 +68,15 @@ namespace internal {
   SC(pcre_mallocs, V8.PcreMallocCount)                                \
   /* OS Memory allocated */                                           \
   SC(memory_allocated, V8.OsMemoryAllocated)                          \
+  /* Large object chunk cache */                                      \
+  SC(large_object_cache_hits, V8.LargeObjectCacheHits)                \
+  SC(large_object_cache_misses, V8.LargeObjectCacheMisses)            \
   SC(props_to_dictionary, V8.ObjectPropertiesToDictionary)            \
   SC(elements_to_dictionary, V8.ObjectElementsToDictionary)           \
   SC(alive_after_last_gc, V8.AliveAfterLastGC)                        \
   SC(objs_since_last_young, V8.ObjsSinceLastYoung)                    \
   SC(objs_since_last_full, V8.ObjsSinceLastFull)                      \
+  SC(store_buffer_compactions, V8.StoreBufferCompactions)             \
   SC(symbol_table_capacity, V8.SymbolTableCapacity)                   \
   SC(number_of_symbols, V8.NumberOfSymbols)                           \
   SC(script_wrappers, V8.ScriptWrappers)                              \
@@ -114,12 +119,16 @@ namespace internal {
      V8.GCCompactorCausedByOldspaceExhaustion)                        \
   SC(gc_compactor_caused_by_weak_handles,                             \
      V8.GCCompactorCausedByWeakHandles)                               \
+  SC(gc_compactor_caused_by_incremental_marking,                      \
+     V8.GCCompactorCausedByIncrementalMarking)                        \
+  SC(gc_pages_swept_lazily, V8.GCPagesSweptLazily)                    \
   SC(gc_last_resort_from_js, V8.GCLastResortFromJS)                   \
   SC(gc_last_resort_from_handles, V8.GCLastResortFromHandles)         \
   /* How is the generic keyed-load stub used? */                      \
   SC(keyed_load_generic_smi, V8.KeyedLoadGenericSmi)                  \
   SC(keyed_load_generic_symbol, V8.KeyedLoadGenericSymbol)            \
   SC(keyed_load_generic_slow, V8.KeyedLoadGenericSlow)                \
+  SC(keyed_load_generic_hash, V8.KeyedLoadGenericHash)                \
   SC(keyed_load_external_array_slow, V8.KeyedLoadExternalArraySlow)   \
   /* Count how much the monomorphic keyed-load stubs are hit. */      \
   SC(keyed_load_function_prototype, V8.KeyedLoadFunctionPrototype)    \
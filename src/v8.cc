@@ -27,11 +27,13 @@
 
 #include "v8.h"
 
+#include "allocation-sampler.h"
 #include "bootstrapper.h"
 #include "debug.h"
 #include "serialize.h"
 #include "simulator.h"
 #include "stub-cache.h"
+#include "string-kernels.h"
 #include "oprofile-agent.h"
 #include "log.h"
 
@@ -111,6 +113,7 @@ bool V8::Initialize(Deserializer *des) {
   // any deserialization because we have to have the initial heap
   // objects in place for creating the code object used for probing.
   CPU::Setup();
+  StringKernels::Setup();
 
   OProfileAgent::Initialize();
 
@@ -122,6 +125,12 @@ bool V8::Initialize(Deserializer *des) {
     LOG(LogCompiledFunctions());
   }
 
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  if (FLAG_sample_allocations > 0) {
+    AllocationSampler::Start(FLAG_sample_allocations);
+  }
+#endif
+
   return true;
 }
 
@@ -147,6 +156,10 @@ void V8::TearDown() {
 
   Top::TearDown();
 
+#ifdef ENABLE_LOGGING_AND_PROFILING
+  AllocationSampler::TearDown();
+#endif
+
   Heap::TearDown();
   Logger::TearDown();
 
@@ -174,13 +187,13 @@ uint32_t V8::Random() {
 }
 
 
-bool V8::IdleNotification() {
-  // Returning true tells the caller that there is no need to call
+int V8::IdleNotification(int idle_time_in_ms) {
+  // Returning zero tells the caller that there is no need to call
   // IdleNotification again.
-  if (!FLAG_use_idle_notification) return true;
+  if (!FLAG_use_idle_notification) return 0;
 
   // Tell the heap that it may want to adjust.
-  return Heap::IdleNotification();
+  return Heap::IdleNotification(idle_time_in_ms);
 }
 
 static const uint32_t kRandomPositiveSmiMax = 0x3fffffff;
@@ -97,7 +97,7 @@ class V8 : public AllStatic {
   static Smi* RandomPositiveSmi();
 
   // Idle notification directly from the API.
-  static bool IdleNotification();
+  static int IdleNotification(int idle_time_in_ms);
 
  private:
   // True if engine is currently running
@@ -911,6 +911,139 @@ void Builtins::Generate_JSConstructCall(MacroAssembler* masm) {
 }
 
 
+// Allocates and initializes the receiver of a construct call in new space
+// or, if flags is PRETENURE_OLD_POINTER_SPACE, in the allocation buffer of
+// the old pointer space.  Jumps to allocated with the JSObject in rbx, or
+// to rt_call if the allocation fails.
+// rax: initial map
+static void AllocateReceiver(MacroAssembler* masm,
+                             AllocationFlags flags,
+                             Label* rt_call,
+                             Label* allocated) {
+  Label undo_allocation;
+
+  // Now allocate the JSObject on the heap.
+  __ movzxbq(rdi, FieldOperand(rax, Map::kInstanceSizeOffset));
+  __ shl(rdi, Immediate(kPointerSizeLog2));
+  // rdi: size of new object
+  __ AllocateInNewSpace(rdi,
+                        rbx,
+                        rdi,
+                        no_reg,
+                        rt_call,
+                        flags);
+  // Allocated the JSObject, now initialize the fields.
+  // rax: initial map
+  // rbx: JSObject (not HeapObject tagged - the actual address).
+  // rdi: start of next object
+  __ movq(Operand(rbx, JSObject::kMapOffset), rax);
+  __ LoadRoot(rcx, Heap::kEmptyFixedArrayRootIndex);
+  __ movq(Operand(rbx, JSObject::kPropertiesOffset), rcx);
+  __ movq(Operand(rbx, JSObject::kElementsOffset), rcx);
+  // Set extra fields in the newly allocated object.
+  // rax: initial map
+  // rbx: JSObject
+  // rdi: start of next object
+  { Label loop, entry;
+    __ LoadRoot(rdx, Heap::kUndefinedValueRootIndex);
+    __ lea(rcx, Operand(rbx, JSObject::kHeaderSize));
+    __ jmp(&entry);
+    __ bind(&loop);
+    __ movq(Operand(rcx, 0), rdx);
+    __ addq(rcx, Immediate(kPointerSize));
+    __ bind(&entry);
+    __ cmpq(rcx, rdi);
+    __ j(less, &loop);
+  }
+
+  // Add the object tag to make the JSObject real, so that we can continue and
+  // jump into the continuation code at any time from now on. Any failures
+  // need to undo the allocation, so that the heap is in a consistent state
+  // and verifiable.
+  // rax: initial map
+  // rbx: JSObject
+  // rdi: start of next object
+  __ or_(rbx, Immediate(kHeapObjectTag));
+
+  // Check if a non-empty properties array is needed.
+  // Allocate and initialize a FixedArray if it is.
+  // rax: initial map
+  // rbx: JSObject
+  // rdi: start of next object
+  // Calculate total properties described map.
+  __ movzxbq(rdx, FieldOperand(rax, Map::kUnusedPropertyFieldsOffset));
+  __ movzxbq(rcx, FieldOperand(rax, Map::kPreAllocatedPropertyFieldsOffset));
+  __ addq(rdx, rcx);
+  // Calculate unused properties past the end of the in-object properties.
+  __ movzxbq(rcx, FieldOperand(rax, Map::kInObjectPropertiesOffset));
+  __ subq(rdx, rcx);
+  // Done if no extra properties are to be allocated.
+  __ j(zero, allocated);
+  __ Assert(positive, "Property allocation count failed.");
+
+  // Scale the number of elements by pointer size and add the header for
+  // FixedArrays to the start of the next object calculation from above.
+  // rbx: JSObject
+  // rdi: start of next object (will be start of FixedArray)
+  // rdx: number of elements in properties array
+  __ AllocateInNewSpace(FixedArray::kHeaderSize,
+                        times_pointer_size,
+                        rdx,
+                        rdi,
+                        rax,
+                        no_reg,
+                        &undo_allocation,
+                        static_cast<AllocationFlags>(flags |
+                                                     RESULT_CONTAINS_TOP));
+
+  // Initialize the FixedArray.
+  // rbx: JSObject
+  // rdi: FixedArray
+  // rdx: number of elements
+  // rax: start of next object
+  __ LoadRoot(rcx, Heap::kFixedArrayMapRootIndex);
+  __ movq(Operand(rdi, JSObject::kMapOffset), rcx);  // setup the map
+  __ movl(Operand(rdi, FixedArray::kLengthOffset), rdx);  // and length
+
+  // Initialize the fields to undefined.
+  // rbx: JSObject
+  // rdi: FixedArray
+  // rax: start of next object
+  // rdx: number of elements
+  { Label loop, entry;
+    __ LoadRoot(rdx, Heap::kUndefinedValueRootIndex);
+    __ lea(rcx, Operand(rdi, FixedArray::kHeaderSize));
+    __ jmp(&entry);
+    __ bind(&loop);
+    __ movq(Operand(rcx, 0), rdx);
+    __ addq(rcx, Immediate(kPointerSize));
+    __ bind(&entry);
+    __ cmpq(rcx, rax);
+    __ j(below, &loop);
+  }
+
+  // Store the initialized FixedArray into the properties field of
+  // the JSObject
+  // rbx: JSObject
+  // rdi: FixedArray
+  __ or_(rdi, Immediate(kHeapObjectTag));  // add the heap tag
+  __ movq(FieldOperand(rbx, JSObject::kPropertiesOffset), rdi);
+
+
+  // Continue with JSObject being successfully allocated
+  // rbx: JSObject
+  __ jmp(allocated);
+
+  // Undo the setting of the new top so that the heap is verifiable. For
+  // example, the map's unused properties potentially do not match the
+  // allocated objects unused properties.
+  // rbx: JSObject (previous new top)
+  __ bind(&undo_allocation);
+  __ UndoAllocationInNewSpace(rbx, flags);
+  __ jmp(rt_call);
+}
+
+
 static void Generate_JSConstructStubHelper(MacroAssembler* masm,
                                            bool is_api_function) {
     // Enter a construct frame.
@@ -927,8 +1060,6 @@ static void Generate_JSConstructStubHelper(MacroAssembler* masm,
   // preconditions is not met, the code bails out to the runtime call.
   Label rt_call, allocated;
   if (FLAG_inline_new) {
-    Label undo_allocation;
-
 #ifdef ENABLE_DEBUGGER_SUPPORT
     ExternalReference debug_step_in_fp =
         ExternalReference::debug_step_in_fp_address();
@@ -957,123 +1088,16 @@ static void Generate_JSConstructStubHelper(MacroAssembler* masm,
     __ CmpInstanceType(rax, JS_FUNCTION_TYPE);
     __ j(equal, &rt_call);
 
-    // Now allocate the JSObject on the heap.
-    __ movzxbq(rdi, FieldOperand(rax, Map::kInstanceSizeOffset));
-    __ shl(rdi, Immediate(kPointerSizeLog2));
-    // rdi: size of new object
-    __ AllocateInNewSpace(rdi,
-                          rbx,
-                          rdi,
-                          no_reg,
-                          &rt_call,
-                          NO_ALLOCATION_FLAGS);
-    // Allocated the JSObject, now initialize the fields.
-    // rax: initial map
-    // rbx: JSObject (not HeapObject tagged - the actual address).
-    // rdi: start of next object
-    __ movq(Operand(rbx, JSObject::kMapOffset), rax);
-    __ LoadRoot(rcx, Heap::kEmptyFixedArrayRootIndex);
-    __ movq(Operand(rbx, JSObject::kPropertiesOffset), rcx);
-    __ movq(Operand(rbx, JSObject::kElementsOffset), rcx);
-    // Set extra fields in the newly allocated object.
-    // rax: initial map
-    // rbx: JSObject
-    // rdi: start of next object
-    { Label loop, entry;
-      __ LoadRoot(rdx, Heap::kUndefinedValueRootIndex);
-      __ lea(rcx, Operand(rbx, JSObject::kHeaderSize));
-      __ jmp(&entry);
-      __ bind(&loop);
-      __ movq(Operand(rcx, 0), rdx);
-      __ addq(rcx, Immediate(kPointerSize));
-      __ bind(&entry);
-      __ cmpq(rcx, rdi);
-      __ j(less, &loop);
-    }
-
-    // Add the object tag to make the JSObject real, so that we can continue and
-    // jump into the continuation code at any time from now on. Any failures
-    // need to undo the allocation, so that the heap is in a consistent state
-    // and verifiable.
-    // rax: initial map
-    // rbx: JSObject
-    // rdi: start of next object
-    __ or_(rbx, Immediate(kHeapObjectTag));
-
-    // Check if a non-empty properties array is needed.
-    // Allocate and initialize a FixedArray if it is.
+    // Objects of pretenured maps are allocated in old space.
+    // rdi: constructor
     // rax: initial map
-    // rbx: JSObject
-    // rdi: start of next object
-    // Calculate total properties described map.
-    __ movzxbq(rdx, FieldOperand(rax, Map::kUnusedPropertyFieldsOffset));
-    __ movzxbq(rcx, FieldOperand(rax, Map::kPreAllocatedPropertyFieldsOffset));
-    __ addq(rdx, rcx);
-    // Calculate unused properties past the end of the in-object properties.
-    __ movzxbq(rcx, FieldOperand(rax, Map::kInObjectPropertiesOffset));
-    __ subq(rdx, rcx);
-    // Done if no extra properties are to be allocated.
-    __ j(zero, &allocated);
-    __ Assert(positive, "Property allocation count failed.");
-
-    // Scale the number of elements by pointer size and add the header for
-    // FixedArrays to the start of the next object calculation from above.
-    // rbx: JSObject
-    // rdi: start of next object (will be start of FixedArray)
-    // rdx: number of elements in properties array
-    __ AllocateInNewSpace(FixedArray::kHeaderSize,
-                          times_pointer_size,
-                          rdx,
-                          rdi,
-                          rax,
-                          no_reg,
-                          &undo_allocation,
-                          RESULT_CONTAINS_TOP);
-
-    // Initialize the FixedArray.
-    // rbx: JSObject
-    // rdi: FixedArray
-    // rdx: number of elements
-    // rax: start of next object
-    __ LoadRoot(rcx, Heap::kFixedArrayMapRootIndex);
-    __ movq(Operand(rdi, JSObject::kMapOffset), rcx);  // setup the map
-    __ movl(Operand(rdi, FixedArray::kLengthOffset), rdx);  // and length
-
-    // Initialize the fields to undefined.
-    // rbx: JSObject
-    // rdi: FixedArray
-    // rax: start of next object
-    // rdx: number of elements
-    { Label loop, entry;
-      __ LoadRoot(rdx, Heap::kUndefinedValueRootIndex);
-      __ lea(rcx, Operand(rdi, FixedArray::kHeaderSize));
-      __ jmp(&entry);
-      __ bind(&loop);
-      __ movq(Operand(rcx, 0), rdx);
-      __ addq(rcx, Immediate(kPointerSize));
-      __ bind(&entry);
-      __ cmpq(rcx, rax);
-      __ j(below, &loop);
-    }
-
-    // Store the initialized FixedArray into the properties field of
-    // the JSObject
-    // rbx: JSObject
-    // rdi: FixedArray
-    __ or_(rdi, Immediate(kHeapObjectTag));  // add the heap tag
-    __ movq(FieldOperand(rbx, JSObject::kPropertiesOffset), rdi);
-
-
-    // Continue with JSObject being successfully allocated
-    // rbx: JSObject
-    __ jmp(&allocated);
-
-    // Undo the setting of the new top so that the heap is verifiable. For
-    // example, the map's unused properties potentially do not match the
-    // allocated objects unused properties.
-    // rbx: JSObject (previous new top)
-    __ bind(&undo_allocation);
-    __ UndoAllocationInNewSpace(rbx);
+    Label pretenured;
+    __ testb(FieldOperand(rax, Map::kBitField2Offset),
+             Immediate(1 << Map::kIsPretenured));
+    __ j(not_zero, &pretenured);
+    AllocateReceiver(masm, NO_ALLOCATION_FLAGS, &rt_call, &allocated);
+    __ bind(&pretenured);
+    AllocateReceiver(masm, PRETENURE_OLD_POINTER_SPACE, &rt_call, &allocated);
   }
 
   // Allocate the new receiver object using the runtime call.
@@ -6275,8 +6275,9 @@ void Reference::SetValue(InitState init_state) {
                                                receiver.reg());
 
         // Check that the value is a smi if it is not a constant.
-        // We can skip the write barrier for smis and constants.
-        if (!value_is_constant) {
+        // We can skip the write barrier for smis and constants, unless
+        // incremental marking needs to see the store.
+        if (!value_is_constant || FLAG_incremental_marking) {
           __ JumpIfNotSmi(value.reg(), deferred->entry_label());
         }
 
@@ -6455,6 +6456,13 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   __ CompareRoot(rcx, Heap::kUndefinedValueRootIndex);
   __ j(equal, &slow_case);
 
+  // Copies of pretenured boilerplates are allocated in old space by the
+  // runtime.
+  __ movq(rax, FieldOperand(rcx, HeapObject::kMapOffset));
+  __ testb(FieldOperand(rax, Map::kBitField2Offset),
+           Immediate(1 << Map::kIsPretenured));
+  __ j(not_zero, &slow_case);
+
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
   __ AllocateInNewSpace(size, rax, rbx, rdx, &slow_case, TAG_OBJECT);
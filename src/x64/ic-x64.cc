@@ -263,13 +263,88 @@ void KeyedLoadIC::GenerateRuntimeGetProperty(MacroAssembler* masm) {
 }
 
 
+// Helper function used to compute the hash field of a string key whose hash
+// has not been computed yet.  Only short sequential ASCII strings that are
+// array indices are handled, for which the hash field holds the index and
+// the length, and everything else jumps to not_index.  On success the hash
+// field is stored in the key and left in the hash register.
+static void GenerateArrayIndexHashField(MacroAssembler* masm,
+                                        Label* not_index,
+                                        Register key,
+                                        Register map,
+                                        Register hash,
+                                        Register length,
+                                        Register scratch) {
+  // Register use:
+  //
+  // key     - holds the string key and is unchanged.
+  //
+  // map     - initially the map of the key
+  //         - used for the index of the current character.
+  //
+  // hash    - used for the array index and holds the hash field on exit.
+  //
+  // length  - used to hold the length of the key.
+  //
+  // scratch - used to hold the current character.
+
+  // Check that the key is a sequential ASCII string.
+  __ movzxbl(scratch, FieldOperand(map, Map::kInstanceTypeOffset));
+  __ andl(scratch, Immediate(kStringRepresentationMask | kStringEncodingMask));
+  __ cmpl(scratch, Immediate(kSeqStringTag | kAsciiStringTag));
+  __ j(not_equal, not_index);
+
+  // Check that the index fits in the hash field.
+  __ movl(length, FieldOperand(key, String::kLengthOffset));
+  __ testl(length, length);
+  __ j(zero, not_index);
+  __ cmpl(length, Immediate(String::kMaxCachedArrayIndexLength));
+  __ j(above, not_index);
+
+  // An array index only starts with '0' if it is "0".
+  Label convert;
+  __ cmpb(FieldOperand(key, SeqAsciiString::kHeaderSize), Immediate('0'));
+  __ j(not_equal, &convert);
+  __ cmpl(length, Immediate(1));
+  __ j(not_equal, not_index);
+
+  // Convert the digits to the index.  It cannot overflow because of the
+  // length limit.
+  Label loop;
+  __ bind(&convert);
+  __ xorl(hash, hash);
+  __ xorl(map, map);
+  __ bind(&loop);
+  __ movzxbl(scratch,
+             FieldOperand(key, map, times_1, SeqAsciiString::kHeaderSize));
+  __ subl(scratch, Immediate('0'));
+  __ cmpl(scratch, Immediate(9));
+  __ j(above, not_index);  // Unsigned comparison rejects non-digits.
+  __ lea(hash, Operand(hash, hash, times_4, 0));
+  __ lea(hash, Operand(scratch, hash, times_2, 0));
+  __ incq(map);
+  __ cmpl(map, length);
+  __ j(less, &loop);
+
+  // Store the hash field of the array index, see StringHasher::GetHashField.
+  ASSERT(TenToThe(String::kMaxCachedArrayIndexLength) <
+         (1 << String::kArrayIndexValueBits));
+  __ shll(hash, Immediate(String::kHashShift));
+  __ shll(length, Immediate(String::kArrayIndexHashLengthShift));
+  __ orl(hash, length);
+  __ orl(hash,
+         Immediate(String::kHashComputedMask | String::kIsArrayIndexMask));
+  __ movl(FieldOperand(key, String::kHashFieldOffset), hash);
+}
+
+
 void KeyedLoadIC::GenerateGeneric(MacroAssembler* masm) {
   // ----------- S t a t e -------------
   //  -- rsp[0] : return address
   //  -- rsp[8] : name
   //  -- rsp[16] : receiver
   // -----------------------------------
-  Label slow, check_string, index_int, index_string;
+  Label slow, check_string, index_int, index_string, compute_hash;
   Label check_pixel_array, probe_dictionary;
 
   // Load name and receiver.
@@ -344,6 +419,10 @@ void KeyedLoadIC::GenerateGeneric(MacroAssembler* masm) {
 
   // Is the string a symbol?
   __ j(not_zero, &index_string);  // The value in rbx is used at jump target.
+  // A string without a computed hash is not a symbol, but it can be an
+  // array index computed at runtime.
+  __ testl(rbx, Immediate(String::kHashComputedMask));
+  __ j(zero, &compute_hash);
   ASSERT(kSymbolTag != 0);
   __ testb(FieldOperand(rdx, Map::kInstanceTypeOffset),
            Immediate(kIsSymbolMask));
@@ -420,6 +499,13 @@ void KeyedLoadIC::GenerateGeneric(MacroAssembler* masm) {
   __ and_(rax, Immediate(String::kArrayIndexHashMask));
   __ shrl(rax, Immediate(String::kHashShift));
   __ jmp(&index_int);
+
+  // Compute the hash field of the key, which leaves it in rbx as expected
+  // at index_string.
+  __ bind(&compute_hash);
+  GenerateArrayIndexHashField(masm, &slow, rax, rdx, rbx, rdi, r8);
+  __ IncrementCounter(&Counters::keyed_load_generic_hash, 1);
+  __ jmp(&index_string);
 }
 
 
@@ -72,102 +72,83 @@ void MacroAssembler::StackLimitCheck(Label* on_stack_overflow) {
 }
 
 
-static void RecordWriteHelper(MacroAssembler* masm,
-                              Register object,
-                              Register addr,
-                              Register scratch) {
-  Label fast;
-
-  // Compute the page start address from the heap object pointer, and reuse
-  // the 'object' register for it.
-  ASSERT(is_int32(~Page::kPageAlignmentMask));
-  masm->and_(object,
-             Immediate(static_cast<int32_t>(~Page::kPageAlignmentMask)));
-  Register page_start = object;
-
-  // Compute the bit addr in the remembered set/index of the pointer in the
-  // page. Reuse 'addr' as pointer_offset.
-  masm->subq(addr, page_start);
-  masm->shr(addr, Immediate(kPointerSizeLog2));
-  Register pointer_offset = addr;
-
-  // If the bit offset lies beyond the normal remembered set range, it is in
-  // the extra remembered set area of a large object.
-  masm->cmpq(pointer_offset, Immediate(Page::kPageSize / kPointerSize));
-  masm->j(less, &fast);
-
-  // Adjust 'page_start' so that addressing using 'pointer_offset' hits the
-  // extra remembered set after the large object.
-
-  // Load the array length into 'scratch'.
-  masm->movl(scratch,
-             Operand(page_start,
-                     Page::kObjectStartOffset + FixedArray::kLengthOffset));
-  Register array_length = scratch;
-
-  // Extra remembered set starts right after the large object (a FixedArray), at
-  //   page_start + kObjectStartOffset + objectSize
-  // where objectSize is FixedArray::kHeaderSize + kPointerSize * array_length.
-  // Add the delta between the end of the normal RSet and the start of the
-  // extra RSet to 'page_start', so that addressing the bit using
-  // 'pointer_offset' hits the extra RSet words.
-  masm->lea(page_start,
-            Operand(page_start, array_length, times_pointer_size,
-                    Page::kObjectStartOffset + FixedArray::kHeaderSize
-                        - Page::kRSetEndOffset));
-
-  // NOTE: For now, we use the bit-test-and-set (bts) x86 instruction
-  // to limit code size. We should probably evaluate this decision by
-  // measuring the performance of an equivalent implementation using
-  // "simpler" instructions
-  masm->bind(&fast);
-  masm->bts(Operand(page_start, Page::kRSetOffset), pointer_offset);
-}
-
-
-class RecordWriteStub : public CodeStub {
+// Calls the store buffer's overflow function, preserving the registers
+// that the C function may clobber.
+static void CallStoreBufferOverflowFunction(MacroAssembler* masm) {
+  masm->push(rax);
+  masm->push(rcx);
+  masm->push(rdx);
+  masm->push(rsi);
+  masm->push(rdi);
+  masm->push(r8);
+  masm->push(r9);
+  masm->push(r11);
+  masm->PrepareCallCFunction(0);
+  masm->CallCFunction(ExternalReference::store_buffer_overflow_function(), 0);
+  masm->pop(r11);
+  masm->pop(r9);
+  masm->pop(r8);
+  masm->pop(rdi);
+  masm->pop(rsi);
+  masm->pop(rdx);
+  masm->pop(rcx);
+  masm->pop(rax);
+}
+
+
+class StoreBufferOverflowStub : public CodeStub {
  public:
-  RecordWriteStub(Register object, Register addr, Register scratch)
-      : object_(object), addr_(addr), scratch_(scratch) { }
+  StoreBufferOverflowStub() { }
 
   void Generate(MacroAssembler* masm);
 
  private:
-  Register object_;
-  Register addr_;
-  Register scratch_;
-
 #ifdef DEBUG
   void Print() {
-    PrintF("RecordWriteStub (object reg %d), (addr reg %d), (scratch reg %d)\n",
-           object_.code(), addr_.code(), scratch_.code());
+    PrintF("StoreBufferOverflowStub\n");
   }
 #endif
 
-  // Minor key encoding in 12 bits of three registers (object, address and
-  // scratch) OOOOAAAASSSS.
-  class ScratchBits : public BitField<uint32_t, 0, 4> {};
-  class AddressBits : public BitField<uint32_t, 4, 4> {};
-  class ObjectBits : public BitField<uint32_t, 8, 4> {};
-
   Major MajorKey() { return RecordWrite; }
-
-  int MinorKey() {
-    // Encode the registers.
-    return ObjectBits::encode(object_.code()) |
-           AddressBits::encode(addr_.code()) |
-           ScratchBits::encode(scratch_.code());
-  }
+  int MinorKey() { return 0; }
 };
 
 
-void RecordWriteStub::Generate(MacroAssembler* masm) {
-  RecordWriteHelper(masm, object_, addr_, scratch_);
+void StoreBufferOverflowStub::Generate(MacroAssembler* masm) {
+  CallStoreBufferOverflowFunction(masm);
   masm->ret(0);
 }
 
 
-// Set the remembered set bit for [object+offset].
+// Appends the slot address in 'addr' to the store buffer.  When the store
+// buffer is full its overflow function is called, through a shared stub
+// unless a stub is being generated already.  Clobbers 'scratch'.
+static void RecordWriteHelper(MacroAssembler* masm,
+                              Register addr,
+                              Register scratch) {
+  Label done;
+
+  masm->movq(kScratchRegister, ExternalReference::store_buffer_top());
+  masm->movq(scratch, Operand(kScratchRegister, 0));
+  masm->movq(Operand(scratch, 0), addr);
+  masm->addq(scratch, Immediate(kPointerSize));
+  masm->movq(Operand(kScratchRegister, 0), scratch);
+  masm->movq(kScratchRegister, ExternalReference::store_buffer_limit());
+  masm->cmpq(scratch, Operand(kScratchRegister, 0));
+  masm->j(not_equal, &done);
+
+  if (masm->generating_stub()) {
+    CallStoreBufferOverflowFunction(masm);
+  } else {
+    StoreBufferOverflowStub stub;
+    masm->CallStub(&stub);
+  }
+
+  masm->bind(&done);
+}
+
+
+// Record the slot [object+offset] in the store buffer.
 // object is the object being stored into, value is the object being stored.
 // If offset is zero, then the smi_index register contains the array index into
 // the elements array represented as a smi. Otherwise it can be used as a
@@ -182,9 +163,8 @@ void MacroAssembler::RecordWrite(Register object,
   // registers are rsi.
   ASSERT(!object.is(rsi) && !value.is(rsi) && !smi_index.is(rsi));
 
-  // First, check if a remembered set write is even needed. The tests below
-  // catch stores of Smis and stores into young gen (which does not have space
-  // for the remembered set bits.
+  // First, check if a store buffer entry is even needed. The tests below
+  // catch stores of Smis and stores into young gen.
   Label done;
   JumpIfSmi(value, &done);
 
@@ -217,8 +197,8 @@ void MacroAssembler::RecordWriteNonSmi(Register object,
     bind(&okay);
   }
 
-  // Test that the object address is not in the new space.  We cannot
-  // set remembered set bits in the new space.
+  // Test that the object address is not in the new space.  Stores into
+  // new space are not recorded in the store buffer.
   movq(scratch, object);
   ASSERT(is_int32(static_cast<int64_t>(Heap::NewSpaceMask())));
   and_(scratch, Immediate(static_cast<int32_t>(Heap::NewSpaceMask())));
@@ -226,44 +206,19 @@ void MacroAssembler::RecordWriteNonSmi(Register object,
   cmpq(scratch, kScratchRegister);
   j(equal, &done);
 
-  if ((offset > 0) && (offset < Page::kMaxHeapObjectSize)) {
-    // Compute the bit offset in the remembered set, leave it in 'value'.
-    lea(scratch, Operand(object, offset));
-    ASSERT(is_int32(Page::kPageAlignmentMask));
-    and_(scratch, Immediate(static_cast<int32_t>(Page::kPageAlignmentMask)));
-    shr(scratch, Immediate(kObjectAlignmentBits));
-
-    // Compute the page address from the heap object pointer, leave it in
-    // 'object' (immediate value is sign extended).
-    and_(object, Immediate(~Page::kPageAlignmentMask));
-
-    // NOTE: For now, we use the bit-test-and-set (bts) x86 instruction
-    // to limit code size. We should probably evaluate this decision by
-    // measuring the performance of an equivalent implementation using
-    // "simpler" instructions
-    bts(Operand(object, Page::kRSetOffset), scratch);
+  Register dst = smi_index;
+  if (offset != 0) {
+    lea(dst, Operand(object, offset - kHeapObjectTag));
   } else {
-    Register dst = smi_index;
-    if (offset != 0) {
-      lea(dst, Operand(object, offset));
-    } else {
-      // array access: calculate the destination address in the same manner as
-      // KeyedStoreIC::GenerateGeneric.
-      SmiIndex index = SmiToIndex(smi_index, smi_index, kPointerSizeLog2);
-      lea(dst, Operand(object,
-                       index.reg,
-                       index.scale,
-                       FixedArray::kHeaderSize - kHeapObjectTag));
-    }
-    // If we are already generating a shared stub, not inlining the
-    // record write code isn't going to save us any memory.
-    if (generating_stub()) {
-      RecordWriteHelper(this, object, dst, scratch);
-    } else {
-      RecordWriteStub stub(object, dst, scratch);
-      CallStub(&stub);
-    }
+    // array access: calculate the destination address in the same manner as
+    // KeyedStoreIC::GenerateGeneric.
+    SmiIndex index = SmiToIndex(smi_index, smi_index, kPointerSizeLog2);
+    lea(dst, Operand(object,
+                     index.reg,
+                     index.scale,
+                     FixedArray::kHeaderSize - kHeapObjectTag));
   }
+  RecordWriteHelper(this, dst, scratch);
 
   bind(&done);
 
@@ -2226,12 +2181,27 @@ void MacroAssembler::CheckAccessGlobalProxy(Register holder_reg,
 }
 
 
+static ExternalReference AllocationTopAddress(AllocationFlags flags) {
+  if ((flags & PRETENURE_OLD_POINTER_SPACE) != 0) {
+    return ExternalReference::old_pointer_space_allocation_top_address();
+  }
+  return ExternalReference::new_space_allocation_top_address();
+}
+
+
+static ExternalReference AllocationLimitAddress(AllocationFlags flags) {
+  if ((flags & PRETENURE_OLD_POINTER_SPACE) != 0) {
+    return ExternalReference::old_pointer_space_allocation_limit_address();
+  }
+  return ExternalReference::new_space_allocation_limit_address();
+}
+
+
 void MacroAssembler::LoadAllocationTopHelper(Register result,
                                              Register result_end,
                                              Register scratch,
                                              AllocationFlags flags) {
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Just return if allocation top is already known.
   if ((flags & RESULT_CONTAINS_TOP) != 0) {
@@ -2259,14 +2229,14 @@ void MacroAssembler::LoadAllocationTopHelper(Register result,
 
 
 void MacroAssembler::UpdateAllocationTopHelper(Register result_end,
-                                               Register scratch) {
+                                               Register scratch,
+                                               AllocationFlags flags) {
   if (FLAG_debug_code) {
     testq(result_end, Immediate(kObjectAlignmentMask));
     Check(zero, "Unaligned allocation in new space");
   }
 
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Update new top.
   if (result_end.is(rax)) {
@@ -2297,14 +2267,14 @@ void MacroAssembler::AllocateInNewSpace(int object_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   lea(result_end, Operand(result, object_size));
   movq(kScratchRegister, new_space_allocation_limit);
   cmpq(result_end, Operand(kScratchRegister, 0));
   j(above, gc_required);
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 
   // Tag the result if requested.
   if ((flags & TAG_OBJECT) != 0) {
@@ -2328,14 +2298,14 @@ void MacroAssembler::AllocateInNewSpace(int header_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   lea(result_end, Operand(result, element_count, element_size, header_size));
   movq(kScratchRegister, new_space_allocation_limit);
   cmpq(result_end, Operand(kScratchRegister, 0));
   j(above, gc_required);
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 
   // Tag the result if requested.
   if ((flags & TAG_OBJECT) != 0) {
@@ -2355,7 +2325,7 @@ void MacroAssembler::AllocateInNewSpace(Register object_size,
 
   // Calculate new top and bail out if new space is exhausted.
   ExternalReference new_space_allocation_limit =
-      ExternalReference::new_space_allocation_limit_address();
+      AllocationLimitAddress(flags);
   if (!object_size.is(result_end)) {
     movq(result_end, object_size);
   }
@@ -2365,7 +2335,7 @@ void MacroAssembler::AllocateInNewSpace(Register object_size,
   j(above, gc_required);
 
   // Update allocation top.
-  UpdateAllocationTopHelper(result_end, scratch);
+  UpdateAllocationTopHelper(result_end, scratch, flags);
 
   // Tag the result if requested.
   if ((flags & TAG_OBJECT) != 0) {
@@ -2374,9 +2344,9 @@ void MacroAssembler::AllocateInNewSpace(Register object_size,
 }
 
 
-void MacroAssembler::UndoAllocationInNewSpace(Register object) {
-  ExternalReference new_space_allocation_top =
-      ExternalReference::new_space_allocation_top_address();
+void MacroAssembler::UndoAllocationInNewSpace(Register object,
+                                              AllocationFlags flags) {
+  ExternalReference new_space_allocation_top = AllocationTopAddress(flags);
 
   // Make sure the object has no tag before resetting top.
   and_(object, Immediate(~kHeapObjectTagMask));
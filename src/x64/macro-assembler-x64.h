@@ -65,7 +65,7 @@ class MacroAssembler: public Assembler {
   // ---------------------------------------------------------------------------
   // GC Support
 
-  // Set the remembered set bit for [object+offset].
+  // Record the slot [object+offset] in the store buffer.
   // object is the object being stored into, value is the object being stored.
   // If offset is zero, then the scratch register contains the array index into
   // the elements array represented as a Smi.
@@ -75,7 +75,7 @@ class MacroAssembler: public Assembler {
                    Register value,
                    Register scratch);
 
-  // Set the remembered set bit for [object+offset].
+  // Record the slot [object+offset] in the store buffer.
   // The value is known to not be a smi.
   // object is the object being stored into, value is the object being stored.
   // If offset is zero, then the scratch register contains the array index into
@@ -536,7 +536,10 @@ class MacroAssembler: public Assembler {
   // result_contains_top_on_entry is true the content of result is known to be
   // the allocation top on entry (could be result_end from a previous call to
   // AllocateInNewSpace). If result_contains_top_on_entry is true scratch
-  // should be no_reg as it is never used.
+  // should be no_reg as it is never used.  With PRETENURE_OLD_POINTER_SPACE
+  // the object is allocated in the allocation buffer of the old pointer
+  // space instead, and control continues at gc_required when the buffer is
+  // exhausted.
   void AllocateInNewSpace(int object_size,
                           Register result,
                           Register result_end,
@@ -564,7 +567,8 @@ class MacroAssembler: public Assembler {
   // it will no longer be allocated. Make sure that no pointers are left to the
   // object(s) no longer allocated as they would be invalid when allocation is
   // un-done.
-  void UndoAllocationInNewSpace(Register object);
+  void UndoAllocationInNewSpace(Register object,
+                                AllocationFlags flags = NO_ALLOCATION_FLAGS);
 
   // Allocate a heap number in new space with undefined value. Returns
   // tagged pointer in result register, or jumps to gc_required if new
@@ -748,7 +752,9 @@ class MacroAssembler: public Assembler {
                                Register result_end,
                                Register scratch,
                                AllocationFlags flags);
-  void UpdateAllocationTopHelper(Register result_end, Register scratch);
+  void UpdateAllocationTopHelper(Register result_end,
+                                 Register scratch,
+                                 AllocationFlags flags);
 };
 
 
@@ -1760,6 +1760,12 @@ Object* ConstructStubCompiler::CompileConstructStub(
   __ CmpObjectType(rbx, MAP_TYPE, rcx);
   __ j(not_equal, &generic_stub_call);
 
+  // Objects of pretenured maps are allocated in old space by the runtime,
+  // which the generic stub calls.
+  __ testb(FieldOperand(rbx, Map::kBitField2Offset),
+           Immediate(1 << Map::kIsPretenured));
+  __ j(not_zero, &generic_stub_call);
+
 #ifdef DEBUG
   // Cannot construct functions this way.
   // rdi: constructor
@@ -9350,6 +9350,24 @@ THREADED_TEST(IdleNotification) {
 }
 
 
+// Test that idle notifications with a deadline report the remaining work
+// and that it runs out.
+THREADED_TEST(IdleNotificationWithDeadline) {
+  v8::HandleScope scope;
+  LocalContext env;
+  CompileRun("var data = [];"
+             "for (var i = 0; i < 10000; i++) data.push([i]);"
+             "data = null;");
+  CHECK_GT(v8::V8::IdleNotification(0), 0);
+  int remaining = 0;
+  for (int i = 0; i < 100; i++) {
+    remaining = v8::V8::IdleNotification(100);
+    if (remaining == 0) break;
+  }
+  CHECK_EQ(0, remaining);
+}
+
+
 static uint32_t* stack_limit;
 
 static v8::Handle<Value> GetStackLimitCallback(const v8::Arguments& args) {
@@ -9436,6 +9454,56 @@ THREADED_TEST(GetHeapStatistics) {
 }
 
 
+static int soft_limit_callback_count = 0;
+static int soft_limit_old_generation_size = 0;
+
+static void SoftLimitCallback(int old_generation_size, int soft_limit) {
+  CHECK_GT(old_generation_size, soft_limit);
+  soft_limit_callback_count++;
+  soft_limit_old_generation_size = old_generation_size;
+}
+
+
+TEST(OldGenerationLimits) {
+  static const int MB = 1024 * 1024;
+  v8::HandleScope scope;
+  LocalContext env;
+
+  CHECK(!v8::V8::SetOldGenerationLimits(-1, 0));
+  CHECK(!v8::V8::SetOldGenerationLimits(8 * MB, 4 * MB));
+  CHECK(!v8::V8::SetOldGenerationLimits(
+      0, i::Heap::MaxOldGenerationSize() + MB));
+
+  i::Heap::CollectAllGarbage(false);
+  v8::HeapStatistics heap_statistics;
+  v8::V8::GetHeapStatistics(&heap_statistics);
+  int soft_limit = static_cast<int>(heap_statistics.used_heap_size()) + 4 * MB;
+  CHECK(v8::V8::SetOldGenerationLimits(soft_limit, 0));
+  v8::V8::SetOldGenerationSoftLimitCallback(SoftLimitCallback);
+
+  // The callback is called once when live data grows past the soft limit.
+  const char* fill =
+      "var data = [];"
+      "for (var i = 0; i < 200000; i++) data.push([i, i, i]);";
+  CompileRun(fill);
+  CHECK_EQ(1, soft_limit_callback_count);
+  CHECK_GT(soft_limit_old_generation_size, soft_limit);
+  CompileRun("for (var i = 0; i < 100000; i++) data.push([i, i, i]);");
+  i::Heap::CollectAllGarbage(false);
+  CHECK_EQ(1, soft_limit_callback_count);
+
+  // Once a full GC has brought the old generation back under the limit,
+  // crossing it again calls the callback again.
+  CompileRun("data = null;");
+  i::Heap::CollectAllGarbage(false);
+  CompileRun(fill);
+  CHECK_EQ(2, soft_limit_callback_count);
+
+  CHECK(v8::V8::SetOldGenerationLimits(0, 0));
+  v8::V8::SetOldGenerationSoftLimitCallback(NULL);
+}
+
+
 static double DoubleFromBits(uint64_t value) {
   double target;
 #ifdef BIG_ENDIAN_FLOATING_POINT
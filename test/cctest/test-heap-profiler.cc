@@ -389,4 +389,215 @@ TEST(RetainerProfile) {
   CHECK_EQ("(global property);1", printer.GetRetainers("C"));
 }
 
+
+namespace {
+
+// Reads back a snapshot written by HeapSnapshotWriter.
+class HeapSnapshotReader {
+ public:
+  struct Node {
+    uintptr_t id;
+    int type;
+    int name;
+    int first_edge;
+    int edge_count;
+  };
+
+  struct Edge {
+    int type;
+    uintptr_t name_or_index;
+    uintptr_t to;
+  };
+
+  HeapSnapshotReader(const char* data, int length)
+      : data_(data), length_(length), position_(0) {
+  }
+
+  void Read() {
+    CHECK_EQ(0, strncmp("V8HS", data_, 4));
+    position_ = 4;
+    CHECK_EQ(i::HeapSnapshotWriter::kVersion, ReadVarint());
+    for (char tag = ReadByte(); tag != 'e'; tag = ReadByte()) {
+      if (tag == 's') {
+        CHECK_EQ(strings_.length(), ReadVarint());
+        int length = ReadVarint();
+        strings_.Add(i::Vector<const char>(data_ + position_, length));
+        position_ += length;
+      } else {
+        CHECK_EQ('n', tag);
+        Node node;
+        node.id = ReadVarint();
+        node.type = ReadByte();
+        node.name = ReadVarint();
+        ReadVarint();  // Size.
+        node.first_edge = edges_.length();
+        node.edge_count = ReadVarint();
+        for (int j = 0; j < node.edge_count; j++) {
+          Edge edge;
+          edge.type = ReadByte();
+          edge.name_or_index = ReadVarint();
+          edge.to = ReadVarint();
+          edges_.Add(edge);
+        }
+        nodes_.Add(node);
+      }
+    }
+    CHECK_EQ(length_, position_);
+  }
+
+  const Node& roots() { return nodes_[0]; }
+
+  // Returns whether a node named from_name has an edge of the given type
+  // and name to a node named to_name.
+  bool HasEdge(const char* from_name,
+               int type,
+               const char* name,
+               const char* to_name) {
+    for (int j = 0; j < nodes_.length(); j++) {
+      const Node& from = nodes_[j];
+      if (!NameIs(from.name, from_name)) continue;
+      for (int k = from.first_edge; k < from.first_edge + from.edge_count;
+           k++) {
+        const Edge& edge = edges_[k];
+        if (edge.type != type ||
+            !NameIs(static_cast<int>(edge.name_or_index), name)) {
+          continue;
+        }
+        const Node* to = FindNode(edge.to);
+        if (to != NULL && NameIs(to->name, to_name)) return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const Node* FindNode(uintptr_t id) {
+    for (int j = 0; j < nodes_.length(); j++) {
+      if (nodes_[j].id == id) return &nodes_[j];
+    }
+    return NULL;
+  }
+
+  bool NameIs(int string, const char* name) {
+    i::Vector<const char> chars = strings_[string];
+    return chars.length() == i::StrLength(name) &&
+        strncmp(chars.start(), name, chars.length()) == 0;
+  }
+
+  char ReadByte() {
+    CHECK(position_ < length_);
+    return data_[position_++];
+  }
+
+  int ReadVarint() {
+    uintptr_t value = 0;
+    int shift = 0;
+    i::byte b;
+    do {
+      b = static_cast<i::byte>(ReadByte());
+      value |= static_cast<uintptr_t>(b & 0x7f) << shift;
+      shift += 7;
+    } while (b & 0x80);
+    return static_cast<int>(value);
+  }
+
+  const char* data_;
+  int length_;
+  int position_;
+  i::List<i::Vector<const char> > strings_;
+  i::List<Node> nodes_;
+  i::List<Edge> edges_;
+};
+
+}  // namespace
+
+
+TEST(HeapSnapshot) {
+  v8::HandleScope scope;
+  v8::Handle<v8::Context> env = v8::Context::New();
+  env->Enter();
+
+  CompileAndRunScript(
+      "function Leak() { this.payload = new Payload(); }\n"
+      "function Payload() {}\n"
+      "var holder = { leaking: new Leak(), list: [new Payload()] };\n"
+      "function Closure() {\n"
+      "  var captured = new Leak();\n"
+      "  return function() { return captured; };\n"
+      "}\n"
+      "var closure = Closure();");
+
+  FILE* file = tmpfile();
+  CHECK(file != NULL);
+  CHECK(v8::V8::WriteHeapSnapshot(fileno(file)));
+  int length = static_cast<int>(ftell(file));
+  CHECK_GT(length, 0);
+  i::ScopedVector<char> data(length);
+  rewind(file);
+  CHECK_EQ(length, static_cast<int>(fread(data.start(), 1, length, file)));
+  fclose(file);
+
+  HeapSnapshotReader reader(data.start(), length);
+  reader.Read();
+  CHECK_EQ(0, static_cast<int>(reader.roots().id));
+  CHECK_GT(reader.roots().edge_count, 0);
+  typedef i::HeapSnapshotWriter Writer;
+  CHECK(reader.HasEdge("Object", Writer::kProperty, "leaking", "Leak"));
+  CHECK(reader.HasEdge("Leak", Writer::kProperty, "payload", "Payload"));
+  CHECK(reader.HasEdge("(context)", Writer::kContextVariable, "captured",
+                       "Leak"));
+  CHECK(reader.HasEdge("Object", Writer::kProperty, "list", "Array"));
+}
+
+
+static const v8::AllocationProfileNode* FindChild(
+    const v8::AllocationProfileNode* node, const char* name) {
+  for (int i = 0; i < node->GetChildrenCount(); i++) {
+    const v8::AllocationProfileNode* child = node->GetChild(i);
+    if (strcmp(child->GetFunctionName(), name) == 0) return child;
+  }
+  return NULL;
+}
+
+
+TEST(AllocationSampling) {
+  v8::HandleScope scope;
+  LocalContext env;
+
+  v8::V8::StartAllocationSampling(4 * i::KB);
+  // Allocates several megabytes, so scavenges happen while sampling.
+  CompileAndRunScript(
+      "function Allocate() {\n"
+      "  var list = [];\n"
+      "  for (var i = 0; i < 1000; i++) list.push({ index: i });\n"
+      "  return list;\n"
+      "}\n"
+      "function Outer() {\n"
+      "  for (var i = 0; i < 100; i++) Allocate();\n"
+      "}\n"
+      "Outer();");
+  v8::V8::StopAllocationSampling();
+  // Allocation after stopping is not sampled.
+  int total =
+      static_cast<int>(v8::V8::GetAllocationProfile()->GetTotalSize());
+  CompileAndRunScript("Outer();");
+
+  const v8::AllocationProfileNode* root = v8::V8::GetAllocationProfile();
+  CHECK_EQ("(root)", root->GetFunctionName());
+  CHECK_EQ(total, static_cast<int>(root->GetTotalSize()));
+  const v8::AllocationProfileNode* top_level = FindChild(root, "");
+  CHECK(top_level != NULL);
+  const v8::AllocationProfileNode* outer = FindChild(top_level, "Outer");
+  CHECK(outer != NULL);
+  CHECK_EQ(6, outer->GetLineNumber());
+  const v8::AllocationProfileNode* allocate = FindChild(outer, "Allocate");
+  CHECK(allocate != NULL);
+  CHECK_EQ(1, allocate->GetLineNumber());
+  // Nearly all of the bytes are allocated in Allocate.
+  int allocate_total = static_cast<int>(allocate->GetTotalSize());
+  CHECK_GT(allocate_total, 1 * i::MB);
+  CHECK_GT(allocate_total, total / 2);
+  CHECK_GT(static_cast<int>(allocate->GetSelfSize()), 0);
+}
+
 #endif  // ENABLE_LOGGING_AND_PROFILING
@@ -791,3 +791,453 @@ TEST(Iteration) {
   CHECK_EQ(objs_count, next_objs_index);
   CHECK_EQ(objs_count, ObjectsFoundInHeap(objs, objs_count));
 }
+
+
+TEST(ParallelScavenge) {
+  FLAG_gc_parallel_scavenge_threads = 4;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // An old array whose elements head short chains of young arrays, so that
+  // the scavengers share the remembered set and copy from each other's
+  // chains.
+  const int kWidth = 1000;
+  const int kDepth = 4;
+  Handle<FixedArray> roots = Factory::NewFixedArray(kWidth, TENURED);
+  for (int i = 0; i < kWidth; i++) {
+    v8::HandleScope inner;
+    Handle<Object> number = Factory::NewNumber(i + 0.5);
+    Handle<FixedArray> chain = Factory::NewFixedArray(2);
+    chain->set(0, *number);
+    roots->set(i, *chain);
+    for (int j = 1; j < kDepth; j++) {
+      Handle<FixedArray> link = Factory::NewFixedArray(2);
+      link->set(0, *number);
+      chain->set(1, *link);
+      chain = link;
+    }
+  }
+
+  // The first scavenge copies the chains within new space, the second one
+  // promotes them.
+  for (int k = 0; k < 2; k++) {
+    Heap::PerformScavenge();
+    for (int i = 0; i < kWidth; i++) {
+      Object* link = roots->get(i);
+      for (int j = 0; j < kDepth; j++) {
+        CHECK(link->IsFixedArray());
+        CHECK_EQ(i + 0.5, FixedArray::cast(link)->get(0)->Number());
+        link = FixedArray::cast(link)->get(1);
+      }
+      CHECK(link->IsUndefined());
+    }
+  }
+  CHECK(!Heap::InNewSpace(roots->get(0)));
+
+  // The remembered set of the promoted chains must be usable by the next
+  // collections.
+  Heap::CollectAllGarbage(false);
+
+  FLAG_gc_parallel_scavenge_threads = 1;
+}
+
+
+TEST(StoreBufferScavengeCost) {
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // Fill the old pointer space with arrays, only a few of which point into
+  // new space.  The scavenges should not have to look at the rest.
+  const int kArrays = 2000;
+  const int kLength = 500;
+  const int kYoung = 10;
+  Handle<FixedArray> arrays = Factory::NewFixedArray(kArrays, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    v8::HandleScope inner;
+    arrays->set(i, *Factory::NewFixedArray(kLength, TENURED));
+  }
+  for (int i = 0; i < kYoung; i++) {
+    v8::HandleScope inner;
+    Handle<Object> number = Factory::NewNumber(i + 0.5);
+    FixedArray::cast(arrays->get(i * (kArrays / kYoung)))->set(i, *number);
+  }
+
+  const int kScavenges = 10;
+  double start = OS::TimeCurrentMillis();
+  for (int k = 0; k < kScavenges; k++) {
+    Heap::PerformScavenge();
+  }
+  double time = OS::TimeCurrentMillis() - start;
+  PrintF("%d scavenges with %d KB of old pointer space: %.3f ms\n",
+         kScavenges,
+         static_cast<int>(Heap::old_pointer_space()->Size() / KB),
+         time);
+
+  for (int i = 0; i < kYoung; i++) {
+    Object* number =
+        FixedArray::cast(arrays->get(i * (kArrays / kYoung)))->get(i);
+    CHECK(number->IsHeapNumber());
+    CHECK_EQ(i + 0.5, number->Number());
+  }
+}
+
+
+TEST(AdaptiveNewSpace) {
+  FLAG_adaptive_new_space = true;
+  InitializeVM();
+  NewSpace* new_space = Heap::new_space();
+  int initial_capacity = new_space->Capacity();
+  CHECK_EQ(new_space->InitialCapacity(), initial_capacity);
+
+  // Everything allocated survives and the scavenges are well within the
+  // budget, so the new space grows.
+  FLAG_scavenge_pause_budget = 100000;
+  {
+    v8::HandleScope sc;
+    for (int i = 0; i < 4 && new_space->Capacity() == initial_capacity; i++) {
+      while (new_space->Available() > initial_capacity / 2) {
+        Factory::NewFixedArray(100);
+      }
+      Heap::PerformScavenge();
+    }
+  }
+  CHECK_GT(new_space->Capacity(), initial_capacity);
+
+  // A scavenge over the budget shrinks it again, but not below its initial
+  // capacity.
+  FLAG_scavenge_pause_budget = -1;
+  while (new_space->Capacity() > initial_capacity) {
+    int capacity = new_space->Capacity();
+    Heap::PerformScavenge();
+    CHECK_GT(capacity, new_space->Capacity());
+  }
+  Heap::PerformScavenge();
+  CHECK_EQ(initial_capacity, new_space->Capacity());
+
+  FLAG_scavenge_pause_budget = 4;
+}
+
+
+static JSObject* GlobalJSObject(const char* name) {
+  Object* value =
+      Top::context()->global()->GetProperty(*Factory::LookupAsciiSymbol(name));
+  CHECK(value->IsJSObject());
+  return JSObject::cast(value);
+}
+
+
+TEST(Pretenuring) {
+  FLAG_pretenuring = true;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // Objects from constructors, object literals and array literals that all
+  // stay alive, as when loading data.
+  CompileRun(
+      "function Point(x, y) { this.x = x; this.y = y; }"
+      "function object(i) { return {a: i, b: i}; }"
+      "function array(i) { return [i, i]; }"
+      "var data = [];"
+      "for (var i = 0; i < 100000; i++) {"
+      "  data.push(new Point(i, i), object(i), array(i));"
+      "}"
+      "var last_point = new Point(0, 0);"
+      "var last_object = object(0);"
+      "var last_array = array(0);");
+
+  // The sites have been switched to allocating in old space.
+  const char* names[] = { "last_point", "last_object", "last_array" };
+  for (int i = 0; i < 3; i++) {
+    JSObject* object = GlobalJSObject(names[i]);
+    CHECK(object->map()->is_pretenured());
+    CHECK(!Heap::InNewSpace(object));
+  }
+  CHECK_EQ(0, Smi::cast(GlobalJSObject("last_point")->InObjectPropertyAt(0))
+                  ->value());
+  CHECK_EQ(0, Smi::cast(GlobalJSObject("last_array")->GetElement(1))->value());
+}
+
+
+TEST(StoreBufferRecordsStoresFromGeneratedCode) {
+  InitializeVM();
+  v8::HandleScope sc;
+
+  CompileRun("function Holder() { this.value = 0; }"
+             "var holder = new Holder();");
+  Heap::CollectGarbage(0, NEW_SPACE);
+  Heap::CollectGarbage(0, NEW_SPACE);
+  CHECK(!Heap::InNewSpace(GlobalJSObject("holder")));
+
+  // The store IC, set up on young objects, writes young strings into the
+  // old object.  The scavenge only updates the field if the IC recorded
+  // its slot, which the heap verification checks.
+  CompileRun("function store(o, v) { o.value = v; }"
+             "for (var i = 0; i < 3; i++) store(new Holder(), i);"
+             "for (var i = 0; i < 10; i++) store(holder, 'value ' + i);");
+#ifdef DEBUG
+  Heap::Verify();
+#endif
+  Heap::CollectGarbage(0, NEW_SPACE);
+  Object* value = GlobalJSObject("holder")->InObjectPropertyAt(0);
+  CHECK(String::cast(value)->IsEqualTo(CStrVector("value 9")));
+}
+
+
+TEST(SelectiveEvacuation) {
+  FLAG_never_compact = true;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // Fill old pointer space pages with arrays and keep every 16th alive, so
+  // that a full GC leaves the pages mostly free.  Each survivor points to
+  // the previous one and to a number in new space.
+  const int kArrays = 2000;
+  const int kLength = 20;
+  const int kStep = 16;
+  Handle<FixedArray> arrays = Factory::NewFixedArray(kArrays, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    v8::HandleScope inner;
+    Handle<FixedArray> array = Factory::NewFixedArray(kLength, TENURED);
+    for (int j = 2; j < kLength; j++) array->set(j, Smi::FromInt(i + j));
+    arrays->set(i, *array);
+  }
+  for (int i = 0; i < kArrays; i++) {
+    if (i % kStep != 0) {
+      arrays->set(i, Smi::FromInt(0));
+      continue;
+    }
+    v8::HandleScope inner;
+    FixedArray* array = FixedArray::cast(arrays->get(i));
+    array->set(0, i == 0 ? Smi::FromInt(0) : arrays->get(i - kStep));
+    array->set(1, *Factory::NewNumber(i + 0.5));
+  }
+  Heap::CollectAllGarbage(false);
+
+  // The next full GC moves the survivors out of the most fragmented pages.
+  Address* addresses = NewArray<Address>(kArrays);
+  for (int i = 0; i < kArrays; i += kStep) {
+    addresses[i] = HeapObject::cast(arrays->get(i))->address();
+  }
+  Heap::CollectAllGarbage(false);
+
+  int moved = 0;
+  for (int i = 0; i < kArrays; i += kStep) {
+    FixedArray* array = FixedArray::cast(arrays->get(i));
+    if (array->address() != addresses[i]) moved++;
+    CHECK(Heap::old_pointer_space()->Contains(array));
+    if (i > 0) CHECK_EQ(arrays->get(i - kStep), array->get(0));
+    CHECK_EQ(i + 0.5, array->get(1)->Number());
+    for (int j = 2; j < kLength; j++) {
+      CHECK_EQ(i + j, Smi::cast(array->get(j))->value());
+    }
+  }
+  DeleteArray(addresses);
+  CHECK_GT(moved, 0);
+}
+
+
+TEST(OldSpaceAllocationBuffer) {
+  FLAG_max_evacuation_candidates = 0;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // Leave holes of a few KB between the survivors in the old pointer space,
+  // so that allocation goes to the free list once the top page is full.
+  const int kArrays = 1000;
+  const int kLength = 100;
+  const int kStep = 8;
+  Handle<FixedArray> arrays = Factory::NewFixedArray(kArrays, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    v8::HandleScope inner;
+    arrays->set(i, *Factory::NewFixedArray(kLength, TENURED));
+  }
+  for (int i = 0; i < kArrays; i++) {
+    if (i % kStep != 0) arrays->set(i, Smi::FromInt(0));
+  }
+  Heap::CollectAllGarbage(false);
+
+  // Small objects are bump allocated in the allocation buffer, so most of
+  // them follow the previous one.
+  const int kSmallArrays = 10000;
+  const int kSmallLength = 8;
+  Handle<FixedArray> small_arrays =
+      Factory::NewFixedArray(kSmallArrays, TENURED);
+  int contiguous = 0;
+  Address previous_end = NULL;
+  double start = OS::TimeCurrentMillis();
+  for (int i = 0; i < kSmallArrays; i++) {
+    v8::HandleScope inner;
+    Handle<FixedArray> array = Factory::NewFixedArray(kSmallLength, TENURED);
+    array->set(0, Smi::FromInt(i));
+    small_arrays->set(i, *array);
+    Address address = array->address();
+    if (address == previous_end) contiguous++;
+    previous_end = address + FixedArray::SizeFor(kSmallLength);
+  }
+  double time = OS::TimeCurrentMillis() - start;
+  PrintF("%d tenured allocations, %d contiguous: %.3f ms\n",
+         kSmallArrays,
+         contiguous,
+         time);
+  CHECK_GT(contiguous, kSmallArrays / 2);
+
+  // The unused part of the buffer does not stop the heap from being
+  // iterated or collected.
+  Handle<Object> objs[3];
+  objs[0] = small_arrays;
+  objs[1] = Handle<Object>(small_arrays->get(0));
+  objs[2] = Handle<Object>(small_arrays->get(kSmallArrays - 1));
+  CHECK_EQ(3, ObjectsFoundInHeap(objs, 3));
+  Heap::CollectAllGarbage(false);
+  for (int i = 0; i < kSmallArrays; i++) {
+    FixedArray* array = FixedArray::cast(small_arrays->get(i));
+    CHECK(Heap::old_pointer_space()->Contains(array));
+    CHECK_EQ(i, Smi::cast(array->get(0))->value());
+  }
+}
+
+
+
+static double AllocateAndFreeLargeChunks(int count, int size) {
+  double start = OS::TimeCurrentMillis();
+  for (int i = 0; i < count; i++) {
+    size_t chunk_size;
+    void* mem = MemoryAllocator::AllocateLargeObjectMemory(size,
+                                                           &chunk_size,
+                                                           NOT_EXECUTABLE);
+    CHECK(mem != NULL);
+    // Touch every OS page, like filling a large array does.
+    size_t page_size = OS::AllocateAlignment();
+    for (size_t offset = 0; offset < chunk_size; offset += page_size) {
+      static_cast<char*>(mem)[offset] = 1;
+    }
+    MemoryAllocator::FreeLargeObjectMemory(mem, chunk_size, NOT_EXECUTABLE);
+  }
+  return OS::TimeCurrentMillis() - start;
+}
+
+
+TEST(LargeObjectChunkCache) {
+  InitializeVM();
+  v8::HandleScope sc;
+
+  const int kChunks = 200;
+  const int kChunkSize = 2 * MB;
+  const int kLength = 256 * KB;
+
+  // Without the cache every chunk is mapped and faulted in afresh.
+  FLAG_large_object_cache_size = 0;
+  double uncached_time = AllocateAndFreeLargeChunks(kChunks, kChunkSize);
+  CHECK_EQ(0, MemoryAllocator::LargeObjectCacheSize());
+  FLAG_large_object_cache_size = 16;
+  double cached_time = AllocateAndFreeLargeChunks(kChunks, kChunkSize);
+  CHECK_GT(MemoryAllocator::LargeObjectCacheSize(), 0);
+  PrintF("%d large object chunks: %.3f ms uncached, %.3f ms cached\n",
+         kChunks,
+         uncached_time,
+         cached_time);
+  MemoryAllocator::FlushLargeObjectCache();
+  CHECK_EQ(0, MemoryAllocator::LargeObjectCacheSize());
+
+  // The chunk of a dead array is reused by the next one.
+  Address address;
+  {
+    v8::HandleScope inner;
+    address = Factory::NewFixedArray(kLength, TENURED)->address();
+  }
+  Heap::CollectGarbage(0, LO_SPACE);
+  CHECK_GT(MemoryAllocator::LargeObjectCacheSize(), 0);
+  {
+    v8::HandleScope inner;
+    Handle<FixedArray> array = Factory::NewFixedArray(kLength, TENURED);
+    CHECK_EQ(address, array->address());
+    CHECK_EQ(0, MemoryAllocator::LargeObjectCacheSize());
+    array->set(kLength - 1, Smi::FromInt(0));
+  }
+  Heap::CollectGarbage(0, LO_SPACE);
+
+  // Released chunks stay cached and are still reused.
+  int cache_size = MemoryAllocator::LargeObjectCacheSize();
+  CHECK_GT(cache_size, 0);
+  MemoryAllocator::ReleaseLargeObjectCache();
+  CHECK_EQ(cache_size, MemoryAllocator::LargeObjectCacheSize());
+  {
+    v8::HandleScope inner;
+    Handle<FixedArray> array = Factory::NewFixedArray(kLength, TENURED);
+    CHECK_EQ(address, array->address());
+    CHECK(array->get(kLength - 1)->IsUndefined());
+    CHECK_EQ(0, MemoryAllocator::LargeObjectCacheSize());
+  }
+}
+
+
+// Times scavenges and full GCs of a heap modelled on benchmarks/splay.js:
+// a large live set of small payload trees whose members are continuously
+// replaced.  Compare the output of SplayGCTime and
+// SplayGCTimeWithHugePages to see the effect of --transparent_huge_pages.
+static void RunSplayGCBenchmark(bool huge_pages) {
+  FLAG_transparent_huge_pages = huge_pages;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  CompileRun(
+      "function GeneratePayloadTree(depth, tag) {"
+      "  if (depth == 0) {"
+      "    return { array: [0, 1, 2, 3, 4, 5, 6, 7, 8, 9],"
+      "             string: 'String for key ' + tag + ' in leaf node' };"
+      "  }"
+      "  return { left: GeneratePayloadTree(depth - 1, tag),"
+      "           right: GeneratePayloadTree(depth - 1, tag) };"
+      "}"
+      "var nodes = [];"
+      "for (var i = 0; i < 2000; i++) {"
+      "  nodes.push({ key: i, value: GeneratePayloadTree(5, String(i)) });"
+      "}"
+      "var next = 0;"
+      "function Replace(count) {"
+      "  for (var i = 0; i < count; i++) {"
+      "    nodes[next] = { key: next,"
+      "                    value: GeneratePayloadTree(5, String(next)) };"
+      "    next = (next + 1) % nodes.length;"
+      "  }"
+      "}");
+
+  const int kCollections = 10;
+  double scavenge_time = 0;
+  for (int i = 0; i < kCollections; i++) {
+    CompileRun("Replace(50)");
+    double start = OS::TimeCurrentMillis();
+    Heap::CollectGarbage(0, NEW_SPACE);
+    scavenge_time += OS::TimeCurrentMillis() - start;
+  }
+  double mark_compact_time = 0;
+  for (int i = 0; i < kCollections; i++) {
+    CompileRun("Replace(50)");
+    double start = OS::TimeCurrentMillis();
+    Heap::CollectAllGarbage(false);
+    mark_compact_time += OS::TimeCurrentMillis() - start;
+  }
+  PrintF("%d KB heap, huge pages %s: %.3f ms per scavenge, "
+         "%.3f ms per full GC\n",
+         Heap::SizeOfObjects() / KB,
+         MemoryAllocator::UseHugePages() ? "on" : "off",
+         scavenge_time / kCollections,
+         mark_compact_time / kCollections);
+}
+
+
+TEST(SplayGCTime) {
+  RunSplayGCBenchmark(false);
+}
+
+
+TEST(SplayGCTimeWithHugePages) {
+  RunSplayGCBenchmark(true);
+
+  // The old pointer space has grown in huge page aligned chunks.
+  if (MemoryAllocator::UseHugePages()) {
+    PageIterator it(Heap::old_pointer_space(), PageIterator::PAGES_IN_USE);
+    Address first_page = it.next()->address();
+    CHECK_EQ(0, OffsetFrom(first_page) % OS::HugePageSize());
+  }
+}
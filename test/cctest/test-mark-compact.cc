@@ -339,3 +339,127 @@ TEST(ObjectGroups) {
   // All objects should be gone. 5 global handles in total.
   CHECK_EQ(5, NumberOfWeakCalls);
 }
+
+
+TEST(IncrementalMarking) {
+  InitializeVM();
+  v8::HandleScope sc;
+
+  Handle<FixedArray> holder = Factory::NewFixedArray(2, TENURED);
+  CHECK(Heap::InSpace(*holder, OLD_POINTER_SPACE));
+
+  // Mark the heap incrementally until the holder has been visited.
+  IncrementalMarking::Start();
+  while (!IncrementalMarking::IsComplete()) {
+    IncrementalMarking::Step(FLAG_incremental_marking_step_size * KB);
+  }
+
+  // Store objects that have not been marked into the marked holder, so
+  // that the holder is the only thing keeping them alive.
+  {
+    v8::HandleScope inner;
+    Handle<FixedArray> old_value = Factory::NewFixedArray(3, TENURED);
+    old_value->set(0, Smi::FromInt(42));
+    holder->set(0, *old_value);
+    holder->set(1, *Factory::NewStringFromAscii(CStrVector("young")));
+  }
+  CHECK(IncrementalMarking::IsMarking());
+
+  // Scavenges process the remembered set while marking is in progress.
+  Heap::PerformScavenge();
+  CHECK(IncrementalMarking::IsMarking());
+
+  // The next full collection finishes the marking.
+  CHECK(Heap::CollectGarbage(0, OLD_POINTER_SPACE));
+  CHECK(IncrementalMarking::IsStopped());
+
+  CHECK(holder->get(0)->IsFixedArray());
+  FixedArray* old_value = FixedArray::cast(holder->get(0));
+  CHECK_EQ(3, old_value->length());
+  CHECK_EQ(Smi::FromInt(42), old_value->get(0));
+  CHECK(holder->get(1)->IsString());
+  CHECK(String::cast(holder->get(1))->IsEqualTo(CStrVector("young")));
+}
+
+
+TEST(LazySweeping) {
+  InitializeVM();
+  if (!FLAG_lazy_sweeping || FLAG_always_compact) return;
+  v8::HandleScope sc;
+
+  // Fill several pages of the old data space with strings, of which only
+  // the first one stays alive.
+  char buffer[1024];
+  memset(buffer, 'x', sizeof(buffer));
+  Vector<const char> contents(buffer, sizeof(buffer));
+  Handle<String> survivor = Factory::NewStringFromAscii(contents, TENURED);
+  {
+    v8::HandleScope inner;
+    for (int i = 0; i < 64; i++) {
+      Factory::NewStringFromAscii(contents, TENURED);
+    }
+  }
+  CHECK(Heap::InSpace(*survivor, OLD_DATA_SPACE));
+
+  // A non-compacting collection leaves the pages below the allocation top
+  // unswept, but the dead strings are counted as available.
+  int size_before = Heap::old_data_space()->Size();
+  CHECK(Heap::CollectGarbage(0, OLD_DATA_SPACE));
+  CHECK(!Heap::old_data_space()->IsSweepingComplete());
+  CHECK(Heap::old_data_space()->Size() <
+        size_before - 64 * static_cast<int>(sizeof(buffer)));
+  CHECK(survivor->IsEqualTo(contents));
+
+  // Allocation sweeps the pages on demand.
+  {
+    v8::HandleScope inner;
+    while (!Heap::old_data_space()->IsSweepingComplete()) {
+      Factory::NewStringFromAscii(contents, TENURED);
+    }
+  }
+  CHECK(survivor->IsEqualTo(contents));
+
+  // The next collection finds the space fully swept.
+  CHECK(Heap::CollectGarbage(0, OLD_DATA_SPACE));
+  CHECK(survivor->IsEqualTo(contents));
+}
+
+
+TEST(ParallelMarking) {
+  FLAG_gc_parallel_marking_threads = 4;
+  InitializeVM();
+  v8::HandleScope sc;
+
+  // A wide array overflows the marking stack and the deques of the
+  // markers.  Every element heads a short chain of arrays.
+  const int kWidth = 20000;
+  const int kDepth = 4;
+  Handle<FixedArray> roots = Factory::NewFixedArray(kWidth, TENURED);
+  for (int i = 0; i < kWidth; i++) {
+    v8::HandleScope inner;
+    Handle<FixedArray> chain = Factory::NewFixedArray(2, TENURED);
+    chain->set(0, Smi::FromInt(i));
+    roots->set(i, *chain);
+    for (int j = 1; j < kDepth; j++) {
+      Handle<FixedArray> link = Factory::NewFixedArray(2, TENURED);
+      link->set(0, Smi::FromInt(i));
+      chain->set(1, *link);
+      chain = link;
+    }
+  }
+
+  CHECK(Heap::CollectGarbage(0, OLD_POINTER_SPACE));
+  CHECK(Heap::CollectGarbage(0, OLD_POINTER_SPACE));
+
+  for (int i = 0; i < kWidth; i++) {
+    Object* link = roots->get(i);
+    for (int j = 0; j < kDepth; j++) {
+      CHECK(link->IsFixedArray());
+      CHECK_EQ(Smi::FromInt(i), FixedArray::cast(link)->get(0));
+      link = FixedArray::cast(link)->get(1);
+    }
+    CHECK(link->IsUndefined());
+  }
+
+  FLAG_gc_parallel_marking_threads = 1;
+}
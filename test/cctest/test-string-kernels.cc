@@ -0,0 +1,327 @@
+// Copyright 2006-2008 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Check the string kernels against simple loops for all short lengths and
+// alignments, so the unaligned heads and overlapping tails of the SSE2
+// versions are covered, and measure their throughput on long inputs.
+
+#include <stdio.h>
+
+#include "v8.h"
+
+#include "platform.h"
+#include "string-kernels.h"
+#include "cctest.h"
+
+using namespace v8::internal;
+
+static const int kMaxOffset = 16;
+static const int kMaxLength = 70;
+static const int kBufferSize = kMaxOffset + kMaxLength;
+
+
+static void InitializeVM() {
+  static v8::Persistent<v8::Context> env;
+  if (env.IsEmpty()) {
+    v8::HandleScope scope;
+    env = v8::Context::New();
+  }
+}
+
+
+template <typename Char>
+static int ExpectedIndexOf(const Char* chars, int length, Char c) {
+  for (int i = 0; i < length; i++) {
+    if (chars[i] == c) return i;
+  }
+  return -1;
+}
+
+
+// There is no SSE2 version for ASCII strings, which use memchr.
+static void CheckIndexOfSSE2(const char* chars, int length, char c,
+                             int expected) {
+}
+
+
+static void CheckIndexOfSSE2(const uc16* chars, int length, uc16 c,
+                             int expected) {
+#ifdef V8_SSE2_STRING_KERNELS
+  if (StringKernels::use_sse2() && length >= StringKernels::kMinSSE2Length) {
+    CHECK_EQ(expected, StringKernels::IndexOfSSE2(chars, length, c));
+  }
+#endif
+}
+
+
+template <typename Char>
+static void CheckIndexOf(const Char* chars, int length, Char c) {
+  int expected = ExpectedIndexOf(chars, length, c);
+  CHECK_EQ(expected, StringKernels::IndexOf(chars, length, c));
+  CHECK_EQ(expected, StringKernels::IndexOfGeneric(chars, length, c));
+  CheckIndexOfSSE2(chars, length, c, expected);
+}
+
+
+template <typename Char>
+static void CheckMismatch(const Char* a, const Char* b, int length,
+                          int expected) {
+  CHECK_EQ(expected, StringKernels::Mismatch(a, b, length));
+  CHECK_EQ(expected, StringKernels::MismatchGeneric(a, b, length));
+#ifdef V8_SSE2_STRING_KERNELS
+  if (StringKernels::use_sse2() && length >= StringKernels::kMinSSE2Length) {
+    CHECK_EQ(expected, StringKernels::MismatchSSE2(a, b, length));
+  }
+#endif
+  int compare = StringKernels::Compare(a, b, length);
+  if (expected == length) {
+    CHECK_EQ(0, compare);
+  } else if (a[expected] < b[expected]) {
+    CHECK_GT(0, compare);
+  } else {
+    CHECK_GT(compare, 0);
+  }
+}
+
+
+template <typename Char>
+static void CheckIsAscii(const Char* chars, int length, bool expected) {
+  CHECK_EQ(expected, StringKernels::IsAscii(chars, length));
+  CHECK_EQ(expected, StringKernels::IsAsciiGeneric(chars, length));
+#ifdef V8_SSE2_STRING_KERNELS
+  if (StringKernels::use_sse2() && length >= StringKernels::kMinSSE2Length) {
+    CHECK_EQ(expected, StringKernels::IsAsciiSSE2(chars, length));
+  }
+#endif
+}
+
+
+template <typename Char>
+static void FillBuffer(Char* buffer) {
+  for (int i = 0; i < kBufferSize; i++) {
+    buffer[i] = static_cast<Char>('a' + i % 26);
+  }
+}
+
+
+template <typename Char>
+static void TestIndexOf(Char needle) {
+  Char buffer[kBufferSize];
+  for (int offset = 0; offset < kMaxOffset; offset++) {
+    for (int length = 0; length <= kMaxLength; length++) {
+      FillBuffer(buffer);
+      Char* chars = buffer + offset;
+      CheckIndexOf(chars, length, needle);
+      for (int i = 0; i < length; i++) {
+        FillBuffer(buffer);
+        chars[i] = needle;
+        CheckIndexOf(chars, length, needle);
+        // The first of two occurrences is found.
+        chars[length - 1] = needle;
+        CheckIndexOf(chars, length, needle);
+      }
+      FillBuffer(buffer);
+      // An occurrence just after the end must not be found.
+      if (offset + length < kBufferSize) {
+        chars[length] = needle;
+        CheckIndexOf(chars, length, needle);
+      }
+    }
+  }
+}
+
+
+template <typename Char>
+static void TestMismatch(const Char* differences, int count) {
+  Char a[kBufferSize];
+  Char b[kBufferSize];
+  FillBuffer(a);
+  for (int offset = 0; offset < kMaxOffset; offset++) {
+    // Compare against an input at a different alignment.
+    int other_offset = (offset * 7 + 3) % kMaxOffset;
+    for (int length = 0; length <= kMaxLength; length++) {
+      FillBuffer(b);
+      for (int i = 0; i < length; i++) {
+        b[other_offset + i] = a[offset + i];
+      }
+      CheckMismatch(a + offset, b + other_offset, length, length);
+      for (int i = 0; i < length; i++) {
+        for (int j = 0; j < count; j++) {
+          Char saved = b[other_offset + i];
+          b[other_offset + i] = differences[j];
+          CheckMismatch(a + offset, b + other_offset, length, i);
+          b[other_offset + i] = saved;
+        }
+      }
+    }
+  }
+}
+
+
+template <typename Char>
+static void TestIsAscii(const Char* non_ascii, int count) {
+  Char buffer[kBufferSize];
+  for (int offset = 0; offset < kMaxOffset; offset++) {
+    for (int length = 0; length <= kMaxLength; length++) {
+      FillBuffer(buffer);
+      Char* chars = buffer + offset;
+      // Characters just before the start and after the end do not count.
+      if (offset > 0) chars[-1] = non_ascii[0];
+      if (offset + length < kBufferSize) chars[length] = non_ascii[0];
+      CheckIsAscii(chars, length, true);
+      if (length > 0) {
+        chars[length - 1] = 0x7F;
+        CheckIsAscii(chars, length, true);
+      }
+      for (int i = 0; i < length; i++) {
+        for (int j = 0; j < count; j++) {
+          Char saved = chars[i];
+          chars[i] = non_ascii[j];
+          CheckIsAscii(chars, length, false);
+          chars[i] = saved;
+        }
+      }
+    }
+  }
+}
+
+
+TEST(StringKernelsIndexOf) {
+  InitializeVM();
+  TestIndexOf<char>('!');
+  TestIndexOf<char>(static_cast<char>(0xE9));
+  TestIndexOf<uc16>('!');
+  TestIndexOf<uc16>(0x2100 + 'a');
+  TestIndexOf<uc16>(0xFFFF);
+}
+
+
+TEST(StringKernelsMismatch) {
+  InitializeVM();
+  const char char_differences[] = { '\0', '!', 0x7F };
+  TestMismatch(char_differences, ARRAY_SIZE(char_differences));
+  const uc16 uc16_differences[] = { 0, '!', 0x0100 + 'a', 0x8000, 0xFFFF };
+  TestMismatch(uc16_differences, ARRAY_SIZE(uc16_differences));
+}
+
+
+TEST(StringKernelsIsAscii) {
+  InitializeVM();
+  const char char_non_ascii[] = { static_cast<char>(0x80),
+                                  static_cast<char>(0xFF) };
+  TestIsAscii(char_non_ascii, ARRAY_SIZE(char_non_ascii));
+  const uc16 uc16_non_ascii[] = { 0x80, 0xFF, 0x0100, 0x0100 + 'a', 0xFF80 };
+  TestIsAscii(uc16_non_ascii, ARRAY_SIZE(uc16_non_ascii));
+}
+
+
+// Micro-benchmarks.  They print the throughput of the generic and, where
+// available, the SSE2 versions of the kernels on long inputs.
+
+static const int kBenchmarkLength = 1 * MB;
+static const int kBenchmarkBytes = 64 * MB;
+
+
+static void PrintThroughput(const char* name, int bytes, double time) {
+  if (time < 1) time = 1;
+  printf("%-24s %8.0f MB/s\n", name, bytes / (time * 1000));
+}
+
+
+template <typename Char>
+static void BenchmarkKernels(const char* type_name) {
+  Char* a = NewArray<Char>(kBenchmarkLength);
+  Char* b = NewArray<Char>(kBenchmarkLength);
+  for (int i = 0; i < kBenchmarkLength; i++) {
+    a[i] = b[i] = static_cast<Char>('a' + i % 26);
+  }
+  Char needle = '!';
+  int bytes = kBenchmarkLength * sizeof(Char);
+  int iterations = kBenchmarkBytes / bytes;
+  int total = iterations * bytes;
+  int result = 0;
+  EmbeddedVector<char, 64> name;
+
+  for (int sse2 = 0; sse2 <= 1; sse2++) {
+#ifdef V8_SSE2_STRING_KERNELS
+    if (sse2 && !StringKernels::use_sse2()) break;
+#else
+    if (sse2) break;
+#endif
+    const char* kind = sse2 ? "SSE2" : "generic";
+
+    double start = OS::TimeCurrentMillis();
+    for (int i = 0; i < iterations; i++) {
+      // The dispatching version uses SSE2 where there is a kernel for it.
+      if (sse2) {
+        result += StringKernels::IndexOf(a, kBenchmarkLength, needle);
+      } else {
+        result += StringKernels::IndexOfGeneric(a, kBenchmarkLength, needle);
+      }
+    }
+    OS::SNPrintF(name, "IndexOf %s %s", type_name, kind);
+    PrintThroughput(name.start(), total, OS::TimeCurrentMillis() - start);
+
+    start = OS::TimeCurrentMillis();
+    for (int i = 0; i < iterations; i++) {
+#ifdef V8_SSE2_STRING_KERNELS
+      if (sse2) {
+        result += StringKernels::MismatchSSE2(a, b, kBenchmarkLength);
+        continue;
+      }
+#endif
+      result += StringKernels::MismatchGeneric(a, b, kBenchmarkLength);
+    }
+    OS::SNPrintF(name, "Mismatch %s %s", type_name, kind);
+    PrintThroughput(name.start(), total, OS::TimeCurrentMillis() - start);
+
+    start = OS::TimeCurrentMillis();
+    for (int i = 0; i < iterations; i++) {
+#ifdef V8_SSE2_STRING_KERNELS
+      if (sse2) {
+        result += StringKernels::IsAsciiSSE2(a, kBenchmarkLength);
+        continue;
+      }
+#endif
+      result += StringKernels::IsAsciiGeneric(a, kBenchmarkLength);
+    }
+    OS::SNPrintF(name, "IsAscii %s %s", type_name, kind);
+    PrintThroughput(name.start(), total, OS::TimeCurrentMillis() - start);
+  }
+  // Use the results so the loops are not optimized away.
+  CHECK_NE(0, result);
+  DeleteArray(a);
+  DeleteArray(b);
+}
+
+
+TEST(StringKernelsThroughput) {
+  InitializeVM();
+  BenchmarkKernels<char>("ascii");
+  BenchmarkKernels<uc16>("two-byte");
+}
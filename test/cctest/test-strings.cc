@@ -11,6 +11,7 @@
 
 #include "api.h"
 #include "factory.h"
+#include "runtime.h"
 #include "cctest.h"
 #include "zone-inl.h"
 
@@ -301,6 +302,94 @@ TEST(DeepAscii) {
 }
 
 
+// Checks the segments of s against the characters of the flat string
+// starting at offset.
+static void IterateSegments(Handle<String> flat,
+                            Handle<String> s,
+                            int offset) {
+  ConsStringIterator iterator(*s, offset);
+  int position = offset;
+  while (iterator.Next()) {
+    CHECK_EQ(position, iterator.offset());
+    CHECK(iterator.length() > 0);
+    for (int i = 0; i < iterator.length(); i++) {
+      uint16_t c = iterator.is_ascii() ? iterator.ToAsciiVector()[i]
+                                       : iterator.ToUC16Vector()[i];
+      CHECK_EQ(flat->Get(position + i), c);
+    }
+    position += iterator.length();
+  }
+  CHECK_EQ(flat->length(), position);
+  CHECK(!iterator.Next());
+}
+
+
+static void SearchSegments(Handle<String> flat, Handle<String> s) {
+  for (int i = 0; i < 100; i++) {
+    int length = 1 + gen() % 40;
+    int start = gen() % (flat->length() - length);
+    Handle<String> pattern = Factory::NewSubString(flat, start, start + length);
+    int expected = Runtime::StringMatch(flat, pattern, 0);
+    CHECK(expected >= 0 && expected <= start);
+    CHECK(!s->IsFlat());
+    CHECK_EQ(expected, Runtime::StringMatch(s, pattern, 0));
+  }
+}
+
+
+TEST(ConsStringIterator) {
+  InitializeVM();
+  v8::HandleScope scope;
+  Handle<String> building_blocks[NUMBER_OF_BUILDING_BLOCKS];
+  ZoneScope zone(DELETE_ON_EXIT);
+  InitializeBuildingBlocks(building_blocks);
+  Handle<String> flat = ConstructBalanced(building_blocks);
+  FlattenString(flat);
+  Handle<String> strings[] = {
+    ConstructLeft(building_blocks, DEEP_DEPTH),
+    ConstructRight(building_blocks, DEEP_DEPTH),
+    ConstructBalanced(building_blocks)
+  };
+  for (unsigned i = 0; i < ARRAY_SIZE(strings); i++) {
+    Handle<String> s = strings[i];
+    CHECK_EQ(flat->length(), s->length());
+    IterateSegments(flat, s, 0);
+    IterateSegments(flat, s, flat->length());
+    for (int j = 0; j < 10; j++) {
+      IterateSegments(flat, s, gen() % flat->length());
+    }
+    CHECK_EQ(0, ConsStringIterator::Compare(*flat, *s, flat->length()));
+    CHECK(flat->Equals(*s));
+    SearchSegments(flat, s);
+  }
+
+  // Strings that differ in a single character.
+  Handle<String> x = Factory::NewStringFromAscii(CStrVector("x"));
+  Handle<String> y = Factory::NewStringFromAscii(CStrVector("y"));
+  Handle<String> left_x = Factory::NewConsString(strings[0], x);
+  Handle<String> left_y = Factory::NewConsString(strings[0], y);
+  Handle<String> right_x = Factory::NewConsString(strings[1], x);
+  CHECK_EQ('x' - 'y',
+           ConsStringIterator::Compare(*left_x, *left_y, left_x->length()));
+  CHECK(!left_x->Equals(*left_y));
+  CHECK(left_x->Equals(*right_x));
+
+  // Hashing the segments of a cons string gives the hash of the flat copy.
+  Handle<String> short_left = ConstructLeft(building_blocks, 20);
+  Handle<String> short_right = ConstructRight(building_blocks, 20);
+  CHECK(short_left->length() <= String::kMaxHashCalcLength);
+  ScopedVector<uc16> chars(short_left->length());
+  String::WriteToFlat(*short_left, chars.start(), 0, chars.length());
+  Handle<String> short_flat =
+      Factory::NewStringFromTwoByte(Vector<const uc16>(chars.start(),
+                                                       chars.length()));
+  CHECK(StringShape(*short_flat).IsSequential());
+  CHECK(StringShape(*short_right).IsCons());
+  CHECK_EQ(static_cast<int>(short_flat->Hash()),
+           static_cast<int>(short_right->Hash()));
+}
+
+
 TEST(Utf8Conversion) {
   // Smoke test for converting strings to utf-8.
   InitializeVM();
@@ -158,6 +158,24 @@ assertEquals({"a": {"b": 1, "c": 2}, "d": {"e": {"f": 3}}},
 assertEquals({"a": {"b": 2, "c": 4}, "d": {"e": {"f": 6}}},
              JSON.parse(deepObject, DoubleNumbers));
 
+// Parsed properties are own properties, setters and read-only properties
+// on the prototype chain are ignored.
+Object.prototype.__defineSetter__('jsonSetter', function() {
+  throw "setter called";
+});
+assertEquals(1, JSON.parse('{"jsonSetter": 1}').jsonSetter);
+delete Object.prototype.jsonSetter;
+var protoKey = JSON.parse('{"__proto__": {"x": 1}}');
+assertTrue(protoKey.hasOwnProperty('__proto__'));
+assertEquals(undefined, protoKey.x);
+
+// Repeated keys and keys in different orders.
+assertEquals({"a": 2}, JSON.parse('{"a": 1, "a": 2}'));
+var records = JSON.parse('[{"x": 1, "y": 2}, {"y": 3, "x": 4}, {"x": 5}]');
+assertEquals([{"x": 1, "y": 2}, {"x": 4, "y": 3}, {"x": 5}], records);
+assertEquals({"0": "a", "b": "c", "1": "d"},
+             JSON.parse('{"0": "a", "b": "c", "1": "d"}'));
+
 function TestInvalid(str) {
   assertThrows(function () { JSON.parse(str); }, SyntaxError);
 }
@@ -308,6 +326,30 @@ assertEquals('{}',
                                              if (k == "d") return function(){};
                                              return v; }));
 
+// Nested objects and arrays with a gap, escaped characters and values that
+// are not plain objects.
+assertEquals('{\n  "a": [\n    1,\n    {\n      "b": null\n    },\n    []\n' +
+             '  ],\n  "c": {}\n}',
+             JSON.stringify({a: [1, {b: null}, []], c: {}}, null, 2));
+assertEquals('"\\"\\\\\\b\\f\\n\\r\\t\\u0001\\u001f\\u00e9\\u1234"',
+             JSON.stringify('"\\\b\f\n\r\t\x01\x1f\xe9\u1234'));
+assertEquals('[1.5,null,null,0]', JSON.stringify([1.5, NaN, -Infinity, -0]));
+assertEquals('{"a":{"x":1}}',
+             JSON.stringify({a: {toJSON: function() { return {x: 1}; }}}));
+assertEquals('{"a":2}', JSON.stringify({get a() { return 2; }}));
+assertEquals('["s",7,false]',
+             JSON.stringify([new String("s"), new Number(7),
+                             new Boolean(false)]));
+var withHole = [1, , 3];
+Array.prototype[1] = "proto";
+assertEquals('[1,"proto",3]', JSON.stringify(withHole));
+delete Array.prototype[1];
+function Point(x, y) { this.x = x; this.y = y; }
+Point.prototype.z = 3;
+assertEquals('{"x":1,"y":2}', JSON.stringify(new Point(1, 2)));
+Point.prototype.toJSON = function() { return "point"; };
+assertEquals('["point"]', JSON.stringify([new Point(1, 2)]));
+
 TestInvalid('1); throw "foo"; (1');
 
 var x = 0;
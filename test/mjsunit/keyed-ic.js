@@ -234,3 +234,49 @@ runTest = function() {
 }
 
 runTest();
+
+// ----------------------------------------------------------------------
+// Keyed load with string keys computed at runtime, whose hash has not
+// been computed yet when they reach the generic stub.
+// ----------------------------------------------------------------------
+
+runTest = function() {
+  var a = [];
+  for (var i = 0; i < 20; i++) a[i] = i;
+  a[123] = 'a';
+  a[1234567] = 'b';
+  a[12345678] = 'c';
+  var o = { '01': 'd', '1a': 'e', '-1': 'f', '': 'g', '1.5': 'h' };
+
+  // Make the load megamorphic so the generic stub is used.
+  function get(object, key) { return object[key]; }
+  var receivers = [{ p: 1 }, { q: 1 }, { r: 1 }, { s: 1 }, [0], o];
+  for (var j = 0; j < 10; j++) {
+    for (var i = 0; i < receivers.length; i++) get(receivers[i], 'p');
+  }
+
+  for (var j = 0; j < 2; j++) {
+    for (var i = 0; i < 20; i++) {
+      assertEquals(i, get(a, String(i)));
+      assertEquals(i, get(a, '' + i));
+    }
+    assertEquals('a', get(a, '12' + '3'));
+    assertEquals('b', get(a, '123' + '4567'));
+    assertEquals('c', get(a, '1234' + '5678'));
+    assertEquals(undefined, get(a, '2' + '0'));
+    assertEquals(undefined, get(a, '1' + '00'));
+    assertEquals('d', get(o, '0' + '1'));
+    assertEquals('e', get(o, '1' + 'a'));
+    assertEquals('f', get(o, '-' + '1'));
+    assertEquals('g', get(o, 'x'.substring(1)));
+    assertEquals('h', get(o, '1.' + '5'));
+    assertEquals(undefined, get(a, '0' + '1'));
+  }
+  // The computed hash is kept in the key.
+  var key = '1' + '9';
+  assertEquals(19, get(a, key));
+  assertEquals(19, get(a, key));
+  assertEquals(19, a[key]);
+}
+
+runTest();
@@ -66,3 +66,28 @@ for(var i = 0; i < lipsum.length; i += 3) {
     assertEquals(i, index, "Lipsum match at " + i + ".." + (i + len - 1));
   }
 }
+
+// Search strings built by concatenation, which are searched without being
+// flattened.  The pieces are long enough to make cons strings, and some
+// of them have two-byte characters.
+var pieces = ["lorem ipsum dolor ", "sit amet \u1234\u5678 ", "consectetur "];
+function ConsString(length) {
+  var result = "";
+  for (var i = 0; result.length < length; i++) {
+    result += pieces[i % pieces.length] + i;
+  }
+  return result;
+}
+var consLength = 40000;
+var flat = ConsString(consLength);
+flat.charCodeAt(0);  // Flatten.
+for (var i = 0; i < flat.length; i += 997) {
+  for (var len = 1; len < 60; len += 11) {
+    var substring = flat.substring(i, i + len);
+    var cons = ConsString(consLength);
+    assertEquals(flat.indexOf(substring), cons.indexOf(substring),
+                 "Cons string substring " + i + ".." + (i + len - 1));
+  }
+}
+assertEquals(-1, ConsString(consLength).indexOf("no such text"));
+assertEquals(-1, ConsString(consLength).indexOf("\u5678\u1234"));
@@ -214,6 +214,8 @@
       'sources': [
         '../../src/accessors.cc',
         '../../src/accessors.h',
+        '../../src/allocation-sampler.cc',
+        '../../src/allocation-sampler.h',
         '../../src/allocation.cc',
         '../../src/allocation.h',
         '../../src/api.cc',
@@ -297,6 +299,8 @@
         '../../src/ic-inl.h',
         '../../src/ic.cc',
         '../../src/ic.h',
+        '../../src/incremental-marking.cc',
+        '../../src/incremental-marking.h',
         '../../src/interpreter-irregexp.cc',
         '../../src/interpreter-irregexp.h',
         '../../src/jump-target.cc',
@@ -365,6 +369,10 @@
         '../../src/spaces-inl.h',
         '../../src/spaces.cc',
         '../../src/spaces.h',
+        '../../src/store-buffer.cc',
+        '../../src/store-buffer.h',
+        '../../src/string-kernels.cc',
+        '../../src/string-kernels.h',
         '../../src/string-stream.cc',
         '../../src/string-stream.h',
         '../../src/stub-cache.cc',
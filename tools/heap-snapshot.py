@@ -0,0 +1,281 @@
+#!/usr/bin/env python
+#
+# Copyright 2010 the V8 project authors. All rights reserved.
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+#       copyright notice, this list of conditions and the following
+#       disclaimer in the documentation and/or other materials provided
+#       with the distribution.
+#     * Neither the name of Google Inc. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This is a utility for finding what keeps memory alive in a heap snapshot
+# written by v8::V8::WriteHeapSnapshot.  It computes the dominator tree of
+# the object graph and prints the objects with the largest retained sizes,
+# that is the memory that would be freed if they were unreachable, together
+# with a shortest path of references from the roots to each of them.  The
+# snapshot format is described with HeapSnapshotWriter in
+# src/heap-profiler.h.
+
+# Sample usage:
+# $ tools/heap-snapshot.py --top=30 heap.snapshot
+
+
+import optparse, sys
+
+NODE_TYPES = ['hidden', 'array', 'string', 'object', 'code', 'closure',
+              'regexp', 'number']
+
+CONTEXT_VARIABLE_EDGE = 0
+ELEMENT_EDGE = 1
+PROPERTY_EDGE = 2
+INTERNAL_EDGE = 3
+
+# Name lengths in the printed paths.
+MAX_NAME_LENGTH = 40
+
+
+class Snapshot(object):
+  def __init__(self):
+    self.strings = []
+    # Per node, indexed by the node's position in the snapshot.  Node 0 is
+    # the roots.
+    self.ids = []
+    self.types = []
+    self.names = []
+    self.sizes = []
+    # Lists of (edge type, name or index, target id).
+    self.edges = []
+    self.index_of_id = {}
+
+  def Read(self, filename):
+    data = bytearray(open(filename, 'rb').read())
+    if data[0:4] != bytearray(b'V8HS'):
+      raise Exception('%s is not a heap snapshot' % filename)
+    self.data = data
+    self.position = 4
+    version = self.ReadVarint()
+    if version != 1:
+      raise Exception('unsupported snapshot version %d' % version)
+    while True:
+      tag = chr(self.ReadByte())
+      if tag == 'e':
+        break
+      elif tag == 's':
+        self.ReadVarint()  # The strings are numbered in order.
+        length = self.ReadVarint()
+        chars = self.data[self.position:self.position + length]
+        self.strings.append(chars.decode('ascii'))
+        self.position += length
+      elif tag == 'n':
+        self.ReadNode()
+      else:
+        raise Exception('corrupt snapshot at byte %d' % (self.position - 1))
+    del self.data
+
+  def ReadNode(self):
+    id = self.ReadVarint()
+    self.index_of_id[id] = len(self.ids)
+    self.ids.append(id)
+    self.types.append(self.ReadByte())
+    self.names.append(self.ReadVarint())
+    self.sizes.append(self.ReadVarint())
+    edges = []
+    for i in range(self.ReadVarint()):
+      type = self.ReadByte()
+      name_or_index = self.ReadVarint()
+      edges.append((type, name_or_index, self.ReadVarint()))
+    self.edges.append(edges)
+
+  def ReadByte(self):
+    value = self.data[self.position]
+    self.position += 1
+    return value
+
+  def ReadVarint(self):
+    value = 0
+    shift = 0
+    while True:
+      byte = self.ReadByte()
+      value |= (byte & 0x7f) << shift
+      shift += 7
+      if byte < 0x80:
+        return value
+
+  def Successors(self, node):
+    # Edges to objects that were not written (free memory, fillers) are
+    # ignored.
+    result = []
+    for (type, name_or_index, to) in self.edges[node]:
+      if to in self.index_of_id:
+        result.append(self.index_of_id[to])
+    return result
+
+  def NodeName(self, node):
+    name = self.strings[self.names[node]]
+    if len(name) > MAX_NAME_LENGTH:
+      name = name[:MAX_NAME_LENGTH] + '...'
+    return '%s %s @%d' % (NODE_TYPES[self.types[node]], repr(name),
+                          self.ids[node])
+
+  def EdgeName(self, edge):
+    (type, name_or_index, to) = edge
+    if type == PROPERTY_EDGE:
+      return '.' + self.strings[name_or_index]
+    elif type == CONTEXT_VARIABLE_EDGE:
+      return ' (context variable %s)' % self.strings[name_or_index]
+    elif type == ELEMENT_EDGE:
+      return '[%d]' % name_or_index
+    else:
+      return ' (internal %d)' % name_or_index
+
+
+def PostOrder(snapshot):
+  # Iterative depth first search from the roots.
+  count = len(snapshot.ids)
+  visited = [False] * count
+  order = []
+  visited[0] = True
+  stack = [(0, iter(snapshot.Successors(0)))]
+  while stack:
+    (node, successors) = stack[-1]
+    advanced = False
+    for next in successors:
+      if not visited[next]:
+        visited[next] = True
+        stack.append((next, iter(snapshot.Successors(next))))
+        advanced = True
+        break
+    if not advanced:
+      order.append(node)
+      stack.pop()
+  return order
+
+
+def Dominators(snapshot, post_order):
+  # The iterative algorithm of Cooper, Harvey and Kennedy, "A Simple, Fast
+  # Dominance Algorithm".  Unreachable nodes get no dominator.
+  count = len(snapshot.ids)
+  number = [-1] * count
+  for i in range(len(post_order)):
+    number[post_order[i]] = i
+  predecessors = [[] for i in range(count)]
+  for node in post_order:
+    for next in snapshot.Successors(node):
+      predecessors[next].append(node)
+
+  dominator = [-1] * count
+  root = post_order[-1]
+  dominator[root] = root
+
+  def Intersect(a, b):
+    while a != b:
+      while number[a] < number[b]:
+        a = dominator[a]
+      while number[b] < number[a]:
+        b = dominator[b]
+    return a
+
+  changed = True
+  while changed:
+    changed = False
+    for node in reversed(post_order[:-1]):
+      new_dominator = -1
+      for predecessor in predecessors[node]:
+        if dominator[predecessor] == -1:
+          continue
+        if new_dominator == -1:
+          new_dominator = predecessor
+        else:
+          new_dominator = Intersect(predecessor, new_dominator)
+      if dominator[node] != new_dominator:
+        dominator[node] = new_dominator
+        changed = True
+  return dominator
+
+
+def RetainedSizes(snapshot, post_order, dominator):
+  # In post order the nodes come after all the nodes they dominate.
+  retained = list(snapshot.sizes)
+  for node in post_order[:-1]:
+    retained[dominator[node]] += retained[node]
+  return retained
+
+
+def RetainingPaths(snapshot):
+  # Breadth first search from the roots, remembering the edge each node was
+  # first reached by.
+  parent = {0: None}
+  queue = [0]
+  position = 0
+  while position < len(queue):
+    node = queue[position]
+    position += 1
+    for edge in snapshot.edges[node]:
+      next = snapshot.index_of_id.get(edge[2])
+      if next is not None and next not in parent:
+        parent[next] = (node, edge)
+        queue.append(next)
+  return parent
+
+
+def FormatPath(snapshot, parent, node):
+  steps = []
+  while parent[node] is not None:
+    (node, edge) = parent[node]
+    steps.append(snapshot.EdgeName(edge))
+  steps.reverse()
+  return '(roots)' + ''.join(steps)
+
+
+def Main():
+  parser = optparse.OptionParser(usage='%prog [options] snapshot')
+  parser.add_option('--top', type='int', default=20,
+                    help='number of objects to print [default: %default]')
+  parser.add_option('--no-paths', action='store_false', dest='paths',
+                    default=True, help='do not print retaining paths')
+  (options, args) = parser.parse_args()
+  if len(args) != 1:
+    parser.print_help()
+    sys.exit(1)
+
+  snapshot = Snapshot()
+  snapshot.Read(args[0])
+  post_order = PostOrder(snapshot)
+  dominator = Dominators(snapshot, post_order)
+  retained = RetainedSizes(snapshot, post_order, dominator)
+  parent = options.paths and RetainingPaths(snapshot)
+
+  print('%d objects, %d reachable, %d bytes reachable' %
+        (len(snapshot.ids) - 1, len(post_order) - 1, retained[0]))
+  print('')
+  print('%10s %10s  %s' % ('retained', 'self', 'object'))
+  nodes = post_order[:-1]
+  nodes.sort(key=lambda node: retained[node], reverse=True)
+  for node in nodes[:options.top]:
+    print('%10d %10d  %s' % (retained[node], snapshot.sizes[node],
+                             snapshot.NodeName(node)))
+    if options.paths:
+      print('%22s%s' % ('', FormatPath(snapshot, parent, node)))
+
+
+if __name__ == '__main__':
+  Main()